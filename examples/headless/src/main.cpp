@@ -1,8 +1,10 @@
+#include <chrono>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
 
 #include <gandalf/gameboy.h>
+#include <gandalf/movie.h>
 
 struct: public gandalf::PPU::VBlankListener
 {
@@ -32,7 +34,7 @@ int main(int argc, char* argv[])
 {
     if (argc < 2)
     {
-        std::cout << "Usage: " << argv[0] << " <rom file>" << std::endl;
+        std::cout << "Usage: " << argv[0] << " <rom file> [movie file]" << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -55,6 +57,31 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
+    // Replay the movie as fast as possible without rendering or audio, and report the speed
+    if (argc > 2)
+    {
+        std::ifstream movie_file(argv[2], std::ios::binary);
+        try
+        {
+            const gandalf::Movie movie = gandalf::Movie::Load(movie_file);
+            gb->SetColorOutput(false);
+            gandalf::MoviePlayer player(*gb, movie);
+
+            const auto start = std::chrono::steady_clock::now();
+            player.RunToEnd();
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            const double emulated_seconds = static_cast<double>(movie.GetLength()) / gandalf::CPUFrequency;
+            std::cout << "Replayed " << emulated_seconds << " s in " << seconds << " s (" << emulated_seconds / seconds << "x)" << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "Failed to replay movie file: " << argv[2] << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return 0;
+    }
+
     // The gameboy will call our listener when it's ready to draw a frame, we will use this to log the FPS
     gb->AddVBlankListener(&frame_logger);
 
@@ -3,33 +3,28 @@
 #include <iostream>
 #include <SDL.h>
 
-#include <gandalf/constants.h>
-
 namespace
 {
-    constexpr int FREQUENCY = 44100;
     constexpr int FORMAT = AUDIO_F32;
     constexpr int NUMBER_OF_CHANNELS = 2;
     constexpr int BUFFER_SIZE_SAMPLES = 1024;
-    constexpr int BUFFER_SIZE_BYTES = BUFFER_SIZE_SAMPLES * NUMBER_OF_CHANNELS * SDL_AUDIO_BITSIZE(FORMAT) / 8;
-    constexpr int DOWNSAMPLING = gandalf::CPUFrequency / FREQUENCY;
 }
 
 
-SDLAudioHandler::SDLAudioHandler(const bool& gb_thread_running):
+SDLAudioHandler::SDLAudioHandler(std::shared_ptr<gandalf::AudioRingBuffer> buffer):
     device_id_(0),
-    index_(0),
-    gb_thread_running_(gb_thread_running)
+    buffer_(buffer)
 {
     static_assert(sizeof(float) == 4);
-    audio_buffer_.resize(BUFFER_SIZE_BYTES);
 
     SDL_AudioSpec desired_spec;
     memset(&desired_spec, 0, sizeof(desired_spec));
-    desired_spec.freq = FREQUENCY;
+    desired_spec.freq = Frequency;
     desired_spec.format = FORMAT;
     desired_spec.channels = NUMBER_OF_CHANNELS;
     desired_spec.samples = BUFFER_SIZE_SAMPLES;
+    desired_spec.callback = Callback;
+    desired_spec.userdata = this;
 
     SDL_AudioSpec obtained_spec;
     device_id_ = SDL_OpenAudioDevice(nullptr, 0, &desired_spec, &obtained_spec, 0);
@@ -48,25 +43,9 @@ SDLAudioHandler::~SDLAudioHandler()
     SDL_CloseAudioDevice(device_id_);
 }
 
-uint32_t SDLAudioHandler::GetNextSampleTime()
+void SDLAudioHandler::Callback(void* user_data, Uint8* stream, int length)
 {
-    return DOWNSAMPLING;
+    // Missing samples are filled with silence by the ring buffer, the callback never waits for the emulation
+    auto* handler = static_cast<SDLAudioHandler*>(user_data);
+    handler->buffer_->Read(reinterpret_cast<float*>(stream), length / (sizeof(float) * NUMBER_OF_CHANNELS));
 }
-
-void SDLAudioHandler::Play(float left, float right)
-{
-    audio_buffer_[index_++] = left;
-    audio_buffer_[index_++] = right;
-
-    // When the buffer is full we queue it to the audio device
-    if (index_ == BUFFER_SIZE_SAMPLES * NUMBER_OF_CHANNELS)
-    {
-        // Wait until the audio device has played enough of the buffer to be able to queue more.
-        // Note: this also limits the frame rate of the emulator, because the emulation thread will be blocked until the audio device has played enough.
-        while (gb_thread_running_ && SDL_GetQueuedAudioSize(device_id_) > BUFFER_SIZE_BYTES) {}
-
-        SDL_QueueAudio(device_id_, audio_buffer_.data(), BUFFER_SIZE_BYTES);
-
-        index_ = 0;
-    }
-}
\ No newline at end of file
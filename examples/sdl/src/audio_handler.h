@@ -1,24 +1,26 @@
 #ifndef SDL_AUDIO_HANDLER_H
 #define SDL_AUDIO_HANDLER_H
 
+#include <memory>
+
 #include <SDL.h>
 
-#include <gandalf/apu.h>
+#include <gandalf/audio_ring_buffer.h>
 
-class SDLAudioHandler: public gandalf::APU::OutputHandler
+// Plays the samples in the ring buffer on the default audio device, SDL calls the callback on its own audio thread
+class SDLAudioHandler
 {
 public:
-    SDLAudioHandler(const bool& gb_thread_running);
-    virtual ~SDLAudioHandler();
+    static constexpr int Frequency = 44100;
 
-    uint32_t GetNextSampleTime() override;
-    void Play(float left, float right) override;
+    SDLAudioHandler(std::shared_ptr<gandalf::AudioRingBuffer> buffer);
+    ~SDLAudioHandler();
 
 private:
+    static void Callback(void* user_data, Uint8* stream, int length);
+
     SDL_AudioDeviceID device_id_;
-    std::vector<float> audio_buffer_;
-    int index_;
-    const bool& gb_thread_running_;
+    std::shared_ptr<gandalf::AudioRingBuffer> buffer_;
 };
 
-#endif
\ No newline at end of file
+#endif
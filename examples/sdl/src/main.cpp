@@ -5,7 +5,9 @@
 
 #include <SDL.h>
 
+#include <gandalf/audio_ring_buffer.h>
 #include <gandalf/gameboy.h>
+#include <gandalf/resampler.h>
 
 #include "audio_handler.h"
 
@@ -13,7 +15,8 @@ SDL_Window* window = NULL;
 SDL_Renderer* renderer = NULL;
 SDL_Texture* texture = NULL;
 std::unique_ptr<gandalf::Gameboy> gameboy;
-std::unique_ptr<gandalf::LCD::VideoBuffer> front_buffer, back_buffer;
+std::shared_ptr<gandalf::AudioRingBuffer> audio_buffer;
+std::unique_ptr<SDLAudioHandler> audio_handler;
 std::thread gameboy_thread;
 
 static bool run_gb = false;
@@ -27,11 +30,6 @@ void GameboyThread()
 // Sets up SDL and creates a window, nothing special here
 static bool InitializeSDL()
 {
-    front_buffer = std::make_unique<gandalf::LCD::VideoBuffer>();
-    back_buffer = std::make_unique<gandalf::LCD::VideoBuffer>();
-    front_buffer->fill(0);
-    back_buffer->fill(0);
-
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         std::cout << "failed to init: " << SDL_GetError();
         return false;
@@ -63,19 +61,6 @@ static bool InitializeSDL()
     return true;
 }
 
-// The VBlank interrupt is called when the gameboy is done drawing the current frame.
-// We implement the VBlankListener interface to receive this interrupt and copy the
-// gameboy's video buffer to our own buffer.
-struct: gandalf::PPU::VBlankListener
-{
-    void OnVBlank() override
-    {
-        const auto& framebuffer = gameboy->GetLCD().GetVideoBuffer();
-        std::swap(front_buffer, back_buffer);
-        std::copy(framebuffer.begin(), framebuffer.end(), back_buffer->begin());
-    }
-} vblank_listener;
-
 static bool InitializeGameboy(const std::string& path)
 {
     const std::filesystem::path rom_path(path);
@@ -98,9 +83,11 @@ static bool InitializeGameboy(const std::string& path)
         return false;
     }
 
-    // The gameboy will call our listener when it's ready to draw a frame, we will use this to update our screen buffer
-    gameboy->AddVBlankListener(&vblank_listener);
-    gameboy->SetAudioHandler(std::make_unique<SDLAudioHandler>(run_gb));
+    // The gameboy thread sleeps while the audio buffer is full, so the emulation runs at the speed of the audio device
+    audio_buffer = std::make_shared<gandalf::AudioRingBuffer>(SDLAudioHandler::Frequency / 10, SDLAudioHandler::Frequency);
+    audio_buffer->SetBlocking(true);
+    audio_handler = std::make_unique<SDLAudioHandler>(audio_buffer);
+    gameboy->SetAudioHandler(std::make_shared<gandalf::Resampler>(audio_buffer, SDLAudioHandler::Frequency));
     gameboy_thread = std::thread(GameboyThread);
     run_gb = true;
     return true;
@@ -202,13 +189,20 @@ int main(int argc, char* argv[])
             }
         }
 
-        SDL_UpdateTexture(texture, NULL, front_buffer->data(), gandalf::ScreenWidth * sizeof(gandalf::LCD::ABGR1555));
+        // The gameboy thread publishes every completed frame, we can read the latest one without copying it or locking
+        if (const auto* frame = gameboy->AcquireFrame())
+        {
+            SDL_UpdateTexture(texture, NULL, frame->data(), gandalf::ScreenWidth * sizeof(gandalf::LCD::ABGR1555));
+            gameboy->ReleaseFrame();
+        }
         SDL_RenderClear(renderer);
         SDL_RenderCopy(renderer, texture, NULL, NULL);
         SDL_RenderPresent(renderer);
     }
 
+    audio_buffer->SetBlocking(false);
     gameboy_thread.join();
+    audio_handler.reset();
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,35 @@
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+
+#include <gandalf/trace_buffer.h>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <trace file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path trace_path(argv[1]);
+    if (!std::filesystem::exists(trace_path))
+    {
+        std::cout << "File not found: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream input(trace_path, std::ios::binary);
+    try {
+        const auto records = gandalf::TraceBuffer::Read(input);
+        std::cout << "       Cycle  Location  Opcode  Registers" << std::endl;
+        for (const auto& record : records)
+            gandalf::TraceBuffer::WriteText(std::cout, record);
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to read trace: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
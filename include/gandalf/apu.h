@@ -37,6 +37,11 @@ namespace gandalf
         APU();
         ~APU();
 
+        /**
+         * Sets the handler that receives the generated samples. While no handler is set the sound channels are not synthesized,
+         * only the state that can be observed by the game (length counters, frequency sweep, channel status) is kept up to date.
+         * @param audio_handler the handler, or nullptr to disable audio output
+         */
         void SetAudioHandler(std::shared_ptr<APU::OutputHandler> audio_handler);
 
         void Write(word address, byte value) override;
@@ -55,11 +60,19 @@ namespace gandalf
         void MuteChannel(Channel channel, bool mute);
 
     private:
+        // Holds the four channels as members of their concrete types, so that they are called without virtual dispatch
+        struct Channels;
+
+        /// Applies the ticks that were skipped while no output handler was set.
+        void CatchUp() const;
+
         std::shared_ptr<OutputHandler> output_handler_;
         std::array<byte, 0x20> wave_ram_;
 
-        FrameSequencer frame_sequencer_;
-        std::array<std::unique_ptr<SoundChannel>, 4> sound_channels_;
+        // Without an output handler the frame sequencer is advanced lazily when the registers are accessed.
+        mutable FrameSequencer frame_sequencer_;
+        mutable std::uint64_t pending_ticks_;
+        std::unique_ptr<Channels> channels_;
         std::array<byte, 4> samples_;
         std::array<bool, 4> mute_channel_;
 
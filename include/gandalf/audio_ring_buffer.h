@@ -0,0 +1,84 @@
+#ifndef __GANDALF_AUDIO_RING_BUFFER_H
+#define __GANDALF_AUDIO_RING_BUFFER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "apu.h"
+
+namespace gandalf {
+    /**
+     * Passes stereo samples from the thread that runs the emulation to an audio playback thread, for example the callback of an audio
+     * device. There must be a single writer, the APU or a Resampler, and a single reader. Both sides are wait-free, unless blocking is
+     * enabled: the writer then sleeps while the buffer is full instead of dropping samples, which paces the emulation to the playback.
+     */
+    class AudioRingBuffer: public APU::OutputHandler {
+    public:
+        /**
+         * @param capacity the number of stereo samples the buffer holds, rounded up to a power of two
+         * @param sample_rate the sample rate, which determines the sample times when the APU writes into the buffer directly
+         * @throws InvalidArgument when one of the values is 0 or the sample rate exceeds the APU clock
+         */
+        AudioRingBuffer(std::size_t capacity, std::uint32_t sample_rate);
+        ~AudioRingBuffer();
+
+        AudioRingBuffer(const AudioRingBuffer&) = delete;
+        AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+        std::uint32_t GetNextSampleTime() override;
+
+        /// Writes a sample. When the buffer is full the sample is dropped and counted as an overrun, or the call waits when blocking.
+        void Play(float left, float right) override;
+
+        /**
+         * Reads interleaved samples, left first. Samples that are not available are filled with silence and counted as underruns.
+         * @param output the output buffer, which must hold 2 * count values
+         * @param count the number of stereo samples
+         * @returns The number of stereo samples that were available
+         */
+        std::size_t Read(float* output, std::size_t count);
+
+        /**
+         * Enables waiting in Play() while the buffer is full, disabled by default. Disabling it releases a waiting writer, which is
+         * needed before stopping the emulation thread.
+         */
+        void SetBlocking(bool blocking);
+
+        std::size_t GetCapacity() const { return capacity_; }
+
+        /// @returns The number of stereo samples that can be read.
+        std::size_t GetAvailable() const;
+
+        /// @returns The number of stereo samples that were dropped because the buffer was full.
+        std::uint64_t GetOverruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+        /// @returns The number of stereo samples that were filled with silence because the buffer was empty.
+        std::uint64_t GetUnderruns() const { return underruns_.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr std::size_t kCacheLineSize = 64;
+
+        const std::size_t capacity_;
+        const std::size_t mask_;
+        const std::uint32_t sample_rate_;
+        std::vector<float> samples_;
+        std::uint32_t cycle_remainder_;
+
+        // The indices only increase. Each is written by one side only, together with its counter it is kept on a separate cache line
+        // to avoid false sharing.
+        alignas(kCacheLineSize) std::atomic<std::uint64_t> write_index_;
+        std::atomic<std::uint64_t> overruns_;
+        alignas(kCacheLineSize) std::atomic<std::uint64_t> read_index_;
+        std::atomic<std::uint64_t> underruns_;
+
+        alignas(kCacheLineSize) std::atomic<bool> blocking_;
+        std::atomic<bool> writer_waiting_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+    };
+} // namespace gandalf
+
+#endif
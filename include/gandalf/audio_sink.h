@@ -0,0 +1,97 @@
+#ifndef __GANDALF_AUDIO_SINK_H
+#define __GANDALF_AUDIO_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "apu.h"
+
+namespace gandalf {
+    /**
+     * Records the audio output of the APU to a stream as 16 bit stereo PCM. Samples are collected in blocks, full blocks are handed to a
+     * writer thread through a lock-free single producer single consumer queue, so the emulation never waits for the stream. When all
+     * blocks are waiting to be written, samples are dropped and counted.
+     *
+     * Set the sink with Gameboy::SetAudioHandler().
+     */
+    class AudioSink: public APU::OutputHandler {
+    public:
+        enum class Format {
+            WAV,   ///< RIFF WAVE file, the sizes in the header are filled in by Close() when the stream is seekable
+            RawPCM ///< Interleaved signed 16 bit little endian samples without a header
+        };
+
+        /**
+         * Starts the writer thread.
+         * @param os the stream to write to, which must not be used by anything else until Close() returns
+         * @param format the format of the recording
+         * @param sample_rate the number of samples per second and channel
+         * @param block_size the number of stereo samples in a block
+         * @param block_count the number of blocks in the queue
+         * @throws InvalidArgument when one of the values is 0 or the sample rate exceeds the APU clock
+         */
+        AudioSink(std::ostream& os, Format format, std::uint32_t sample_rate, std::size_t block_size = 4096, std::size_t block_count = 16);
+
+        /// Writes the remaining samples and stops the writer thread, errors are ignored.
+        ~AudioSink();
+
+        AudioSink(const AudioSink&) = delete;
+        AudioSink& operator=(const AudioSink&) = delete;
+
+        std::uint32_t GetNextSampleTime() override;
+        void Play(float left, float right) override;
+
+        /**
+         * Writes the remaining samples, including the block that is not full yet, and stops the writer thread. Must be called from the
+         * thread that runs the emulation, samples that are played after this call are dropped.
+         * @throws Exception when writing to the stream failed
+         */
+        void Close();
+
+        /// @returns The number of stereo samples that were written.
+        std::uint64_t GetWrittenSamples() const { return written_samples_.load(std::memory_order_relaxed); }
+
+        /// @returns The number of stereo samples that were dropped because the queue was full.
+        std::uint64_t GetDroppedSamples() const { return dropped_samples_.load(std::memory_order_relaxed); }
+
+    private:
+        void Run();
+        void WriteBlocks();
+        void WriteWAVHeader(std::uint32_t data_size);
+
+        std::ostream& os_;
+        const Format format_;
+        const std::uint32_t sample_rate_;
+        const std::size_t block_size_;
+
+        // Ring of blocks: the emulation thread fills the block at write_index_, the writer thread writes the blocks from read_index_ up
+        // to write_index_. Both indices only increase, a block is at index % blocks_.size().
+        std::vector<std::vector<std::int16_t>> blocks_;
+        std::vector<std::size_t> block_lengths_; // Number of values in every block, a block is only partially filled by Close()
+        std::atomic<std::uint64_t> write_index_;
+        std::atomic<std::uint64_t> read_index_;
+        std::size_t fill_; // Number of values in the block that is being filled
+
+        std::uint32_t cycle_remainder_; // Fraction of a sample time that is carried over to get the exact sample rate
+        std::atomic<bool> closing_;
+        std::atomic<std::uint64_t> written_samples_;
+        std::atomic<std::uint64_t> dropped_samples_;
+        bool failed_;
+
+        std::mutex mutex_;
+        std::condition_variable condition_;
+
+        // Only used by the writer thread
+        std::vector<char> encoded_;
+        std::streampos header_position_;
+
+        std::thread writer_;
+    };
+} // namespace gandalf
+
+#endif
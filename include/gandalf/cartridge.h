@@ -51,6 +51,8 @@ namespace gandalf {
       std::string GetCGBFlagString() const;
       std::string GetSGBFlagString() const;
 
+      bool operator==(const Header& other) const;
+
       void Serialize(std::ostream& os) const override;
       void Deserialize(std::istream& is, std::uint16_t version) override;
     };
@@ -63,6 +65,15 @@ namespace gandalf {
      */
     bool Load(const ROM& bytes);
 
+    /**
+     * Loads the cartridge that is loaded in another cartridge. The ROM is shared instead of copied, the RAM and the memory bank
+     * controller start in their initial state.
+     *
+     * @param other the cartridge to load the ROM of
+     * @return true if loaded successfully, false when the other cartridge is not loaded
+     */
+    bool Load(const Cartridge& other);
+
     /// @return True if a cartridge is loaded, false otherwise.
     bool Loaded() const;
 
@@ -72,16 +83,41 @@ namespace gandalf {
     */
     std::shared_ptr<const Header> GetHeader() const;
 
+    /// @returns The memory bank controller of the cartridge, or nullptr if not loaded.
+    const MBC* GetMBC() const;
+    MBC* GetMBC();
+
+    /**
+     * Sets the time source of the real-time clock of the cartridge, which is kept when another cartridge is loaded.
+     * @param clock the clock, or nullptr to stop the time
+     */
+    void SetRTCClock(const RTCClock* clock);
+
     void Write(word address, byte value) override;
     byte Read(word address) const override;
     std::set<word> GetAddresses() const override;
+    word GetBank(word address) const override;
 
     void Serialize(std::ostream& os) const override;
+
+    /**
+     * @param os the stream to write to
+     * @param include_rom whether the ROM is written. A state without the ROM can only be deserialized while the same cartridge is
+     *                    loaded, its ROM is then shared.
+     */
+    void Serialize(std::ostream& os, bool include_rom) const;
     void Deserialize(std::istream& is, std::uint16_t version) override;
 
   private:
+    // Holds the concrete MBC in a variant, so that accesses are dispatched with a switch on the type that the compiler can inline
+    // instead of a virtual call.
+    struct Mapper;
+
+    static std::unique_ptr<Mapper> CreateMBC(const MBC::SharedROM& rom, const Header& header);
+
     std::shared_ptr<const Header> header_;
-    std::unique_ptr<MBC> mbc_;
+    std::unique_ptr<Mapper> mbc_;
+    const RTCClock* rtc_clock_;
   };
 }
 #endif
\ No newline at end of file
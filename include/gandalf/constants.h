@@ -105,6 +105,7 @@ namespace gandalf {
     constexpr int TotalScreenHeight = 256;
     constexpr int TotalScreenWidth = 256;
     constexpr int CPUFrequency = 4194304; // MHz
+    constexpr int CyclesPerFrame = 70224;
 
     enum class GameboyMode
     {
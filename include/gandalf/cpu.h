@@ -5,7 +5,9 @@
 #include "cpu_registers.h"
 #include "io.h"
 #include "memory.h"
+#include "profiler.h"
 #include "serialization.h"
+#include "trace_buffer.h"
 
 namespace gandalf {
 
@@ -27,10 +29,27 @@ namespace gandalf {
 
     void SetMode(GameboyMode mode) { gameboy_mode_ = mode; }
 
+    /// @returns Whether the CPU runs in CGB double speed mode.
+    bool GetDoubleSpeed() const { return double_speed_; }
+
+    /**
+     * Sets the profiler that records the executed instructions. Profiling is only available when the library is built with GANDALF_ENABLE_PROFILER.
+     * @param profiler the profiler, or nullptr to disable profiling
+     */
+    void SetProfiler(std::shared_ptr<Profiler> profiler) { profiler_ = profiler; }
+
+    /**
+     * Sets the buffer that records the state of the CPU at the start of every instruction.
+     * @param trace_buffer the trace buffer, or nullptr to disable tracing
+     */
+    void SetTraceBuffer(std::shared_ptr<TraceBuffer> trace_buffer) { trace_buffer_ = trace_buffer; }
+
   private:
     void CheckInterrupts();
     void Execute(byte opcode);
     void InterruptServiceRoutine();
+    void ProfileInstruction(word address, word stack_pointer, std::uint64_t start_cycles);
+    void TraceInstruction();
 
     Registers registers_;
     Memory& memory_;
@@ -43,6 +62,8 @@ namespace gandalf {
     bool double_speed_;
     bool prepare_speed_switch_;
     GameboyMode gameboy_mode_;
+    std::shared_ptr<Profiler> profiler_;
+    std::shared_ptr<TraceBuffer> trace_buffer_;
   };
 
 } // namespace gandalf
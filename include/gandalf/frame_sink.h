@@ -0,0 +1,102 @@
+#ifndef __GANDALF_FRAME_SINK_H
+#define __GANDALF_FRAME_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lcd.h"
+#include "ppu.h"
+
+namespace gandalf {
+    /**
+     * Records every completed frame to a stream. Frames are copied at VBlank into a bounded queue and encoded and written on a dedicated
+     * writer thread, so the emulation never waits for the stream. When the queue is full the frame is dropped and counted.
+     *
+     * Register the sink with Gameboy::AddVBlankListener(); it must outlive the Gameboy or stay unused after it is destroyed.
+     */
+    class FrameSink: public PPU::VBlankListener {
+    public:
+        enum class Format {
+            /// YUV4MPEG2 with I420 frames (BT.601 video range), which can be read by most video tools
+            Y4M,
+            /**
+             * Lossless compressed ABGR1555 frames, see ReadDeltaRLE(). The file starts with the magic "GBRL", the format version (16 bits),
+             * the width (16 bits) and the height (16 bits). Every frame consists of its size in bytes (32 bits) followed by the pixels,
+             * XORed with the pixels of the previous frame and run length encoded. A run starts with a byte n: for n < 128 n + 1 literal
+             * pixels follow, otherwise the single pixel that follows is repeated n - 126 times. All values are stored in little endian.
+             */
+            DeltaRLE
+        };
+
+        /**
+         * Starts the writer thread.
+         * @param lcd the LCD of which the video buffer is recorded
+         * @param os the stream to write to, which must not be used by anything else until Close() returns
+         * @param format the format of the recording
+         * @param queue_capacity the maximum number of frames that wait to be written
+         * @throws InvalidArgument when the capacity is 0
+         */
+        FrameSink(const LCD& lcd, std::ostream& os, Format format, std::size_t queue_capacity = 8);
+
+        /// Writes the remaining frames and stops the writer thread, errors are ignored.
+        ~FrameSink();
+
+        FrameSink(const FrameSink&) = delete;
+        FrameSink& operator=(const FrameSink&) = delete;
+
+        void OnVBlank() override;
+
+        /**
+         * Writes the remaining frames and stops the writer thread. Frames that are completed after this call are dropped.
+         * @throws Exception when writing to the stream failed
+         */
+        void Close();
+
+        /// @returns The number of frames that were written.
+        std::uint64_t GetWrittenFrames() const { return written_frames_.load(std::memory_order_relaxed); }
+
+        /// @returns The number of frames that were dropped because the queue was full.
+        std::uint64_t GetDroppedFrames() const { return dropped_frames_.load(std::memory_order_relaxed); }
+
+        /**
+         * Reads a recording in the DeltaRLE format.
+         * @param is the stream to read from
+         * @returns The frames in the recording
+         * @throws SerializationException when the stream does not contain a valid recording
+         */
+        static std::vector<LCD::VideoBuffer> ReadDeltaRLE(std::istream& is);
+
+    private:
+        void Run();
+        void WriteHeader();
+        void WriteFrame(const LCD::VideoBuffer& frame);
+
+        const LCD& lcd_;
+        std::ostream& os_;
+        const Format format_;
+
+        std::vector<LCD::VideoBuffer> slots_;
+        std::vector<std::size_t> free_slots_;
+        std::deque<std::size_t> pending_slots_; // Frames waiting to be written, oldest first
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool closing_;
+        bool failed_;
+        std::atomic<std::uint64_t> written_frames_;
+        std::atomic<std::uint64_t> dropped_frames_;
+
+        // Only used by the writer thread
+        LCD::VideoBuffer previous_frame_;
+        std::vector<byte> encoded_;
+
+        std::thread writer_;
+    };
+} // namespace gandalf
+
+#endif
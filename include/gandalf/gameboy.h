@@ -12,11 +12,39 @@
 #include "io.h"
 #include "timer.h"
 #include "model.h"
+#include "profiler.h"
 #include "wram.h"
 
 namespace gandalf {
+  /// Time source of the real-time clock of a cartridge.
+  enum class RTCMode {
+    Emulated, ///< The emulated time, the clock only advances while the emulation runs
+    Host      ///< The time of the host
+  };
+
   class Gameboy {
   public:
+    /// Receives the breakpoint and watchpoint hits that occur during RunCycles() and RunFrame().
+    class DebugListener {
+    public:
+      /**
+       * Called before the instruction at a breakpoint is executed.
+       * @param bank the bank of the instruction
+       * @param address the address of the instruction
+       * @returns Whether the emulation should stop
+       */
+      virtual bool OnBreakpoint(word bank, word address) = 0;
+
+      /**
+       * Called when a watched address is accessed, the emulation stops after the current instruction has completed.
+       * @param address the address that was accessed
+       * @param value the value that was read or written
+       * @param write whether the access was a write
+       * @returns Whether the emulation should stop
+       */
+      virtual bool OnWatchpoint(word address, byte value, bool write) = 0;
+    };
+
     /// @param emulated_model The model of the Gameboy to emulate
     Gameboy(Model emulated_model);
     ~Gameboy();
@@ -31,9 +59,11 @@ namespace gandalf {
     /**
      * Saves the current emulator state to a stream
      * @param os The stream to save to
+     * @param include_rom Whether the ROM is saved. A state without the ROM is much smaller and faster to save and load, but can only be
+     *                    loaded while the same ROM is loaded.
      * @returns Whether the save state was saved successfully
     */
-    bool SaveState(std::ostream& os);
+    bool SaveState(std::ostream& os, bool include_rom = true) const;
 
     /**
      * Loads a ROM into the Gameboy
@@ -42,16 +72,128 @@ namespace gandalf {
     */
     bool LoadROM(const ROM& rom);
 
+    /**
+     * Loads the ROM that is loaded in another Gameboy, which is shared instead of copied
+     * @param other The Gameboy to take the ROM from
+     * @returns Whether the ROM was loaded successfully
+    */
+    bool LoadROM(const Gameboy& other);
+
     void SetAudioHandler(std::shared_ptr<APU::OutputHandler> output_handler);
     void AddVBlankListener(PPU::VBlankListener* listener);
     void SetButtonState(Joypad::Button button, bool pressed);
     void MuteAudioChannel(APU::Channel channel, bool mute);
     void RegisterAddressHandler(Memory::AddressHandler& handler);
 
+    /**
+     * Sets the listener that receives the changes of the button states, see MovieRecorder.
+     * @param listener the listener, or nullptr
+     */
+    void SetJoypadListener(Joypad::Listener* listener) { io_.GetJoypad().SetListener(listener); }
+
+    /**
+     * Sets the profiler that records the instructions executed by the CPU.
+     * @param profiler the profiler, or nullptr to disable profiling
+     */
+    void SetProfiler(std::shared_ptr<Profiler> profiler);
+
+    /**
+     * Sets the buffer that records the most recent instructions executed by the CPU.
+     * @param trace_buffer the trace buffer, or nullptr to disable tracing
+     */
+    void SetTraceBuffer(std::shared_ptr<TraceBuffer> trace_buffer);
+
+    /**
+     * Connects the serial port to the serial port of another Gameboy, see LinkCable for running both instances in lockstep.
+     * @param peer the Gameboy on the other side of the link cable, or nullptr to disconnect
+     */
+    void SetSerialPeer(Gameboy* peer);
+
+    /**
+     * Connects the serial port to an endpoint that exchanges whole bytes, see RemoteLink.
+     * @param endpoint the endpoint, or nullptr to disconnect
+     */
+    void SetSerialEndpoint(SerialEndpoint* endpoint);
+
+    /**
+     * Gives access to the most recently completed frame without copying, see LCD::AcquireFrame(). May be called from another thread than
+     * the one that runs the emulation.
+     * @returns The frame, or nullptr when no frame was completed since the previous call
+     */
+    const LCD::VideoBuffer* AcquireFrame() { return io_.GetLCD().AcquireFrame(); }
+
+    /// Releases the frame that was returned by AcquireFrame().
+    void ReleaseFrame() { io_.GetLCD().ReleaseFrame(); }
+
+    /// Enables recording an Observation of every frame, see LCD::GetAcquiredObservation().
+    void SetObservationOutput(bool enabled) { io_.GetLCD().SetObservationOutput(enabled); }
+
+    /// Enables writing colors to the video buffer, see LCD::SetColorOutput().
+    void SetColorOutput(bool enabled) { io_.GetLCD().SetColorOutput(enabled); }
+
+    /// @returns The hash of the most recently completed frame, see LCD::GetFrameHash().
+    std::uint64_t GetFrameHash() const { return io_.GetLCD().GetFrameHash(); }
+
+    /// @returns Whether the most recently completed frame is identical to the one before it.
+    bool IsFrameUnchanged() const { return io_.GetLCD().IsFrameUnchanged(); }
+
+    /// @returns The lines of the most recently completed frame that changed, see LCD::GetDirtyLines().
+    const LCD::LineMask& GetDirtyLines() const { return io_.GetLCD().GetDirtyLines(); }
+
+    /// @returns The lines of the acquired frame that changed since the previously acquired frame, see LCD::GetAcquiredDirtyLines().
+    const LCD::LineMask& GetAcquiredDirtyLines() const { return io_.GetLCD().GetAcquiredDirtyLines(); }
+
     /// @brief Executes a single instruction
     void Run();
 
+    /**
+     * Runs the emulator for the given number of cycles, the last instruction may exceed this number.
+     * When the previous run was stopped by a breakpoint, the instruction at that breakpoint is executed without reporting it again,
+     * unless a state was loaded or the breakpoints at that instruction changed in the meantime.
+     * @param cycles the number of cycles to run
+     * @returns False when the emulation was stopped early by a breakpoint or watchpoint, true otherwise
+     */
+    bool RunCycles(std::uint64_t cycles);
+
+    /**
+     * Same as RunCycles(), but also returns after an instruction that starts a serial transfer with the internal clock. Used to link
+     * instances, which need to synchronize before the first bit is shifted.
+     * @param cycles the maximum number of cycles to run
+     * @returns False when the emulation was stopped early by a breakpoint or watchpoint, true otherwise
+     */
+    bool RunCyclesUntilTransfer(std::uint64_t cycles);
+
+    /**
+     * Runs the emulator until the next VBlank, or for the duration of a frame when the LCD is disabled. The frame that was completed
+     * is then returned by LCD::GetVideoBuffer().
+     * @returns False when the emulation was stopped early by a breakpoint or watchpoint, true otherwise
+     */
+    bool RunFrame();
+
+    /**
+     * Sets the listener for breakpoint and watchpoint hits. Without a listener every hit stops the emulation.
+     * @param listener the listener, or nullptr
+     */
+    void SetDebugListener(DebugListener* listener) { debug_listener_ = listener; }
+
+    /**
+     * Adds an execution breakpoint.
+     * @param bank the ROM or RAM bank in which the breakpoint is set, or Memory::AnyBank
+     * @param address the address of the instruction
+     */
+    void AddBreakpoint(word bank, word address);
+    void RemoveBreakpoint(word bank, word address);
+
+    /**
+     * Sets a watchpoint on an address, which is triggered by accesses of the CPU and HDMA.
+     * @param address the address to watch
+     * @param read whether reads are reported
+     * @param write whether writes are reported
+     */
+    void SetWatchpoint(word address, bool read, bool write);
+
     const Cartridge& GetCartridge() const { return cartridge_; }
+    Cartridge& GetCartridge() { return cartridge_; }
     const CPU& GetCPU() const { return cpu_; }
     const Memory& GetMemory() const { return memory_; }
     const LCD& GetLCD() const { return io_.GetLCD(); }
@@ -60,11 +202,48 @@ namespace gandalf {
     const APU& GetAPU() const { return io_.GetAPU(); }
     const Timer& GetTimer() const { return io_.GetTimer(); }
     const DMA& GetDMA() const { return io_.GetDMA(); }
+    const Serial& GetSerial() const { return io_.GetSerial(); }
+    Serial& GetSerial() { return io_.GetSerial(); }
 
     GameboyMode GetMode() const { return mode_; }
 
+    /// @returns The number of cycles that have been emulated so far.
+    std::uint64_t GetCycleCount() const { return io_.GetCycleCount(); }
+
+    /**
+     * Sets the time source of the real-time clock of cartridges that have one. The time that passed with the previous source is kept.
+     * @param mode RTCMode::Emulated (default) to follow the emulated cycles, which makes runs reproducible, or RTCMode::Host to follow
+     *             the time of the host, including the time between saving and loading a battery save
+     */
+    void SetRTCMode(RTCMode mode);
+    RTCMode GetRTCMode() const { return rtc_clock_.GetMode(); }
+
+    /// @returns The host time spent per component, only collected when built with GANDALF_ENABLE_PERF_COUNTERS.
+    const PerfCounters& GetPerfCounters() const { return io_.GetPerfCounters(); }
+    PerfCounters& GetPerfCounters() { return io_.GetPerfCounters(); }
+
   private:
+    void MapCartridge();
     void OnBootROMFinished();
+    bool RunUntil(std::uint64_t end_cycle, bool stop_at_vblank, bool stop_at_transfer);
+    void OnWatchpoint(word address, byte value, bool write);
+
+    class DebugHandler: public Memory::WatchListener, public PPU::VBlankListener, public Serial::TransferListener {
+    public:
+      DebugHandler(Gameboy& gb): gb_(gb), vblank_(false), transfer_started_(false) {}
+      void OnWatchpoint(word address, byte value, bool write) override { gb_.OnWatchpoint(address, value, write); }
+      void OnVBlank() override { vblank_ = true; }
+      void OnTransferStarted() override { transfer_started_ = true; }
+
+      bool GetVBlank() const { return vblank_; }
+      bool GetTransferStarted() const { return transfer_started_; }
+      void Reset() { vblank_ = false; transfer_started_ = false; }
+
+    private:
+      Gameboy& gb_;
+      bool vblank_;
+      bool transfer_started_;
+    };
 
     GameboyMode mode_;
     Model model_;
@@ -77,6 +256,26 @@ namespace gandalf {
     HRAM hram_;
     Cartridge cartridge_;
 
+    class RTCClockHandler: public RTCClock {
+    public:
+      RTCClockHandler(const IO& io): io_(io), mode_(RTCMode::Emulated) {}
+      std::uint64_t GetTime() const override;
+      bool IsHostTime() const override { return mode_ == RTCMode::Host; }
+
+      RTCMode GetMode() const { return mode_; }
+      void SetMode(RTCMode mode) { mode_ = mode; }
+
+    private:
+      const IO& io_;
+      RTCMode mode_;
+    };
+    RTCClockHandler rtc_clock_;
+
+    DebugHandler debug_handler_;
+    DebugListener* debug_listener_;
+    bool stop_requested_;
+    bool stopped_at_breakpoint_;
+
     class BootROMHandler: public Memory::AddressHandler, public Serializable {
     public:
       BootROMHandler(Gameboy& gb, const std::vector<byte> boot_rom): Memory::AddressHandler("Boot ROM"), key0_(0), boot_rom_(boot_rom), gb_(gb)
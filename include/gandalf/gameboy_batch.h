@@ -0,0 +1,98 @@
+#ifndef __GANDALF_GAMEBOY_BATCH_H
+#define __GANDALF_GAMEBOY_BATCH_H
+
+#include <memory>
+#include <vector>
+
+#include "gameboy.h"
+
+namespace gandalf {
+    /**
+     * Runs many instances of the same ROM in lockstep, for example to train agents that each give different input. All instances start
+     * from the same state. Instances that received the same input so far are identical, so they share a single Gameboy, called a group.
+     * When the input of the instances of a group diverges, the group is split by cloning its Gameboy through a save state. The work per
+     * step is proportional to the number of groups instead of the number of instances, so many instances fit on a core as long as their
+     * input partly agrees. The groups also share the ROM, see Gameboy::LoadROM(const Gameboy&).
+     *
+     * Groups are not merged when their states happen to converge again, because comparing the states would cost more than it saves.
+     *
+     * Experimental: the instances do not support breakpoints, listeners or audio output.
+     */
+    class GameboyBatch {
+    public:
+        /// The CPU registers of all instances in structure-of-arrays layout, element i belongs to instance i.
+        struct Registers {
+            std::vector<word> af;
+            std::vector<word> bc;
+            std::vector<word> de;
+            std::vector<word> hl;
+            std::vector<word> stack_pointer;
+            std::vector<word> program_counter;
+        };
+
+        /**
+         * @param model the model to emulate
+         * @param rom the ROM
+         * @param instances the number of instances
+         * @throws InvalidArgument when the number of instances is 0 or the ROM could not be loaded
+         */
+        GameboyBatch(Model model, const ROM& rom, std::size_t instances);
+        ~GameboyBatch();
+
+        GameboyBatch(const GameboyBatch&) = delete;
+        GameboyBatch& operator=(const GameboyBatch&) = delete;
+
+        /// Sets the state of a button of an instance, which takes effect at the start of the next step.
+        void SetButtonState(std::size_t instance, Joypad::Button button, bool pressed);
+
+        /**
+         * Runs every group until its next VBlank, see Gameboy::RunFrame().
+         * @throws Exception when a group could not be split
+         */
+        void RunFrame();
+
+        /**
+         * Runs every group for the given number of cycles, see Gameboy::RunCycles().
+         * @throws Exception when a group could not be split
+         */
+        void RunCycles(std::uint64_t cycles);
+
+        /**
+         * Reads an address in every instance without side effects, for example to observe the score of a game.
+         * @param address the address
+         * @param values receives the value of instance i at index i
+         */
+        void Read(word address, std::vector<byte>& values) const;
+
+        /// @returns The number of instances.
+        std::size_t GetSize() const { return group_of_.size(); }
+
+        /// @returns The number of Gameboys that are emulated.
+        std::size_t GetGroupCount() const { return groups_.size(); }
+
+        /**
+         * Reads the registers of every instance. They are only gathered when asked for, so a step does not pay for them.
+         * @param registers receives the registers of all instances
+         */
+        void ReadRegisters(Registers& registers) const;
+
+        /// @returns The Gameboy that emulates the instance, which is shared by all instances of its group.
+        const Gameboy& GetGameboy(std::size_t instance) const { return *groups_[group_of_[instance]].gb; }
+
+    private:
+        struct Group {
+            std::unique_ptr<Gameboy> gb;
+            byte buttons; // The buttons that are pressed in the Gameboy, bit n is Joypad::Button n
+        };
+
+        /// Splits the groups of which the instances have different buttons, and applies the buttons.
+        void UpdateGroups();
+
+        const Model model_;
+        std::vector<Group> groups_;
+        std::vector<std::size_t> group_of_; // The group of every instance
+        std::vector<byte> buttons_; // The buttons that are pressed in every instance
+    };
+} // namespace gandalf
+
+#endif
@@ -10,6 +10,7 @@
 #include "serial.h"
 #include "timer.h"
 #include "hdma.h"
+#include "perf_counters.h"
 
 namespace gandalf {
     class IO: public Serializable {
@@ -19,7 +20,14 @@ namespace gandalf {
 
         void Tick(unsigned int cycles, bool double_speed);
 
+        /// @returns The total number of cycles that the IO components have been ticked for.
+        std::uint64_t GetCycleCount() const { return cycles_; }
+
+        /// @returns The emulated time in cycles at normal speed, which unlike the cycle count does not run faster in double speed mode.
+        std::uint64_t GetTime() const { return time_; }
+
         const LCD& GetLCD() const { return lcd_; }
+        LCD& GetLCD() { return lcd_; }
         const PPU& GetPPU() const { return ppu_; }
         PPU& GetPPU() { return ppu_; }
         const Joypad& GetJoypad() const { return joypad_; }
@@ -28,6 +36,10 @@ namespace gandalf {
         APU& GetAPU() { return apu_; }
         const Timer& GetTimer() const { return timer_; }
         const DMA& GetDMA() const { return dma_; }
+        const Serial& GetSerial() const { return serial_; }
+        Serial& GetSerial() { return serial_; }
+        const PerfCounters& GetPerfCounters() const { return perf_counters_; }
+        PerfCounters& GetPerfCounters() { return perf_counters_; }
 
         void Serialize(std::ostream& os) const override;
         void Deserialize(std::istream& is, std::uint16_t version) override;
@@ -35,6 +47,22 @@ namespace gandalf {
         void SetMode(GameboyMode mode);
 
     private:
+        /// Marks the frame boundaries in the performance counters.
+        class PerfFrameListener: public PPU::VBlankListener {
+        public:
+            explicit PerfFrameListener(PerfCounters& counters): counters_(counters) {}
+            void OnVBlank() override { counters_.EndFrame(); }
+
+        private:
+            PerfCounters& counters_;
+        };
+
+        /// Runs the per-cycle loop with the checks on the mode resolved at compile time.
+        template <GameboyMode mode>
+        void TickCycles(unsigned int cycles, bool double_speed);
+
+        PerfCounters perf_counters_;
+        PerfFrameListener perf_frame_listener_;
         Memory& memory_;
         Timer timer_;
         LCD lcd_;
@@ -46,6 +74,8 @@ namespace gandalf {
         HDMA hdma_;
 
         GameboyMode mode_;
+        std::uint64_t cycles_;
+        std::uint64_t time_;
     };
 } // namespace gandalf
 
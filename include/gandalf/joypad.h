@@ -22,10 +22,27 @@ namespace gandalf
             Start,
         };
 
+        /// Receives the changes of the button states, for example to record them.
+        class Listener {
+        public:
+            virtual ~Listener() = default;
+
+            /**
+             * Called when a button is pressed or released, before the new state is visible to the emulated program.
+             * @param button the button
+             * @param pressed whether the button is pressed
+             */
+            virtual void OnButtonStateChanged(Button button, bool pressed) = 0;
+        };
+
         Joypad(Memory& memory);
         virtual ~Joypad();
 
         void SetButtonState(Button button, bool pressed);
+        bool IsPressed(Button button) const { return pressed_buttons_[button]; }
+
+        /// @param listener the listener, or nullptr
+        void SetListener(Listener* listener) { listener_ = listener; }
 
         byte Read(word address) const override;
         void Write(word address, byte value) override;
@@ -40,6 +57,7 @@ namespace gandalf
         std::array<bool, 8> pressed_buttons_;
         byte p1_;
         Memory& memory_;
+        Listener* listener_;
     };
 }
 
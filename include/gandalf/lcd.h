@@ -2,9 +2,13 @@
 #define __GANDALF_LCD_H
 
 #include <array>
+#include <atomic>
+#include <bitset>
+#include <vector>
 
 #include "constants.h"
 #include "memory.h"
+#include "observation.h"
 #include "serialization.h"
 
 namespace gandalf {
@@ -12,6 +16,7 @@ namespace gandalf {
     public:
         using ABGR1555 = word;
         using VideoBuffer = std::array<ABGR1555, ScreenWidth* ScreenHeight>;
+        using LineMask = std::bitset<ScreenHeight>; ///< One bit per line, indexed by LY
 
         LCD(GameboyMode mode);
         virtual ~LCD();
@@ -74,9 +79,107 @@ namespace gandalf {
          */
         void RenderPixel(byte x, byte color_index, bool is_sprite, byte palette_index);
 
-        const VideoBuffer& GetVideoBuffer() const { return video_buffer_; }
+        /**
+         * Same as RenderPixel(), with the color lookup for the mode resolved at compile time. The palette index is not checked.
+         * @tparam mode the current mode, which must be equal to the mode that was set
+         */
+        template <GameboyMode mode>
+        void RenderPixel(byte x, byte color_index, bool is_sprite, byte palette_index);
+
+        /**
+         * Returns the most recently completed frame, also after Gameboy::RunFrame() returns and while the VBlank listeners are called.
+         * The buffer is not rendered into until a newer frame was completed. A loaded state only changes it with its next frame. Must
+         * only be called from the thread that runs the emulation.
+         */
+        const VideoBuffer& GetVideoBuffer() const { return buffers_[published_index_]; }
+
+        /**
+         * Makes the frame that is currently being rendered available to GetVideoBuffer() and AcquireFrame(), and starts rendering into
+         * a free buffer. Called by the PPU when VBlank starts, before the VBlank listeners.
+         */
+        void PublishFrame();
+
+        /**
+         * Gives access to the most recently completed frame without copying it. The buffer is not modified until ReleaseFrame() is called,
+         * so this can be called from a different thread than the one that runs the emulation. Only one frame can be acquired at a time.
+         * @returns The frame, or nullptr when no frame was completed since the previous call
+         * @throws Exception when the previous frame was not released
+         */
+        const VideoBuffer* AcquireFrame();
+
+        /// Releases the frame that was returned by AcquireFrame(), it may be reused after this call.
+        void ReleaseFrame();
+
+        /**
+         * Enables recording an Observation of every frame next to the video buffer. Disabled by default.
+         * Must not be called while a frame is acquired.
+         */
+        void SetObservationOutput(bool enabled);
+
+        /**
+         * Enables writing colors to the video buffer, enabled by default. Disabling it saves the palette lookups when only the observation
+         * is used. The buffers then keep the colors of older frames, so GetVideoBuffer() and AcquireFrame() return stale frames from the
+         * rotation of the three buffers, not the last frame with colors.
+         */
+        void SetColorOutput(bool enabled) { color_output_ = enabled; }
+
+        /// @returns The observation of the frame that was returned by AcquireFrame(), or nullptr when the observation output is disabled.
+        const Observation* GetAcquiredObservation() const;
+
+        /**
+         * Returns a 64 bit hash of the most recently completed frame. The hash is built line by line while the frame is rendered, so
+         * it costs no extra pass over the video buffer. It only depends on the colors in the video buffer, so it does not change
+         * while the color output is disabled. Must only be called from the thread that runs the emulation.
+         */
+        std::uint64_t GetFrameHash() const { return frame_hash_; }
+
+        /// @returns Whether the most recently completed frame is identical to the frame before it, according to their hashes.
+        bool IsFrameUnchanged() const { return frame_unchanged_; }
+
+        /// @returns The hash of the frame that was returned by AcquireFrame(), see GetFrameHash().
+        std::uint64_t GetAcquiredFrameHash() const { return frame_hashes_[front_index_]; }
+
+        /**
+         * Returns the lines of the most recently completed frame that differ from the frame before it, lines are compared by their
+         * hashes. All lines are marked for the first frame. Must only be called from the thread that runs the emulation.
+         */
+        const LineMask& GetDirtyLines() const { return dirty_lines_; }
+
+        /**
+         * Returns the lines of the frame that was returned by AcquireFrame() that differ from the previously acquired frame, so that
+         * only these lines have to be uploaded. Frames that were completed but never acquired are taken into account, the mask may
+         * contain lines that did not change when a frame was completed while this frame was acquired.
+         */
+        const LineMask& GetAcquiredDirtyLines() const { return acquired_dirty_lines_[front_index_]; }
+
     private:
-        VideoBuffer video_buffer_;
+        using LineHashes = std::array<std::uint64_t, ScreenHeight>;
+
+        void HashLine(unsigned int buffer_index, byte line);
+
+        static constexpr unsigned int kBufferCount = 3;
+        static constexpr unsigned int kIndexMask = 0x3;
+        static constexpr unsigned int kNewFrameFlag = 0x4;
+
+        // Triple buffering: the PPU renders into the back buffer and the reader owns the front buffer, the third buffer holds the last
+        // completed frame. Buffers are exchanged by swapping indices with ready_index_, which also indicates whether the frame is new.
+        std::array<VideoBuffer, kBufferCount> buffers_;
+        std::vector<Observation> observations_; // Empty when the observation output is disabled, indexed like buffers_
+        std::array<LineHashes, kBufferCount> line_hashes_; // Hash of every line in buffers_, updated when the last pixel of a line is rendered
+        std::array<std::uint64_t, kBufferCount> frame_hashes_;
+        std::uint64_t frame_hash_;
+        bool frame_unchanged_;
+        LineHashes published_line_hashes_; // Line hashes of the most recently completed frame
+        LineMask dirty_lines_;
+        std::array<LineMask, kBufferCount> acquired_dirty_lines_; // Changed lines since the previously acquired frame, indexed like buffers_
+        bool frame_published_;
+        bool color_output_;
+        unsigned int back_index_;
+        unsigned int front_index_;
+        std::atomic<unsigned int> ready_index_;
+        unsigned int published_index_; // The most recently completed frame, which is either the ready or the front buffer
+        bool frame_acquired_;
+
         byte lcdc_;
         byte ly_;
         byte lyc_;
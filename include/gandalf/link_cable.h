@@ -0,0 +1,46 @@
+#ifndef __GANDALF_LINK_CABLE_H
+#define __GANDALF_LINK_CABLE_H
+
+#include "gameboy.h"
+
+namespace gandalf {
+    /**
+     * Connects the serial ports of two Gameboy instances in the same process and runs them in lockstep.
+     * While a transfer is in progress, the instances are run alternately in chunks that end before the next bit is shifted, so that both
+     * instances are synchronized (to within one instruction) whenever a bit is exchanged. While the link is idle the chunks are much
+     * longer, and an instance that starts a transfer ends its chunk right away. The first instance runs ahead in an idle chunk, so when
+     * the second instance starts a transfer, the first one is restored from a snapshot that was taken at the start of the chunk and run
+     * again up to the cycle of the transfer. Listeners of the first instance, for example VBlank listeners and audio output, see the
+     * cycles that were run again twice.
+     */
+    class LinkCable {
+    public:
+        LinkCable(Gameboy& first, Gameboy& second);
+        ~LinkCable();
+
+        LinkCable(const LinkCable&) = delete;
+        LinkCable& operator=(const LinkCable&) = delete;
+
+        /**
+         * Runs both instances for the given number of cycles.
+         * @param cycles the number of cycles to run
+         * @returns False when one of the instances was stopped early by a breakpoint or watchpoint, true otherwise
+         * @throws Exception when the first instance could not be rewound
+         */
+        bool RunCycles(std::uint64_t cycles);
+
+        /// Runs both instances for the duration of a frame, which takes twice as many cycles while the first instance is in double speed mode.
+        bool RunFrame();
+
+    private:
+        std::uint64_t GetMaximumChunk() const;
+
+        Gameboy& first_;
+        Gameboy& second_;
+        std::uint64_t first_start_;
+        std::uint64_t second_start_;
+        std::uint64_t elapsed_;
+    };
+} // namespace gandalf
+
+#endif
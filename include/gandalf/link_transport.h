@@ -0,0 +1,120 @@
+#ifndef __GANDALF_LINK_TRANSPORT_H
+#define __GANDALF_LINK_TRANSPORT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace gandalf {
+    /// A message that is exchanged between two RemoteLink instances.
+    struct LinkMessage {
+        enum class Type: byte {
+            Sync,     ///< The sender has reached the given time
+            Transfer, ///< The sender completed a transfer with its internal clock at the given time
+            Reply,    ///< The byte that the receiver of a transfer sent back, the time is the time of the transfer
+        };
+
+        Type type;
+        std::uint64_t time;
+        byte value;
+
+        /// Size of a message on the wire.
+        static constexpr std::size_t Size = 10;
+
+        void Encode(byte* buffer) const;
+        static LinkMessage Decode(const byte* buffer);
+    };
+
+    /// Transports link messages to the other side of a RemoteLink.
+    class LinkTransport {
+    public:
+        virtual ~LinkTransport() = default;
+
+        /// Sends a message, without waiting for the other side to receive it.
+        virtual void Send(const LinkMessage& message) = 0;
+
+        /**
+         * Receives the next message.
+         * @param message [out] the received message
+         * @param timeout the maximum time to wait for a message
+         * @returns Whether a message was received
+         */
+        virtual bool Receive(LinkMessage& message, std::chrono::milliseconds timeout) = 0;
+
+        /// @returns Whether the other side is still connected.
+        virtual bool IsConnected() const = 0;
+    };
+
+    /// Transport between two RemoteLink instances in the same process, which is mainly useful for testing.
+    class LoopbackTransport: public LinkTransport {
+    public:
+        ~LoopbackTransport();
+
+        /// @returns Two connected transports.
+        static std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>> CreatePair();
+
+        void Send(const LinkMessage& message) override;
+        bool Receive(LinkMessage& message, std::chrono::milliseconds timeout) override;
+        bool IsConnected() const override;
+
+    private:
+        struct Channel {
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<LinkMessage> messages;
+            bool closed = false;
+        };
+
+        LoopbackTransport(std::shared_ptr<Channel> incoming, std::shared_ptr<Channel> outgoing);
+
+        std::shared_ptr<Channel> incoming_;
+        std::shared_ptr<Channel> outgoing_;
+    };
+
+#ifndef _WIN32
+    /// Transport over a Unix domain stream socket.
+    class SocketTransport: public LinkTransport {
+    public:
+        /// @param socket a connected stream socket, which is closed when the transport is destroyed
+        explicit SocketTransport(int socket);
+        ~SocketTransport();
+
+        SocketTransport(const SocketTransport&) = delete;
+        SocketTransport& operator=(const SocketTransport&) = delete;
+
+        /**
+         * Creates a socket at the given path and waits until the other side connects.
+         * @throws Exception when the socket cannot be created
+         */
+        static std::unique_ptr<SocketTransport> Listen(const std::string& path);
+
+        /**
+         * Connects to a socket that was created with Listen().
+         * @throws Exception when the connection fails
+         */
+        static std::unique_ptr<SocketTransport> Connect(const std::string& path);
+
+        /// @returns Two connected transports, using an unnamed socket pair.
+        static std::pair<std::unique_ptr<SocketTransport>, std::unique_ptr<SocketTransport>> CreatePair();
+
+        void Send(const LinkMessage& message) override;
+        bool Receive(LinkMessage& message, std::chrono::milliseconds timeout) override;
+        bool IsConnected() const override { return connected_; }
+
+    private:
+        int socket_;
+        bool connected_;
+        std::vector<byte> receive_buffer_;
+    };
+#endif
+} // namespace gandalf
+
+#endif
@@ -2,6 +2,9 @@
 #define __GANDALF_MBC_H
 
 #include <array>
+#include <cstdint>
+#include <iostream>
+#include <memory>
 #include <vector>
 #include "serialization.h"
 #include "types.h"
@@ -11,23 +14,102 @@ namespace gandalf
     constexpr std::size_t ROMBankSize = 0x4000;
     constexpr std::size_t RAMBankSize = 0x2000;
 
+    /// Provides the time for the real-time clock of a cartridge.
+    class RTCClock
+    {
+    public:
+        virtual ~RTCClock() = default;
+
+        /// @returns The current time in cycles at normal speed, CPUFrequency per second.
+        virtual std::uint64_t GetTime() const = 0;
+
+        /**
+         * @returns Whether the time is the host time since the UNIX epoch, in which case the time between saving and loading a battery
+         * save counts as well.
+         */
+        virtual bool IsHostTime() const = 0;
+    };
+
     class MBC: public Serializable
     {
     public:
-        MBC(const ROM& rom, std::size_t rom_banks, std::size_t ram_banks);
+        using ROMBank = std::array<byte, ROMBankSize>;
+        using RAMBank = std::array<byte, RAMBankSize>;
+
+        /// The ROM is never written, so it is shared by all MBCs that are created for the same cartridge, see Cartridge::Load(const Cartridge&).
+        using SharedROM = std::shared_ptr<const std::vector<ROMBank>>;
+
+        MBC(SharedROM rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery);
         virtual ~MBC();
 
         virtual byte Read(word address) const = 0;
         virtual void Write(word address, byte value) = 0;
 
+        /// @returns The ROM or RAM bank that is currently mapped at the given address.
+        virtual word GetBank(word address) const = 0;
+
+        /// @returns Whether the RAM is kept by a battery when the power is off.
+        bool HasBattery() const { return has_battery_; }
+
+        const SharedROM& GetROM() const { return rom_storage_; }
+        const std::vector<RAMBank>& GetRAM() const { return ram_; }
+
+        /**
+         * Replaces the contents of the RAM, for example with a battery save. All banks are marked as dirty.
+         * @param is the stream that contains the banks in order, optionally followed by the footer of the MBC
+         * @throws SerializationException when the stream contains less data than the RAM
+         */
+        void LoadRAM(std::istream& is);
+
+        /// Writes the contents of the RAM followed by the footer, which is the format of a battery save.
+        void SaveRAM(std::ostream& os) const;
+
+        /// Writes the data that follows the RAM in a battery save, for example the state of a real-time clock. Nothing by default.
+        virtual void SaveFooter(std::ostream& os) const;
+
+        /**
+         * Sets the time source of the real-time clock, the time that passed with the previous source is kept. Ignored by MBCs without
+         * a clock.
+         * @param clock the clock, or nullptr to stop the time
+         */
+        virtual void SetClock(const RTCClock* clock);
+
+        /// @returns A mask of the RAM banks that were written since the last call, bit n is set for bank n.
+        std::uint32_t TakeDirtyRAMBanks();
+
+        /**
+         * @returns Whether the footer changed since the last call other than by the passing of time, for example because the clock
+         * registers were written. The time itself is recomputed from the timestamp of the footer when it is loaded.
+         */
+        bool TakeDirtyFooter();
+
+        /// Serializes the RAM and the state of the MBC, the ROM is serialized by the Cartridge.
         void Serialize(std::ostream& os) const override;
         void Deserialize(std::istream& is, std::uint16_t version) override;
 
     protected:
-        using ROMBank = std::array<byte, ROMBankSize>;
-        using RAMBank = std::array<byte, RAMBankSize>;
-        std::vector<ROMBank> rom_;
+        void MarkFooterDirty() { footer_dirty_ = true; }
+
+        /// Reads the footer that follows the RAM in a battery save, a missing footer must be accepted. Nothing by default.
+        virtual void LoadFooter(std::istream& is);
+
+        void WriteRAM(std::size_t bank, std::size_t offset, byte value)
+        {
+            if (ram_[bank][offset] == value)
+                return;
+            ram_[bank][offset] = value;
+            dirty_ram_banks_ |= std::uint32_t(1) << bank;
+        }
+
+        const ROMBank* rom_; // The banks of rom_storage_
+        std::size_t rom_banks_;
         std::vector<RAMBank> ram_;
+        bool has_battery_;
+
+    private:
+        SharedROM rom_storage_;
+        std::uint32_t dirty_ram_banks_;
+        bool footer_dirty_;
     };
 }
 
@@ -6,10 +6,16 @@
 #include <memory>
 #include <stdexcept>
 #include <set>
+#include <utility>
 
 #include "types.h"
 
 namespace gandalf {
+  class Cartridge;
+  class HRAM;
+  class LCD;
+  class WRAM;
+
   /**
    * Gives access to the Game Boy's 16-bit address space.
    */
@@ -37,6 +43,12 @@ namespace gandalf {
       /// @return The addresses that are managed by this object.
       virtual std::set<word> GetAddresses() const = 0;
 
+      /**
+       * @param address the address for which the bank is requested.
+       * @return The bank that is currently mapped at the specified address, 0 for unbanked memory.
+       */
+      virtual word GetBank(word address) const;
+
       /// @returns The name of this handler.
       std::string GetName() const { return name_; }
 
@@ -46,6 +58,22 @@ namespace gandalf {
       std::string name_;
     };
 
+    /// Receives the accesses to addresses that have a watchpoint.
+    class WatchListener
+    {
+    public:
+      /**
+       * Called after a watched address has been accessed.
+       * @param address the address that was accessed
+       * @param value the value that was read or written
+       * @param write whether the access was a write
+       */
+      virtual void OnWatchpoint(word address, byte value, bool write) = 0;
+    };
+
+    /// Bank value for breakpoints that match regardless of the mapped bank.
+    static constexpr word AnyBank = 0xFFFF;
+
     enum Bus: byte
     {
       External,
@@ -80,6 +108,16 @@ namespace gandalf {
      */
     void Register(AddressHandler& handler);
 
+    /**
+     * Registers one of the fixed components, which are accessed through their concrete type instead of a virtual call. A handler that is
+     * registered later for some of their addresses takes over those addresses as usual.
+     * @param component the component
+     */
+    void Register(Cartridge& component);
+    void Register(HRAM& component);
+    void Register(LCD& component);
+    void Register(WRAM& component);
+
     /**
      * Removes the specified address handler from the memory.
      *
@@ -87,12 +125,26 @@ namespace gandalf {
     */
     void Unregister(AddressHandler& handler);
 
+    /**
+     * Removes a handler that was mapped over the cartridge, for example the boot ROM, and gives its addresses back to the cartridge. Only
+     * the addresses that the handler still owns are changed, so handlers that were registered later stay in place.
+     * @param handler the handler
+     * @param cartridge the cartridge below the handler
+     */
+    void Unregister(AddressHandler& handler, Cartridge& cartridge);
+
     /**
      * @param address Address for which the name is requested.
      * @returns The name of the object that owns the specified address.
      */
     std::string GetAddressHandlerName(word address) const;
 
+    /**
+     * @param address Address for which the bank is requested.
+     * @returns The bank that is currently mapped at the specified address.
+     */
+    word GetBank(word address) const;
+
     /**
      * @param address Address for which the bus is requested.
      * @returns Which Bus handles reads/writes of the given address.
@@ -101,13 +153,67 @@ namespace gandalf {
 
     void Block(Bus bus, bool block = true);
 
+    /**
+     * Sets a watchpoint on the specified address. Only accesses with check_access enabled are reported.
+     * @param address the address to watch
+     * @param read whether reads are reported
+     * @param write whether writes are reported
+     */
+    void SetWatchpoint(word address, bool read, bool write);
+
+    /// @param listener the listener that is notified of watchpoint hits, or nullptr
+    void SetWatchListener(WatchListener* listener) { watch_listener_ = listener; }
+
+    /**
+     * Adds an execution breakpoint. The memory only keeps track of the breakpoints, it is up to the caller to check them before executing an instruction.
+     * @param bank the bank in which the breakpoint is set, or AnyBank
+     * @param address the address of the breakpoint
+     */
+    void AddBreakpoint(word bank, word address);
+    void RemoveBreakpoint(word bank, word address);
+
+    /// @returns Whether the specified address has a breakpoint in any bank.
+    bool HasBreakpoint(word address) const { return address_space_[address].flags & BreakpointFlag; }
+
+    /// @returns Whether the specified address has a breakpoint in the bank that is currently mapped.
+    bool IsBreakpoint(word address) const;
+
   private:
+    enum Flags: byte
+    {
+      BlockedFlag = 0x1,
+      WatchReadFlag = 0x2,
+      WatchWriteFlag = 0x4,
+      BreakpointFlag = 0x8,
+    };
+
+    /// The concrete type of the handler of an address, for the components that are dispatched without a virtual call.
+    enum class Component: byte
+    {
+      Handler,
+      Cartridge,
+      HRAM,
+      LCD,
+      WRAM,
+    };
+
     struct AddressWrapper
     {
       AddressHandler* handler;
-      bool blocked;
+      byte flags;
+      Component component;
     };
+
+    void Register(AddressHandler& handler, Component component);
+    void WriteHandler(const AddressWrapper& wrapper, word address, byte value);
+    byte ReadHandler(const AddressWrapper& wrapper, word address) const;
+    void SetFlag(word address, Flags flag, bool set);
+    void WriteSlow(word address, byte value, bool check_access);
+    byte ReadSlow(word address, bool check_access) const;
+
     std::array<AddressWrapper, 0x10000> address_space_;
+    std::set<std::pair<word, word>> breakpoints_; // (address, bank)
+    WatchListener* watch_listener_;
   };
 
 } // namespace gandalf
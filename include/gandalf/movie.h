@@ -0,0 +1,140 @@
+#ifndef __GANDALF_MOVIE_H
+#define __GANDALF_MOVIE_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gameboy.h"
+
+namespace gandalf {
+    /**
+     * A recording of the joypad input of a session, which starts from a save state. Every change of the buttons is stored with the emulated
+     * cycle at which it was made, so replaying the movie reproduces the session exactly, independent of the frame rate or speed of the
+     * host. Replays are only exact with the emulated real-time clock, see Gameboy::SetRTCMode().
+     *
+     * The file format is little-endian: the magic "GMOV", a 16-bit version, and then as unsigned LEB128 varints the size of the save state
+     * followed by the save state, the length of the movie in cycles and the number of events. Each event is the number of cycles since the
+     * previous event (or the start) as a varint, followed by a byte with the pressed buttons, bit n is Joypad::Button n.
+     */
+    class Movie {
+    public:
+        struct Event {
+            std::uint64_t cycle; ///< Cycles since the start of the movie
+            byte buttons; ///< The pressed buttons after the change, bit n is Joypad::Button n
+        };
+
+        Movie();
+
+        /**
+         * @param state the save state at the start of the movie
+         * @param events the events in order of their cycle
+         * @param length the length of the movie in cycles, at least the cycle of the last event
+         * @throws InvalidArgument when the events are not in order or exceed the length
+         */
+        Movie(const std::string& state, const std::vector<Event>& events, std::uint64_t length);
+
+        /**
+         * Reads a movie.
+         * @param is the stream to read from
+         * @returns The movie
+         * @throws SerializationException when the movie could not be read or is invalid
+         */
+        static Movie Load(std::istream& is);
+
+        /**
+         * Writes the movie.
+         * @param os the stream to write to
+         * @throws SerializationException when writing failed
+         */
+        void Save(std::ostream& os) const;
+
+        const std::string& GetState() const { return state_; }
+        const std::vector<Event>& GetEvents() const { return events_; }
+
+        /// @returns The length of the movie in cycles.
+        std::uint64_t GetLength() const { return length_; }
+
+    private:
+        std::string state_;
+        std::vector<Event> events_;
+        std::uint64_t length_;
+    };
+
+    /**
+     * Records a Movie from the current state of a Gameboy. The button changes are received through Gameboy::SetJoypadListener(), so the
+     * input can be applied with Gameboy::SetButtonState() as usual. Loading a save state while recording invalidates the recording.
+     */
+    class MovieRecorder: public Joypad::Listener {
+    public:
+        /**
+         * Saves the state of the Gameboy and starts recording.
+         * @param gb the Gameboy, which must outlive this object and must have a ROM loaded
+         * @throws Exception when the state could not be saved
+         */
+        MovieRecorder(Gameboy& gb);
+        ~MovieRecorder();
+
+        MovieRecorder(const MovieRecorder&) = delete;
+        MovieRecorder& operator=(const MovieRecorder&) = delete;
+
+        void OnButtonStateChanged(Joypad::Button button, bool pressed) override;
+
+        /// @returns The movie from the start of the recording up to the current cycle.
+        Movie GetMovie() const;
+
+    private:
+        Gameboy& gb_;
+        const std::uint64_t start_cycles_;
+        std::string state_;
+        std::vector<Movie::Event> events_;
+        byte buttons_;
+    };
+
+    /**
+     * Replays a Movie on a Gameboy. For benchmarks and regression runs the replay is fastest without output, see Gameboy::SetColorOutput()
+     * and Gameboy::SetAudioHandler().
+     */
+    class MoviePlayer {
+    public:
+        /**
+         * Loads the save state of the movie into the Gameboy.
+         * @param gb the Gameboy, which must outlive this object
+         * @param movie the movie, which must outlive this object
+         * @throws Exception when the save state could not be loaded
+         */
+        MoviePlayer(Gameboy& gb, const Movie& movie);
+
+        MoviePlayer(const MoviePlayer&) = delete;
+        MoviePlayer& operator=(const MoviePlayer&) = delete;
+
+        /**
+         * Runs the Gameboy and applies the recorded input at the recorded cycles, until the given number of cycles has passed or the movie
+         * has ended.
+         * @param cycles the number of cycles to run
+         * @returns False when the emulation was stopped early by a breakpoint or watchpoint, true otherwise
+         */
+        bool RunCycles(std::uint64_t cycles);
+
+        /// Runs until the end of the movie, see RunCycles().
+        bool RunToEnd() { return RunCycles(movie_.GetLength()); }
+
+        /// @returns Whether the end of the movie has been reached.
+        bool Finished() const { return GetPosition() >= movie_.GetLength(); }
+
+        /// @returns The number of cycles since the start of the movie.
+        std::uint64_t GetPosition() const { return gb_.GetCycleCount() - start_cycles_; }
+
+    private:
+        void ApplyEvents();
+
+        Gameboy& gb_;
+        const Movie& movie_;
+        std::uint64_t start_cycles_;
+        std::size_t next_event_;
+        byte buttons_;
+    };
+} // namespace gandalf
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __GANDALF_OBSERVATION_H
+#define __GANDALF_OBSERVATION_H
+
+#include <array>
+#include <cstddef>
+
+#include "constants.h"
+#include "types.h"
+
+namespace gandalf {
+    /**
+     * Compact description of a frame before the palettes are applied, intended for machine learning agents that do not need colors.
+     * Recorded by the LCD when the observation output is enabled, see LCD::SetObservationOutput().
+     */
+    struct Observation {
+        static constexpr std::size_t PixelCount = ScreenWidth * ScreenHeight;
+
+        std::array<byte, PixelCount> color_indices; ///< The color index (0-3) of every pixel, one byte per pixel
+        std::array<byte, PixelCount / 8> sprite_mask; ///< One bit per pixel that is set for sprite pixels, the first pixel is the most significant bit
+
+        bool IsSprite(std::size_t pixel) const { return (sprite_mask[pixel / 8] & (0x80 >> (pixel % 8))) != 0; }
+    };
+
+    /**
+     * Packs color indices into 2 bits per pixel, 4 pixels per byte with the first pixel in the most significant bits.
+     * @param indices the color indices (0-3)
+     * @param output the output buffer, which must hold (count + 3) / 4 bytes
+     * @param count the number of pixels
+     */
+    void PackColorIndices(const byte* indices, byte* output, std::size_t count);
+
+    /**
+     * Downsamples the color indices of a frame by taking the top left pixel of every factor x factor block.
+     * @param observation the observation
+     * @param factor the downsampling factor, which must divide both the width and the height of the screen (2, 4 or 8)
+     * @param output the output buffer, which must hold (ScreenWidth / factor) * (ScreenHeight / factor) bytes
+     * @throws InvalidArgument when the factor does not divide the screen size
+     */
+    void DownsampleColorIndices(const Observation& observation, int factor, byte* output);
+} // namespace gandalf
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef __GANDALF_PERF_COUNTERS_H
+#define __GANDALF_PERF_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+
+namespace gandalf {
+    /// Low overhead clock that is used to measure the host time spent in the emulator components.
+    class PerfClock {
+    public:
+        /// @returns The current value of the time stamp counter, or the steady clock in nanoseconds when no time stamp counter is available.
+        static std::uint64_t Now();
+
+        /// @returns The number of ticks returned by Now() per second, measured on the first call.
+        static double GetTicksPerSecond();
+    };
+
+    /**
+     * Accumulates the host time spent in each of the emulator components. The time is exclusive: when a component calls into another
+     * component, the time is accounted to the callee. The counters are only updated when the library is built with GANDALF_ENABLE_PERF_COUNTERS.
+     */
+    class PerfCounters {
+    public:
+        enum class Component {
+            CPU,
+            Memory,
+            Timer,
+            PPU,
+            APU,
+            DMA,
+            HDMA,
+            None
+        };
+
+        static constexpr std::size_t ComponentCount = static_cast<std::size_t>(Component::None);
+
+        struct Frame {
+            std::uint64_t start;
+            std::uint64_t end;
+            std::array<std::uint64_t, ComponentCount> ticks;
+        };
+
+        PerfCounters();
+        ~PerfCounters();
+
+        /// Clears all counters and recorded frames.
+        void Reset();
+
+        /**
+         * Makes the given component the active component.
+         * @param component the component that is entered
+         * @returns The component that was active before, which should be passed to Leave().
+         */
+        Component Enter(Component component)
+        {
+            const Component previous = current_;
+            Switch(component);
+            ++calls_[static_cast<std::size_t>(component)];
+            return previous;
+        }
+
+        /// Leaves the active component and makes the given component active again.
+        void Leave(Component previous) { Switch(previous); }
+
+        /// Marks the end of a frame, the ticks per component since the previous frame are recorded in the frame history.
+        void EndFrame();
+
+        /// @param max_frames the maximum number of frames that are kept in the frame history.
+        void SetMaxFrames(std::size_t max_frames);
+
+        std::uint64_t GetTicks(Component component) const { return ticks_[static_cast<std::size_t>(component)]; }
+        std::uint64_t GetCalls(Component component) const { return calls_[static_cast<std::size_t>(component)]; }
+        double GetSeconds(Component component) const;
+        const std::deque<Frame>& GetFrames() const { return frames_; }
+
+        static const char* GetComponentName(Component component);
+
+        /**
+         * Writes the recorded frames in the Chrome trace event format (JSON), which can be loaded in chrome://tracing or Perfetto.
+         * Every component is shown on its own track, with one event per frame whose duration is the time spent in the component.
+         * @param os the stream to write to
+         */
+        void WriteChromeTrace(std::ostream& os) const;
+
+    private:
+        void Switch(Component component)
+        {
+            const std::uint64_t now = PerfClock::Now();
+            if (current_ != Component::None)
+                ticks_[static_cast<std::size_t>(current_)] += now - last_timestamp_;
+            last_timestamp_ = now;
+            current_ = component;
+        }
+
+        std::array<std::uint64_t, ComponentCount> ticks_;
+        std::array<std::uint64_t, ComponentCount> calls_;
+        Component current_;
+        std::uint64_t last_timestamp_;
+
+        std::deque<Frame> frames_;
+        std::size_t max_frames_;
+        std::uint64_t frame_start_;
+        std::array<std::uint64_t, ComponentCount> frame_start_ticks_;
+    };
+
+    /// Makes a component active for the lifetime of this object.
+    class PerfScope {
+    public:
+        PerfScope(PerfCounters& counters, PerfCounters::Component component): counters_(counters), previous_(counters.Enter(component)) {}
+        ~PerfScope() { counters_.Leave(previous_); }
+
+        PerfScope(const PerfScope&) = delete;
+        PerfScope& operator=(const PerfScope&) = delete;
+
+    private:
+        PerfCounters& counters_;
+        PerfCounters::Component previous_;
+    };
+} // namespace gandalf
+
+#ifdef GANDALF_ENABLE_PERF_COUNTERS
+#define GANDALF_PERF_SCOPE(counters, component) ::gandalf::PerfScope gandalf_perf_scope((counters), ::gandalf::PerfCounters::Component::component)
+#else
+#define GANDALF_PERF_SCOPE(counters, component)
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef __GANDALF_PIXEL_FORMAT_H
+#define __GANDALF_PIXEL_FORMAT_H
+
+#include <cstddef>
+
+#include "lcd.h"
+
+namespace gandalf {
+    /**
+     * Output formats that a frame can be converted to. The color indices before the palettes are applied cannot be derived from a
+     * frame, they are recorded in an Observation instead, see LCD::SetObservationOutput() and PackColorIndices().
+     */
+    enum class PixelFormat {
+        ABGR1555,   ///< The native format of the LCD, 16 bits per pixel in host byte order
+        RGBA8888,   ///< 4 bytes per pixel in the order R, G, B, A, alpha is always 255
+        Grayscale8, ///< 1 byte per pixel, full range luma
+        YUV420      ///< Planar I420: a full resolution Y plane followed by U and V planes of half the width and height, BT.601 video range
+    };
+
+    /// @returns The number of bytes of a frame in the given format.
+    std::size_t GetFrameSize(PixelFormat format);
+
+    /**
+     * Converts a frame to the given format. SSE2 or NEON is used when the target supports it.
+     * @param frame the frame, as returned by LCD::AcquireFrame() or LCD::GetVideoBuffer()
+     * @param format the output format
+     * @param output the output buffer, which must hold GetFrameSize(format) bytes
+     */
+    void ConvertFrame(const LCD::VideoBuffer& frame, PixelFormat format, byte* output);
+
+    /**
+     * Converts pixels to RGBA8888.
+     * @param input the ABGR1555 pixels
+     * @param output the output buffer, which must hold 4 * count bytes
+     * @param count the number of pixels
+     */
+    void ConvertToRGBA8888(const LCD::ABGR1555* input, byte* output, std::size_t count);
+
+    /**
+     * Converts pixels to 8 bit grayscale.
+     * @param input the ABGR1555 pixels
+     * @param output the output buffer, which must hold count bytes
+     * @param count the number of pixels
+     */
+    void ConvertToGrayscale8(const LCD::ABGR1555* input, byte* output, std::size_t count);
+} // namespace gandalf
+
+#endif
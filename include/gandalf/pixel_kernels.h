@@ -0,0 +1,46 @@
+#ifndef __GANDALF_PIXEL_KERNELS_H
+#define __GANDALF_PIXEL_KERNELS_H
+
+#include <cstddef>
+
+#include "lcd.h"
+
+namespace gandalf {
+    /**
+     * Vectorized building blocks for renderers that work on whole lines or tiles. SSE2 or NEON is used when the target supports it,
+     * otherwise a scalar implementation. All functions accept any count.
+     */
+    namespace kernels {
+        /**
+         * Decodes rows of 2 bits per pixel tile data to color indices.
+         * @param data the tile data, 2 bytes per row: the low bits followed by the high bits
+         * @param rows the number of rows
+         * @param flip_x whether the rows are flipped horizontally
+         * @param output the color indices, which must hold 8 * rows bytes
+         */
+        void DecodeTileRows(const byte* data, std::size_t rows, bool flip_x, byte* output);
+
+        /**
+         * Resolves the priority between background and sprite pixels. A sprite pixel is visible when it is not transparent (color 0),
+         * unless it is behind the background and the background pixel is not transparent.
+         * @param background the color indices of the background
+         * @param sprite the color indices of the sprites, 0 where there is no sprite
+         * @param sprite_behind non zero where the sprite is drawn behind the background
+         * @param output the resulting color indices
+         * @param from_sprite set to 1 where the sprite pixel is visible, 0 otherwise
+         * @param count the number of pixels
+         */
+        void MergeSprites(const byte* background, const byte* sprite, const byte* sprite_behind, byte* output, byte* from_sprite, std::size_t count);
+
+        /**
+         * Maps color indices to colors.
+         * @param indices the color indices, only the lower 2 bits are used
+         * @param palette the 4 colors of the palette
+         * @param output the colors
+         * @param count the number of pixels
+         */
+        void ApplyPalette(const byte* indices, const LCD::ABGR1555* palette, LCD::ABGR1555* output, std::size_t count);
+    } // namespace kernels
+} // namespace gandalf
+
+#endif
@@ -8,6 +8,7 @@
 #include "memory.h"
 #include "lcd.h"
 #include "serialization.h"
+#include "tile_cache.h"
 
 namespace gandalf {
     class PPU : public Memory::AddressHandler, public Serializable {
@@ -23,6 +24,14 @@ namespace gandalf {
 
         void Tick();
 
+        /**
+         * Same as Tick(), with the parts that depend on the mode resolved at compile time. The IO selects the instantiation once per
+         * batch of cycles, so the per dot path contains no mode checks.
+         * @tparam mode the current mode, which must be equal to the mode that was set
+         */
+        template <GameboyMode mode>
+        void Tick();
+
         byte Read(word address) const override;
         void Write(word address, byte value) override;
         std::set<word> GetAddresses() const override;
@@ -30,6 +39,9 @@ namespace gandalf {
         void AddVBlankListener(VBlankListener* listener) { vblank_listeners_.push_back(listener); }
         byte DebugReadVRam(int bank, word address) const;
 
+        /// @returns The decoded tiles in VRAM, which is useful for tile viewers.
+        const TileCache& GetTileCache() const { return tile_cache_; }
+
         void SetMode(GameboyMode mode);
 
         void Serialize(std::ostream& os) const override;
@@ -89,9 +101,10 @@ namespace gandalf {
 
         GameboyMode mode_;
 
-        using VRAMBank = std::array<byte, 0x2000>;
-        using VRAM = std::array<VRAMBank, 2>;
+        using VRAMBank = TileCache::VRAMBank;
+        using VRAM = TileCache::VRAM;
         VRAM vram_;
+        TileCache tile_cache_;
         int current_vram_bank_;
         byte opri_;
         std::array<byte, 0xA0> oam_;
@@ -106,6 +119,7 @@ namespace gandalf {
             Pipeline(GameboyMode mode, LCD& lcd, VRAM& vram, FetchedSprites& fetched_sprites);
             ~Pipeline();
 
+            template <GameboyMode mode>
             void Process();
             void Reset();
             bool Done() const;
@@ -114,10 +128,15 @@ namespace gandalf {
             void Serialize(std::ostream& os) const override;
             void Deserialize(std::istream& is, std::uint16_t version) override;
         private:
+            template <GameboyMode mode>
             void RenderPixel();
+            template <GameboyMode mode>
             void TileStateMachine();
+            template <GameboyMode mode>
             void SpriteStateMachine();
+            template <GameboyMode mode>
             void TryPush();
+            template <GameboyMode mode>
             void PushSprite();
 
             enum class FetcherState
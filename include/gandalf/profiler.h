@@ -0,0 +1,111 @@
+#ifndef __GANDALF_PROFILER_H
+#define __GANDALF_PROFILER_H
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "types.h"
+
+namespace gandalf {
+    /**
+     * Collects execution statistics of the emulated program. Instructions and cycles are counted per (bank, address) and per opcode,
+     * and the cycles are also accumulated per call stack, which is reconstructed from the executed CALL, RST and RET instructions.
+     */
+    class Profiler {
+    public:
+        struct Counters {
+            std::uint64_t instructions = 0;
+            std::uint64_t cycles = 0;
+        };
+
+        struct Location {
+            word bank;
+            word address;
+        };
+
+        struct HotSpot {
+            Location location;
+            Counters counters;
+        };
+
+        /// Number of opcodes that are tracked, the CB prefixed opcodes are stored at index 0x100 + opcode.
+        static constexpr std::size_t OpcodeCount = 0x200;
+
+        Profiler();
+        ~Profiler();
+
+        /**
+         * Records an executed instruction.
+         * @param bank the bank of the instruction address
+         * @param address the address of the instruction
+         * @param opcode the opcode, 0x100 + the second byte for CB prefixed instructions
+         * @param cycles the number of cycles the instruction took
+         */
+        void OnInstruction(word bank, word address, word opcode, std::uint32_t cycles);
+
+        /// Records cycles during which the CPU was halted at the given address.
+        void OnIdle(word bank, word address, std::uint32_t cycles);
+
+        /// Enters a new stack frame for the function at the given location.
+        void OnCall(word bank, word address);
+
+        /// Enters a new stack frame for the interrupt handler at the given address, the cycles of the interrupt dispatch are accounted to the handler.
+        void OnInterrupt(word address, std::uint32_t cycles);
+
+        /// Leaves the current stack frame.
+        void OnReturn();
+
+        /// Clears all collected statistics.
+        void Reset();
+
+        /// @returns The locations sorted by the number of cycles spent, in descending order.
+        std::vector<HotSpot> GetHotSpots() const;
+
+        /// @returns The counters per opcode.
+        const std::array<Counters, OpcodeCount>& GetOpcodeCounters() const { return opcodes_; }
+
+        /// @returns The total number of cycles that were recorded.
+        std::uint64_t GetTotalCycles() const { return total_cycles_; }
+
+        /**
+         * Writes a human readable report of the locations and opcodes in which the most cycles were spent.
+         * @param os the stream to write to
+         * @param max_entries the maximum number of entries per table
+         */
+        void WriteReport(std::ostream& os, std::size_t max_entries = 32) const;
+
+        /**
+         * Writes the cycles per call stack in the folded stack format, which can be used as input for flame graph tools.
+         * Every line contains the frames separated by semicolons followed by the number of cycles.
+         * @param os the stream to write to
+         */
+        void WriteFoldedStacks(std::ostream& os) const;
+
+    private:
+        struct StackNode {
+            std::uint32_t key;
+            std::size_t parent;
+            std::map<std::uint32_t, std::size_t> children;
+            std::uint64_t cycles;
+        };
+
+        void Enter(std::uint32_t key);
+        std::string GetFrameName(std::uint32_t key) const;
+
+        std::unordered_map<std::uint32_t, Counters> locations_;
+        std::array<Counters, OpcodeCount> opcodes_;
+        std::uint64_t total_cycles_;
+
+        std::vector<StackNode> stack_nodes_;
+        std::size_t current_node_;
+        std::size_t depth_;
+        std::size_t overflow_depth_; // Calls beyond the maximum depth that have no frame, their returns do not leave a frame
+    };
+} // namespace gandalf
+
+#endif
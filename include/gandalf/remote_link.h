@@ -0,0 +1,98 @@
+#ifndef __GANDALF_REMOTE_LINK_H
+#define __GANDALF_REMOTE_LINK_H
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "gameboy.h"
+#include "link_transport.h"
+
+namespace gandalf {
+    /**
+     * Connects the serial port of a Gameboy to a link partner in another process or thread, through a LinkTransport.
+     *
+     * Both sides run independently, at most max_lead cycles ahead of the last known time of the other side. Transfers that are clocked by
+     * this side do not wait for the reply of the partner: the received byte is predicted to be the same as the previous one, and a snapshot
+     * is taken just before the transfer completes. When the reply differs from the prediction, the emulator is rolled back to the snapshot
+     * and executed again with the correct byte. Transfers that are clocked by the partner are applied when this side reaches the time of
+     * the transfer, or immediately when this side is already past that time.
+     *
+     * Only one prediction is outstanding at a time, a second transfer waits until the first one is confirmed. Rolling back is only exact when
+     * a single side provides the clock, which is how link protocols normally operate.
+     */
+    class RemoteLink: public SerialEndpoint {
+    public:
+        struct Statistics {
+            std::uint64_t transfers_sent = 0;
+            std::uint64_t transfers_received = 0;
+            std::uint64_t mispredictions = 0;
+            std::uint64_t stalls = 0; ///< Number of times the emulation had to wait for the partner
+        };
+
+        /**
+         * @param gb the local Gameboy, which must outlive this object
+         * @param transport the transport to the link partner
+         * @param max_lead the maximum number of cycles this side may run ahead of the partner
+         */
+        RemoteLink(Gameboy& gb, std::unique_ptr<LinkTransport> transport, std::uint64_t max_lead = CyclesPerFrame);
+        ~RemoteLink();
+
+        RemoteLink(const RemoteLink&) = delete;
+        RemoteLink& operator=(const RemoteLink&) = delete;
+
+        /**
+         * Runs the local Gameboy for the given number of cycles, exchanging messages with the partner.
+         * @param cycles the number of cycles to run
+         * @returns False when the emulation was stopped early by a breakpoint or watchpoint, true otherwise
+         */
+        bool RunCycles(std::uint64_t cycles);
+
+        byte OnTransferCompleted(byte value) override;
+
+        const Statistics& GetStatistics() const { return statistics_; }
+
+    private:
+        struct IncomingTransfer {
+            std::uint64_t time;
+            byte value;
+            bool replay; ///< The transfer was applied before a rollback, it is applied again without sending a reply
+        };
+
+        std::uint64_t GetTime() const { return gb_.GetCycleCount() - start_cycles_; }
+        void ReceiveMessages(std::chrono::milliseconds timeout);
+        void HandleMessage(const LinkMessage& message);
+        void ApplyIncomingTransfers();
+        void TakeSnapshot();
+        void Rollback();
+        void SendSync();
+        void Send(LinkMessage::Type type, std::uint64_t time, byte value);
+
+        Gameboy& gb_;
+        std::unique_ptr<LinkTransport> transport_;
+        const std::uint64_t max_lead_;
+        const std::uint64_t start_cycles_;
+        std::uint64_t remote_time_;
+        std::uint64_t last_sync_time_;
+        std::deque<IncomingTransfer> incoming_transfers_;
+        Statistics statistics_;
+
+        // Speculation state
+        std::string snapshot_;
+        bool snapshot_valid_;
+        std::deque<IncomingTransfer> applied_since_snapshot_;
+        bool speculating_;
+        std::uint64_t speculation_time_;
+        byte prediction_;
+        bool rollback_pending_;
+        bool replaying_;
+        byte replay_value_;
+
+        // Non speculative transfer that is waiting for a reply
+        bool waiting_for_reply_;
+        std::uint64_t waiting_time_;
+        byte reply_;
+    };
+} // namespace gandalf
+
+#endif
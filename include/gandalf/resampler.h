@@ -0,0 +1,64 @@
+#ifndef __GANDALF_RESAMPLER_H
+#define __GANDALF_RESAMPLER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "apu.h"
+#include "constants.h"
+
+namespace gandalf {
+    /**
+     * Converts the output of the APU to an arbitrary sample rate with a windowed sinc polyphase filter, which avoids the drift and
+     * aliasing of taking every n-th sample. The APU is sampled at InputRate, every output sample is passed to Play() of the output
+     * handler; GetNextSampleTime() of the output handler is not used.
+     *
+     * Set the resampler with Gameboy::SetAudioHandler().
+     */
+    class Resampler: public APU::OutputHandler {
+    public:
+        static constexpr std::uint32_t InputDecimation = 32; ///< Number of APU ticks between input samples
+        static constexpr std::uint32_t InputRate = CPUFrequency / InputDecimation; ///< Input samples per second
+        static constexpr int Taps = 64; ///< Input samples per output sample
+        static constexpr int Phases = 512; ///< Number of fractional positions the filter is computed for
+
+        /**
+         * @param output the handler that receives the resampled output
+         * @param output_rate the number of output samples per second, for example 44100, 48000 or 32000
+         * @throws InvalidArgument when the output is null or the rate is 0 or larger than InputRate
+         */
+        Resampler(std::shared_ptr<APU::OutputHandler> output, std::uint32_t output_rate);
+        ~Resampler();
+
+        std::uint32_t GetNextSampleTime() override { return InputDecimation; }
+        void Play(float left, float right) override;
+
+        std::uint32_t GetOutputRate() const { return output_rate_; }
+
+        /**
+         * Adjusts the output rate without changing the filter, so that a front end can slave the audio to the display clock: a factor
+         * above 1 produces more samples per emulated second, for example when the audio device is about to run out of samples.
+         * @param factor the factor the output rate is multiplied with, between 0.5 and 2
+         * @throws InvalidArgument when the factor is out of range
+         */
+        void SetRateAdjustment(double factor);
+
+    private:
+        std::shared_ptr<APU::OutputHandler> output_;
+        const std::uint32_t output_rate_;
+
+        std::vector<float> coefficients_; // Phases + 1 rows of Taps coefficients, the last row is the first one shifted by a sample
+
+        // The last Taps input samples of each channel are stored twice, so that they can always be read as one contiguous block
+        std::vector<float> left_history_;
+        std::vector<float> right_history_;
+        int history_index_;
+
+        // Distance in input samples, as 32.32 fixed point, from the newest input sample to the next output sample and between outputs
+        std::int64_t time_until_output_;
+        std::uint64_t step_;
+    };
+} // namespace gandalf
+
+#endif
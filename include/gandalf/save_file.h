@@ -0,0 +1,98 @@
+#ifndef __GANDALF_SAVE_FILE_H
+#define __GANDALF_SAVE_FILE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cartridge.h"
+#include "ppu.h"
+
+namespace gandalf {
+    /**
+     * Keeps the battery-backed RAM of a cartridge in a .sav file, which contains the RAM banks in order followed by the footer of the
+     * MBC, for example the real-time clock. The RAM banks that were written are copied at VBlank, once per flush interval, and written
+     * on a dedicated writer thread, so the emulation never waits for the file. Every write replaces the file with a complete image
+     * through a temporary file, so a crash keeps the last image that was written and loses the changes after it. The footer is updated
+     * with every write, but the passing of time alone only updates it on Flush() and Close(); the time since the footer was written is
+     * recomputed from its timestamp when the save is loaded.
+     *
+     * Register the save file with Gameboy::AddVBlankListener() after loading the ROM; it must be closed before another ROM is loaded.
+     * Loading a save state of the same ROM is supported, the RAM of the state is written with the next flush.
+     */
+    class SaveFile: public PPU::VBlankListener {
+    public:
+        /**
+         * Loads the file into the RAM of the cartridge, or creates it from the current RAM when it does not exist, and starts the writer
+         * thread.
+         * @param cartridge the loaded cartridge, which must outlive the save file
+         * @param path the path of the save file
+         * @param flush_interval the number of frames between checks for written RAM banks
+         * @throws InvalidArgument when the cartridge has no battery or the interval is 0
+         * @throws Exception when the file is smaller than the RAM, or cannot be read or created. An existing file is never replaced
+         *         when it could not be loaded.
+         */
+        SaveFile(Cartridge& cartridge, const std::string& path, unsigned int flush_interval = 60);
+
+        /// Writes the remaining changes and stops the writer thread, errors are ignored.
+        ~SaveFile();
+
+        SaveFile(const SaveFile&) = delete;
+        SaveFile& operator=(const SaveFile&) = delete;
+
+        /// Queues the written RAM banks once per flush interval. Does not throw, a cartridge that no longer matches is reported by Flush().
+        void OnVBlank() override;
+
+        /**
+         * Queues the RAM banks that were written since the last check and the current footer, and waits until they are in the file. Must
+         * be called from the thread that runs the emulation, for example before exiting.
+         * @throws Exception when writing to the file failed, or the cartridge no longer has the RAM of the file
+         */
+        void Flush();
+
+        /**
+         * Writes the remaining changes and stops the writer thread. Changes after this call are not saved.
+         * @throws Exception when writing to the file failed, or the cartridge no longer has the RAM of the file
+         */
+        void Close();
+
+        /// @returns The number of RAM banks that were written to the file.
+        std::uint64_t GetWrittenBanks() const { return written_banks_.load(std::memory_order_relaxed); }
+
+    private:
+        /// @returns The MBC of the cartridge, which changes when a state is loaded, or nullptr when its RAM does not match the file.
+        MBC* FindMBC();
+        /// @param write_footer whether the footer is written when it changed while no bank was written
+        void QueueDirtyBanks(bool write_footer);
+        void Run();
+
+        Cartridge& cartridge_;
+        const std::string path_;
+        const unsigned int flush_interval_;
+        unsigned int frames_until_flush_;
+
+        std::string footer_; // The last footer that was queued
+        std::vector<MBC::RAMBank> image_; // The banks in the file, only used by the writer thread after the constructor
+        bool mismatch_; // Whether the RAM of the cartridge stopped matching the file, nothing is queued after that
+
+        std::vector<MBC::RAMBank> pending_; // Copies of the banks that wait to be written, indexed by bank
+        std::uint32_t pending_banks_;
+        std::string pending_footer_;
+        bool footer_pending_;
+        std::uint64_t queued_generation_; // Incremented whenever banks are queued
+        std::uint64_t written_generation_; // The last generation of which all banks were written
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool closing_;
+        bool failed_;
+        std::atomic<std::uint64_t> written_banks_;
+
+        std::thread writer_;
+    };
+} // namespace gandalf
+
+#endif
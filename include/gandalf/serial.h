@@ -6,9 +6,33 @@
 #include "serialization.h"
 
 namespace gandalf {
+    /**
+     * The other side of a serial connection that exchanges whole bytes, used to connect a Gameboy to a link partner that is not
+     * in the same process. The bits that are shifted in during a transfer read as 1, the received byte is stored in SB when the transfer completes.
+     */
+    class SerialEndpoint {
+    public:
+        virtual ~SerialEndpoint() = default;
+
+        /**
+         * Called when a transfer that is clocked by this Gameboy completes.
+         * @param value the byte that was sent
+         * @returns The byte that was received
+         */
+        virtual byte OnTransferCompleted(byte value) = 0;
+    };
+
     class Serial: public Memory::AddressHandler, public Serializable {
     public:
-        Serial(GameboyMode mode);
+        class TransferListener {
+        public:
+            virtual ~TransferListener() = default;
+
+            /// Called when a transfer with the internal clock is started.
+            virtual void OnTransferStarted() = 0;
+        };
+
+        Serial(GameboyMode mode, Memory& memory);
         virtual ~Serial();
 
         void Tick();
@@ -24,14 +48,62 @@ namespace gandalf {
 
         void SetMode(GameboyMode mode) { mode_ = mode; }
 
+        /**
+         * Connects this serial port to the serial port of another Gameboy. The connection is one way, the peer should also be connected to this port.
+         * @param peer the serial port on the other side of the link cable, or nullptr to disconnect
+         */
+        void SetPeer(Serial* peer) { peer_ = peer; }
+
+        /**
+         * Connects this serial port to a byte based endpoint. The endpoint is only used when no peer is set.
+         * @param endpoint the endpoint, or nullptr to disconnect
+         */
+        void SetEndpoint(SerialEndpoint* endpoint) { endpoint_ = endpoint; }
+
+        /// @param listener the listener that is notified when a transfer with the internal clock is started, or nullptr
+        void SetTransferListener(TransferListener* listener) { transfer_listener_ = listener; }
+
+        /**
+         * Shifts a bit in from the peer that provides the clock.
+         * @param bit the bit that is shifted out by the peer
+         * @returns The bit that is shifted out of this port, 1 when this port is not waiting for an externally clocked transfer
+         */
+        byte ShiftExternal(byte bit);
+
+        /**
+         * Completes an externally clocked transfer at once, for a peer that exchanges whole bytes.
+         * @param value the byte that is received
+         * @returns The byte that was sent, 0xFF when this port is not waiting for an externally clocked transfer
+         */
+        byte TransferExternal(byte value);
+
+        /// @returns The number of cycles until the next bit is shifted by the internal clock, or 0 when no internally clocked transfer is in progress.
+        unsigned int GetCyclesUntilShift() const;
+
+        /// @returns The number of cycles until the internally clocked transfer completes, or 0 when no internally clocked transfer is in progress.
+        unsigned int GetCyclesUntilTransferComplete() const;
+
+        /// @returns The number of cycles it takes at least to shift a bit with the internal clock in the current mode.
+        unsigned int GetMinimumBitCycles() const;
+
         void Serialize(std::ostream& os) const override;
         void Deserialize(std::istream& is, std::uint16_t version) override;
 
     private:
+        void ShiftBit(byte bit);
+        void CompleteTransfer();
+
         byte sb_;
         byte sc_;
         GameboyMode mode_;
+        Memory& memory_;
+        Serial* peer_;
+        SerialEndpoint* endpoint_;
+        TransferListener* transfer_listener_;
+        byte transfer_byte_;
+        byte bit_count_;
+        word cycle_counter_;
     };
 } // namespace gandalf
 
-#endif
\ No newline at end of file
+#endif
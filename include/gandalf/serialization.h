@@ -33,6 +33,22 @@ namespace gandalf
 
     namespace serialization
     {
+        /**
+         * Whether a sequence of T is stored in memory in the format of the serialization, so that it can be written and read in one call.
+         * Integers are serialized in little-endian byte order.
+         */
+        template <typename T>
+        inline bool IsStoredAsSerialized()
+        {
+            if constexpr (!std::is_integral<T>::value || std::is_same<T, bool>::value)
+                return false;
+            else
+            {
+                const std::uint16_t one = 1;
+                return sizeof(T) == 1 || *reinterpret_cast<const unsigned char*>(&one) == 1;
+            }
+        }
+
         template <typename T>
         inline void Serialize(std::ostream& os, T value)
         {
@@ -59,6 +75,13 @@ namespace gandalf
         template <typename T, std::size_t N>
         inline void Serialize(std::ostream& os, const std::array<T, N>& values)
         {
+            if (IsStoredAsSerialized<T>())
+            {
+                if (!os.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(N * sizeof(T))))
+                    throw SerializationException("Failed to serialize");
+                return;
+            }
+
             for (const auto& value : values)
                 Serialize(os, value);
         }
@@ -67,6 +90,13 @@ namespace gandalf
         inline void Serialize(std::ostream& os, const std::vector<T>& values)
         {
             Serialize(os, values.size());
+            if (IsStoredAsSerialized<T>())
+            {
+                if (!os.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T))))
+                    throw SerializationException("Failed to serialize");
+                return;
+            }
+
             for (const auto& value : values)
                 Serialize(os, value);
         }
@@ -118,6 +148,13 @@ namespace gandalf
         template <typename T, std::size_t N>
         inline void Deserialize(std::istream& is, std::array<T, N>& values, std::uint16_t version = 0)
         {
+            if (IsStoredAsSerialized<T>())
+            {
+                if (!is.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(N * sizeof(T))))
+                    throw SerializationException("Failed to deserialize");
+                return;
+            }
+
             for (auto& value : values)
                 Deserialize(is, value, version);
         }
@@ -128,6 +165,13 @@ namespace gandalf
             std::size_t size;
             Deserialize(is, size);
             values.resize(size);
+            if (IsStoredAsSerialized<T>())
+            {
+                if (!is.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(size * sizeof(T))))
+                    throw SerializationException("Failed to deserialize");
+                return;
+            }
+
             for (auto& value : values)
                 Deserialize(is, value, version);
         }
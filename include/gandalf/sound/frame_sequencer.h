@@ -34,7 +34,15 @@ namespace gandalf
 
         void Tick();
 
+        /**
+         * Advances the frame sequencer by multiple ticks at once. This is equivalent to calling Tick() the given amount of times.
+         * @param ticks the number of ticks to advance
+         */
+        void Advance(std::uint64_t ticks);
+
     private:
+        void Step();
+
         int counter_;
         byte current_step_;
 
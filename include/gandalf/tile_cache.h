@@ -0,0 +1,67 @@
+#ifndef __GANDALF_TILE_CACHE_H
+#define __GANDALF_TILE_CACHE_H
+
+#include <array>
+
+#include "types.h"
+
+namespace gandalf {
+    /**
+     * Cache of the tiles in VRAM, decoded to one color index (0-3) per pixel. A tile is decoded when it is requested after it was
+     * invalidated, the PPU invalidates tiles when the tile data in VRAM is written.
+     *
+     * Decoding happens on access, so the cache must only be used from the thread that runs the emulation.
+     */
+    class TileCache {
+    public:
+        static constexpr int TilesPerBank = 384;
+        static constexpr int BankCount = 2;
+        static constexpr word TileDataSize = TilesPerBank * 16; ///< Size of the tile data region at the start of a VRAM bank
+
+        using VRAMBank = std::array<byte, 0x2000>;
+        using VRAM = std::array<VRAMBank, BankCount>;
+        using Tile = std::array<byte, 64>; ///< Color indices of the 8x8 pixels, row by row
+
+        /// @param vram the VRAM, which must outlive the cache
+        explicit TileCache(const VRAM& vram);
+
+        /**
+         * Invalidates the tile that contains the given VRAM byte.
+         * @param bank the VRAM bank
+         * @param offset the offset of the byte from the start of VRAM (0x8000)
+         */
+        void Invalidate(int bank, word offset)
+        {
+            if (offset < TileDataSize)
+                valid_[bank * TilesPerBank + offset / 16] = false;
+        }
+
+        void InvalidateAll();
+
+        /**
+         * @param bank the VRAM bank (0-1)
+         * @param index the index of the tile in the bank (0-383), tile 0 starts at 0x8000
+         * @param flip_x whether the tile is flipped horizontally
+         * @returns The decoded tile
+         */
+        const Tile& GetTile(int bank, int index, bool flip_x) const;
+
+        /**
+         * Decodes one line of a tile.
+         * @param low the byte with the low bits of the color indices
+         * @param high the byte with the high bits of the color indices
+         * @param flip_x whether the line is flipped horizontally
+         * @param output the 8 color indices, from left to right
+         */
+        static void DecodeLine(byte low, byte high, bool flip_x, byte* output);
+
+    private:
+        void Decode(int slot) const;
+
+        const VRAM& vram_;
+        mutable std::array<std::array<Tile, 2>, BankCount* TilesPerBank> tiles_; // The normal and the horizontally flipped tile
+        mutable std::array<bool, BankCount* TilesPerBank> valid_;
+    };
+} // namespace gandalf
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef __GANDALF_TRACE_BUFFER_H
+#define __GANDALF_TRACE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "types.h"
+
+namespace gandalf {
+    /// The CPU state at the start of an instruction.
+    struct TraceRecord {
+        std::uint64_t cycle;
+        word program_counter;
+        word bank;
+        word af;
+        word bc;
+        word de;
+        word hl;
+        word stack_pointer;
+        byte opcode;
+        byte operand; ///< The byte following the opcode, which is the opcode of CB prefixed instructions
+    };
+
+    /**
+     * Ring buffer that keeps the most recent instructions executed by the CPU, for post-mortem analysis.
+     * The records are written by the emulation thread without locking or allocating; the buffer can be read from another thread,
+     * in which case records that were overwritten while reading are discarded.
+     */
+    class TraceBuffer {
+    public:
+        /// Size in bytes of a record in the binary format.
+        static constexpr std::size_t RecordSize = 24;
+
+        /**
+         * @param capacity the number of instructions that are kept, rounded up to one less than a power of two
+         */
+        explicit TraceBuffer(std::size_t capacity);
+        ~TraceBuffer();
+
+        void Push(const TraceRecord& record)
+        {
+            const std::uint64_t index = write_index_.load(std::memory_order_relaxed);
+            records_[index & mask_] = record;
+            write_index_.store(index + 1, std::memory_order_release);
+        }
+
+        /// Removes all records.
+        void Clear();
+
+        std::size_t GetCapacity() const { return records_.size() - 1; }
+
+        /// @returns The total number of records that were pushed, including the ones that were overwritten.
+        std::uint64_t GetTotalCount() const { return write_index_.load(std::memory_order_acquire); }
+
+        /// @returns The records that are currently in the buffer, from oldest to newest.
+        std::vector<TraceRecord> GetRecords() const;
+
+        /**
+         * Writes the records that are currently in the buffer in the binary trace format.
+         * The format consists of the magic "GBTR", the format version (16 bits), the record size (16 bits) and the number of records (32 bits),
+         * followed by the records. All values are stored in little endian.
+         * @param os the stream to write to
+         */
+        void Write(std::ostream& os) const;
+
+        /**
+         * Reads records that were written with Write().
+         * @param is the stream to read from
+         * @returns The records from oldest to newest
+         * @throws SerializationException when the stream does not contain a valid trace
+         */
+        static std::vector<TraceRecord> Read(std::istream& is);
+
+        /**
+         * Writes a record as a single line of text.
+         * @param os the stream to write to
+         * @param record the record to write
+         */
+        static void WriteText(std::ostream& os, const TraceRecord& record);
+
+    private:
+        std::vector<TraceRecord> records_;
+        std::size_t mask_;
+        std::atomic<std::uint64_t> write_index_;
+    };
+} // namespace gandalf
+
+#endif
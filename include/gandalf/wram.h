@@ -14,6 +14,7 @@ namespace gandalf {
         byte Read(word address) const override;
         void Write(word address, byte value) override;
         std::set<word> GetAddresses() const override;
+        word GetBank(word address) const override;
 
         void SetMode(GameboyMode mode) { mode_ = mode; }
 
@@ -12,7 +12,34 @@
 
 namespace gandalf
 {
+    struct APU::Channels
+    {
+        Channels(FrameSequencer& frame_sequencer, const std::array<byte, 0x20>& wave_ram): ch1(frame_sequencer, true), ch2(frame_sequencer, false),
+            ch3(frame_sequencer, wave_ram), ch4(frame_sequencer)
+        {
+        }
+
+        /// Calls the function with the channel as its concrete type.
+        template <typename Self, typename Function>
+        static decltype(auto) Visit(Self& self, int channel, Function&& function)
+        {
+            switch (channel)
+            {
+            case 0: return function(self.ch1);
+            case 1: return function(self.ch2);
+            case 2: return function(self.ch3);
+            default: return function(self.ch4);
+            }
+        }
+
+        SquareWaveChannel ch1;
+        SquareWaveChannel ch2;
+        WaveChannel ch3;
+        NoiseChannel ch4;
+    };
+
     APU::APU(): Memory::AddressHandler("APU"),
+        pending_ticks_(0),
         ticks_until_sample_(0),
         vin_left_(false),
         vin_right_(false),
@@ -31,16 +58,15 @@ namespace gandalf
 
         //todo dac
 
-        sound_channels_[0] = std::make_unique<SquareWaveChannel>(frame_sequencer_, true);
-        sound_channels_[1] = std::make_unique<SquareWaveChannel>(frame_sequencer_, false);
-        sound_channels_[2] = std::make_unique<WaveChannel>(frame_sequencer_, wave_ram_);
-        sound_channels_[3] = std::make_unique<NoiseChannel>(frame_sequencer_);
+        channels_ = std::make_unique<Channels>(frame_sequencer_, wave_ram_);
     }
 
     APU::~APU() = default;
 
     void APU::SetAudioHandler(std::shared_ptr<OutputHandler> audio_handler)
     {
+        CatchUp();
+
         output_handler_ = audio_handler;
         if (audio_handler)
             ticks_until_sample_ = audio_handler->GetNextSampleTime();
@@ -50,11 +76,14 @@ namespace gandalf
     {
         assert(BETWEEN(address, 0xFF10, 0xFF27) || BETWEEN(address, 0xFF30, 0xFF40));
 
+        if (address <= address::NR52)
+            CatchUp();
+
         if (address <= address::NR44)
         {
             const int channel = (address - address::NR10) / 5;
             const int reg = (address - address::NR10) % 5;
-            sound_channels_[channel]->SetRegister(reg, value);
+            Channels::Visit(*channels_, channel, [reg, value](auto& sound_channel) { sound_channel.SetRegister(reg, value); });
         }
         else if (address == address::NR50)
         {
@@ -83,11 +112,15 @@ namespace gandalf
     byte APU::Read(word address) const
     {
         assert(BETWEEN(address, 0xFF10, 0xFF27) || BETWEEN(address, 0xFF30, 0xFF40));
+
+        if (address <= address::NR52)
+            CatchUp();
+
         if (address <= address::NR44)
         {
             const int channel = (address - address::NR10) / 5;
             const int reg = (address - address::NR10) % 5;
-            return sound_channels_[channel]->GetRegister(reg);
+            return Channels::Visit(*channels_, channel, [reg](const auto& sound_channel) { return sound_channel.GetRegister(reg); });
         }
         else if (address == address::NR50)
         {
@@ -115,7 +148,7 @@ namespace gandalf
                 result |= 0x80; // Bit 7 - Sound on/off
 
             for (int i = 0; i < 4; ++i) {
-                if (sound_channels_[i]->GetEnabled())
+                if (Channels::Visit(*channels_, i, [](const auto& sound_channel) { return sound_channel.GetEnabled(); }))
                     result |= (1 << i);
             }
 
@@ -145,8 +178,12 @@ namespace gandalf
 
     void APU::Serialize(std::ostream& os) const
     {
-        for (const auto& channel : sound_channels_)
-            channel->Serialize(os);
+        CatchUp();
+
+        channels_->ch1.Serialize(os);
+        channels_->ch2.Serialize(os);
+        channels_->ch3.Serialize(os);
+        channels_->ch4.Serialize(os);
 
         frame_sequencer_.Serialize(os);
         serialization::Serialize(os, samples_);
@@ -164,8 +201,10 @@ namespace gandalf
 
     void APU::Deserialize(std::istream& is, std::uint16_t version)
     {
-        for (auto& channel : sound_channels_)
-            channel->Deserialize(is, version);
+        channels_->ch1.Deserialize(is, version);
+        channels_->ch2.Deserialize(is, version);
+        channels_->ch3.Deserialize(is, version);
+        channels_->ch4.Deserialize(is, version);
 
         frame_sequencer_.Deserialize(is, version);
         serialization::Deserialize(is, samples_);
@@ -178,19 +217,35 @@ namespace gandalf
         serialization::Deserialize(is, channel_left_enabled_);
         serialization::Deserialize(is, channel_right_enabled_);
         serialization::Deserialize(is, sound_enabled_);
+        pending_ticks_ = 0;
     }
 
-    void APU::Tick()
+    void APU::CatchUp() const
     {
-        frame_sequencer_.Tick();
+        if (pending_ticks_ == 0)
+            return;
 
-        for (int i = 0; i < 4; ++i) {
-            samples_[i] = sound_channels_[i]->Tick();
-            assert(samples_[i] <= 15);
-        }
+        // The waveform generators are not observable by the game, so only the frame sequencer (and the units it clocks) needs to catch up.
+        frame_sequencer_.Advance(pending_ticks_);
+        pending_ticks_ = 0;
+    }
 
+    void APU::Tick()
+    {
         if (!output_handler_)
+        {
+            ++pending_ticks_;
             return;
+        }
+
+        frame_sequencer_.Tick();
+
+        samples_[0] = channels_->ch1.Tick();
+        samples_[1] = channels_->ch2.Tick();
+        samples_[2] = channels_->ch3.Tick();
+        samples_[3] = channels_->ch4.Tick();
+        for (int i = 0; i < 4; ++i)
+            assert(samples_[i] <= 15);
 
         --ticks_until_sample_;
         if (ticks_until_sample_ > 0)
@@ -0,0 +1,121 @@
+#include <gandalf/audio_ring_buffer.h>
+
+#include <algorithm>
+
+#include <gandalf/constants.h>
+#include <gandalf/exception.h>
+
+namespace {
+    std::size_t RoundUpToPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+}
+
+namespace gandalf {
+    AudioRingBuffer::AudioRingBuffer(std::size_t capacity, std::uint32_t sample_rate):
+        capacity_(RoundUpToPowerOfTwo(capacity)),
+        mask_(capacity_ - 1),
+        sample_rate_(sample_rate),
+        cycle_remainder_(0),
+        write_index_(0),
+        overruns_(0),
+        read_index_(0),
+        underruns_(0),
+        blocking_(false),
+        writer_waiting_(false)
+    {
+        if (capacity == 0)
+            throw InvalidArgument("Audio buffer capacity must be larger than 0");
+        if (sample_rate == 0 || sample_rate > static_cast<std::uint32_t>(CPUFrequency))
+            throw InvalidArgument("Sample rate must be between 1 and the APU clock frequency");
+
+        samples_.resize(capacity_ * 2, 0.0f);
+    }
+
+    AudioRingBuffer::~AudioRingBuffer() = default;
+
+    std::uint32_t AudioRingBuffer::GetNextSampleTime()
+    {
+        const std::uint32_t cycles = cycle_remainder_ + CPUFrequency;
+        cycle_remainder_ = cycles % sample_rate_;
+        return cycles / sample_rate_;
+    }
+
+    void AudioRingBuffer::Play(float left, float right)
+    {
+        const std::uint64_t write_index = write_index_.load(std::memory_order_relaxed);
+        if (write_index - read_index_.load(std::memory_order_acquire) >= capacity_)
+        {
+            if (!blocking_.load(std::memory_order_relaxed))
+            {
+                overruns_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // The reader checks writer_waiting_ after it advances its index, the sequentially consistent operations on both sides make
+            // sure that either the predicate sees the new index or the reader sees that it has to notify.
+            std::unique_lock<std::mutex> lock(mutex_);
+            writer_waiting_.store(true);
+            condition_.wait(lock, [this, write_index]() { return write_index - read_index_.load() < capacity_ || !blocking_.load(); });
+            writer_waiting_.store(false);
+
+            if (write_index - read_index_.load(std::memory_order_acquire) >= capacity_)
+            {
+                overruns_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        const std::size_t position = static_cast<std::size_t>(write_index & mask_) * 2;
+        samples_[position] = left;
+        samples_[position + 1] = right;
+        write_index_.store(write_index + 1, std::memory_order_release);
+    }
+
+    std::size_t AudioRingBuffer::Read(float* output, std::size_t count)
+    {
+        const std::uint64_t read_index = read_index_.load(std::memory_order_relaxed);
+        const std::size_t available = static_cast<std::size_t>(std::min<std::uint64_t>(write_index_.load(std::memory_order_acquire) - read_index, count));
+
+        // Copy in at most two parts, the second one starts at the beginning of the buffer
+        const std::size_t start = static_cast<std::size_t>(read_index & mask_);
+        const std::size_t first = std::min(available, capacity_ - start);
+        std::copy_n(samples_.begin() + start * 2, first * 2, output);
+        std::copy_n(samples_.begin(), (available - first) * 2, output + first * 2);
+        std::fill(output + available * 2, output + count * 2, 0.0f);
+
+        if (available < count)
+            underruns_.fetch_add(count - available, std::memory_order_relaxed);
+
+        if (available > 0)
+        {
+            read_index_.store(read_index + available);
+            if (writer_waiting_.load())
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                condition_.notify_one();
+            }
+        }
+        return available;
+    }
+
+    void AudioRingBuffer::SetBlocking(bool blocking)
+    {
+        blocking_.store(blocking);
+        if (!blocking)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            condition_.notify_all();
+        }
+    }
+
+    std::size_t AudioRingBuffer::GetAvailable() const
+    {
+        const std::uint64_t read_index = read_index_.load(std::memory_order_acquire);
+        return static_cast<std::size_t>(write_index_.load(std::memory_order_acquire) - read_index);
+    }
+} // namespace gandalf
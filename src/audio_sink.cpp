@@ -0,0 +1,219 @@
+#include <gandalf/audio_sink.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include <gandalf/constants.h>
+#include <gandalf/exception.h>
+#include <gandalf/serialization.h>
+
+namespace {
+    constexpr std::uint16_t kChannels = 2;
+    constexpr std::uint16_t kBitsPerSample = 16;
+    constexpr std::uint32_t kUnknownSize = std::numeric_limits<std::uint32_t>::max();
+
+    // The emulation thread does not lock the mutex when it notifies, so a notification can be missed; the timeout bounds the delay
+    constexpr std::chrono::milliseconds kPollInterval(10);
+
+    inline std::int16_t ToPCM(float value)
+    {
+        return static_cast<std::int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+}
+
+namespace gandalf {
+    AudioSink::AudioSink(std::ostream& os, Format format, std::uint32_t sample_rate, std::size_t block_size, std::size_t block_count):
+        os_(os),
+        format_(format),
+        sample_rate_(sample_rate),
+        block_size_(block_size),
+        write_index_(0),
+        read_index_(0),
+        fill_(0),
+        cycle_remainder_(0),
+        closing_(false),
+        written_samples_(0),
+        dropped_samples_(0),
+        failed_(false),
+        header_position_(-1)
+    {
+        if (sample_rate == 0 || sample_rate > static_cast<std::uint32_t>(CPUFrequency))
+            throw InvalidArgument("Sample rate must be between 1 and the APU clock frequency");
+        if (block_size == 0 || block_count == 0)
+            throw InvalidArgument("Block size and block count must be larger than 0");
+
+        blocks_.resize(block_count, std::vector<std::int16_t>(block_size * kChannels));
+        block_lengths_.resize(block_count, 0);
+
+        writer_ = std::thread(&AudioSink::Run, this);
+    }
+
+    AudioSink::~AudioSink()
+    {
+        try
+        {
+            Close();
+        }
+        catch (const Exception&)
+        {
+        }
+    }
+
+    std::uint32_t AudioSink::GetNextSampleTime()
+    {
+        // Spread the remainder of the division over the samples, so that exactly sample_rate_ samples are taken per second
+        const std::uint32_t cycles = cycle_remainder_ + CPUFrequency;
+        cycle_remainder_ = cycles % sample_rate_;
+        return cycles / sample_rate_;
+    }
+
+    void AudioSink::Play(float left, float right)
+    {
+        if (closing_.load(std::memory_order_relaxed))
+        {
+            dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const std::uint64_t write_index = write_index_.load(std::memory_order_relaxed);
+        if (fill_ == 0 && write_index - read_index_.load(std::memory_order_acquire) >= blocks_.size())
+        {
+            dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const std::size_t slot = static_cast<std::size_t>(write_index % blocks_.size());
+        std::vector<std::int16_t>& block = blocks_[slot];
+        block[fill_++] = ToPCM(left);
+        block[fill_++] = ToPCM(right);
+        if (fill_ < block.size())
+            return;
+
+        block_lengths_[slot] = fill_;
+        fill_ = 0;
+        write_index_.store(write_index + 1, std::memory_order_release);
+        condition_.notify_one();
+    }
+
+    void AudioSink::Close()
+    {
+        if (!closing_.load(std::memory_order_relaxed))
+        {
+            // The slot of a partially filled block was reserved when its first sample was played
+            if (fill_ > 0)
+            {
+                const std::uint64_t write_index = write_index_.load(std::memory_order_relaxed);
+                block_lengths_[static_cast<std::size_t>(write_index % blocks_.size())] = fill_;
+                fill_ = 0;
+                write_index_.store(write_index + 1, std::memory_order_release);
+            }
+            closing_.store(true, std::memory_order_release);
+            condition_.notify_one();
+        }
+
+        if (writer_.joinable())
+            writer_.join();
+
+        if (failed_)
+            throw Exception("Failed to write audio samples");
+    }
+
+    void AudioSink::Run()
+    {
+        try
+        {
+            if (format_ == Format::WAV)
+            {
+                header_position_ = os_.tellp();
+                WriteWAVHeader(kUnknownSize);
+            }
+        }
+        catch (const SerializationException&)
+        {
+            failed_ = true;
+        }
+
+        while (true)
+        {
+            // Blocks that are committed before closing_ is set are written by the last call
+            const bool closing = closing_.load(std::memory_order_acquire);
+            WriteBlocks();
+            if (closing)
+                break;
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait_for(lock, kPollInterval, [this]() {
+                return closing_.load(std::memory_order_acquire) || read_index_.load(std::memory_order_relaxed) != write_index_.load(std::memory_order_acquire);
+                });
+        }
+
+        try
+        {
+            if (format_ == Format::WAV && header_position_ != std::streampos(-1) && !failed_)
+            {
+                const std::uint64_t data_size = GetWrittenSamples() * kChannels * (kBitsPerSample / 8);
+                const std::streampos end = os_.tellp();
+                os_.seekp(header_position_);
+                WriteWAVHeader(static_cast<std::uint32_t>(std::min<std::uint64_t>(data_size, kUnknownSize - 36)));
+                os_.seekp(end);
+            }
+        }
+        catch (const SerializationException&)
+        {
+            failed_ = true;
+        }
+
+        os_.flush();
+        if (!os_)
+            failed_ = true;
+    }
+
+    void AudioSink::WriteBlocks()
+    {
+        std::uint64_t read_index = read_index_.load(std::memory_order_relaxed);
+        while (read_index != write_index_.load(std::memory_order_acquire))
+        {
+            const std::size_t slot = static_cast<std::size_t>(read_index % blocks_.size());
+            const std::vector<std::int16_t>& block = blocks_[slot];
+            const std::size_t length = block_lengths_[slot];
+
+            // After a failure the blocks are still consumed, so that the emulation thread does not count them as dropped
+            if (!failed_)
+            {
+                encoded_.resize(length * 2);
+                for (std::size_t i = 0; i < length; ++i)
+                {
+                    const auto value = static_cast<std::uint16_t>(block[i]);
+                    encoded_[2 * i] = static_cast<char>(value & 0xFF);
+                    encoded_[2 * i + 1] = static_cast<char>(value >> 8);
+                }
+                os_.write(encoded_.data(), static_cast<std::streamsize>(encoded_.size()));
+                if (os_)
+                    written_samples_.fetch_add(length / kChannels, std::memory_order_relaxed);
+                else
+                    failed_ = true;
+            }
+
+            read_index_.store(++read_index, std::memory_order_release);
+        }
+    }
+
+    void AudioSink::WriteWAVHeader(std::uint32_t data_size)
+    {
+        const std::uint16_t block_align = kChannels * (kBitsPerSample / 8);
+        os_.write("RIFF", 4);
+        serialization::Serialize(os_, data_size == kUnknownSize ? kUnknownSize : 36 + data_size);
+        os_.write("WAVEfmt ", 8);
+        serialization::Serialize(os_, std::uint32_t(16));
+        serialization::Serialize(os_, std::uint16_t(1)); // PCM
+        serialization::Serialize(os_, kChannels);
+        serialization::Serialize(os_, sample_rate_);
+        serialization::Serialize(os_, sample_rate_ * block_align);
+        serialization::Serialize(os_, block_align);
+        serialization::Serialize(os_, kBitsPerSample);
+        os_.write("data", 4);
+        serialization::Serialize(os_, data_size);
+    }
+} // namespace gandalf
@@ -7,6 +7,8 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <variant>
 
 #include "cartridge/mbc1.h"
 #include "cartridge/mbc3.h"
@@ -399,6 +401,15 @@ namespace gandalf {
         serialization::Serialize(os, global_checksum);
     }
 
+    bool Cartridge::Header::operator==(const Header& other) const
+    {
+        return logo == other.logo && title == other.title && manufacturer_code == other.manufacturer_code && cgb_flag == other.cgb_flag
+            && new_licensee_code == other.new_licensee_code && sgb_flag == other.sgb_flag && cartridge_type == other.cartridge_type
+            && rom_size == other.rom_size && ram_size == other.ram_size && destination_code == other.destination_code
+            && old_licensee_code == other.old_licensee_code && mask_rom_version == other.mask_rom_version
+            && header_checksum == other.header_checksum && global_checksum == other.global_checksum;
+    }
+
     void Cartridge::Header::Deserialize(std::istream& is, std::uint16_t)
     {
         serialization::Deserialize(is, logo);
@@ -417,13 +428,27 @@ namespace gandalf {
         serialization::Deserialize(is, global_checksum);
     }
 
-    Cartridge::Cartridge(): Memory::AddressHandler("Cartridge"), header_() {}
+    struct Cartridge::Mapper
+    {
+        template <typename T, typename... Args>
+        Mapper(std::in_place_type_t<T> type, Args&&... args): mbc(type, std::forward<Args>(args)...) {}
+
+        std::variant<ROMOnly, MBC1, MBC3, MBC5> mbc;
+    };
+
+    Cartridge::Cartridge(): Memory::AddressHandler("Cartridge"), header_(), rtc_clock_(nullptr) {}
 
     Cartridge::~Cartridge() = default;
 
-    static std::unique_ptr<MBC> CreateMBC(const ROM& bytes, const Cartridge::Header& header)
+    static std::size_t GetROMBankCount(const Cartridge::Header& header)
     {
-        std::size_t rom_banks = std::size_t(1) << (header.rom_size + 1);
+        // Larger values are not valid, they are rejected as an unsupported number of banks
+        return header.rom_size <= 8 ? std::size_t(1) << (header.rom_size + 1) : 0;
+    }
+
+    std::unique_ptr<Cartridge::Mapper> Cartridge::CreateMBC(const MBC::SharedROM& rom, const Cartridge::Header& header)
+    {
+        std::size_t rom_banks = GetROMBankCount(header);
         std::size_t ram_banks = std::size_t(0) << (header.ram_size + 1);
 
         if (kCartridgeBankProperties.find(header.cartridge_type) == kCartridgeBankProperties.end()) {
@@ -443,14 +468,11 @@ namespace gandalf {
             return {};
         }
 
-        const std::size_t expected_file_size = rom_banks * ROMBankSize;
-        if (bytes.size() < expected_file_size)
+        if (rom->size() < rom_banks)
         {
             std::cerr << "The file is too small to contain " << rom_banks << " banks of ROM" << std::endl;
             return {};
         }
-        else if (bytes.size() > expected_file_size)
-            std::cout << "Warning: the file contains more data than expected" << std::endl;
 
         switch (header.ram_size) {
         case 0x02: ram_banks = 1; break;
@@ -461,23 +483,23 @@ namespace gandalf {
 
         switch (header.cartridge_type)
         {
-        case 0x00: return std::make_unique<ROMOnly>(bytes, 0); break;
-        case 0x01: return std::make_unique<MBC1>(bytes, rom_banks, 0, false); break;
-        case 0x02: return std::make_unique<MBC1>(bytes, rom_banks, ram_banks, false); break;
-        case 0x03: return std::make_unique<MBC1>(bytes, rom_banks, ram_banks, true); break;
+        case 0x00: return std::make_unique<Mapper>(std::in_place_type<ROMOnly>, rom, 0); break;
+        case 0x01: return std::make_unique<Mapper>(std::in_place_type<MBC1>, rom, rom_banks, 0, false); break;
+        case 0x02: return std::make_unique<Mapper>(std::in_place_type<MBC1>, rom, rom_banks, ram_banks, false); break;
+        case 0x03: return std::make_unique<Mapper>(std::in_place_type<MBC1>, rom, rom_banks, ram_banks, true); break;
             //case 0x04: return std::unique_ptr<MBC2>(new MBC2(bytes, rom_banks, ram_banks)); break;
-        case 0x08: return std::make_unique<ROMOnly>(bytes, ram_banks); break;
+        case 0x08: return std::make_unique<Mapper>(std::in_place_type<ROMOnly>, rom, ram_banks); break;
         case 0x0F:
-        case 0x10: return std::make_unique<MBC3>(bytes, rom_banks, ram_banks, true, true); break;
-        case 0x11: return std::make_unique<MBC3>(bytes, rom_banks, 0, false, false); break;
-        case 0x12: return std::make_unique<MBC3>(bytes, rom_banks, ram_banks, false, false); break;
-        case 0x13: return std::make_unique<MBC3>(bytes, rom_banks, ram_banks, true, false); break;
-        case 0x19: return std::make_unique<MBC5>(bytes, rom_banks, 0, false, false); break;
-        case 0x1A: return std::make_unique<MBC5>(bytes, rom_banks, ram_banks, false, false); break;
-        case 0x1B: return std::make_unique<MBC5>(bytes, rom_banks, ram_banks, true, false); break;
-        case 0x1C: return std::make_unique<MBC5>(bytes, rom_banks, 0, false, true); break;
-        case 0x1D: return std::make_unique<MBC5>(bytes, rom_banks, ram_banks, false, true); break;
-        case 0x1E: return std::make_unique<MBC5>(bytes, rom_banks, ram_banks, true, true); break;
+        case 0x10: return std::make_unique<Mapper>(std::in_place_type<MBC3>, rom, rom_banks, ram_banks, true, true); break;
+        case 0x11: return std::make_unique<Mapper>(std::in_place_type<MBC3>, rom, rom_banks, 0, false, false); break;
+        case 0x12: return std::make_unique<Mapper>(std::in_place_type<MBC3>, rom, rom_banks, ram_banks, false, false); break;
+        case 0x13: return std::make_unique<Mapper>(std::in_place_type<MBC3>, rom, rom_banks, ram_banks, true, false); break;
+        case 0x19: return std::make_unique<Mapper>(std::in_place_type<MBC5>, rom, rom_banks, 0, false, false); break;
+        case 0x1A: return std::make_unique<Mapper>(std::in_place_type<MBC5>, rom, rom_banks, ram_banks, false, false); break;
+        case 0x1B: return std::make_unique<Mapper>(std::in_place_type<MBC5>, rom, rom_banks, ram_banks, true, false); break;
+        case 0x1C: return std::make_unique<Mapper>(std::in_place_type<MBC5>, rom, rom_banks, 0, false, true); break;
+        case 0x1D: return std::make_unique<Mapper>(std::in_place_type<MBC5>, rom, rom_banks, ram_banks, false, true); break;
+        case 0x1E: return std::make_unique<Mapper>(std::in_place_type<MBC5>, rom, rom_banks, ram_banks, true, true); break;
         }
 
         assert(false);
@@ -509,14 +531,40 @@ namespace gandalf {
         result->header_checksum = bytes.at(0x14D);
         std::copy(bytes.begin() + 0x14E, bytes.begin() + 0x150, result->global_checksum.begin());
 
-        mbc_ = CreateMBC(bytes, *result);
+        const std::size_t rom_banks = GetROMBankCount(*result);
+        if (rom_banks > 0 && bytes.size() > rom_banks * ROMBankSize)
+            std::cout << "Warning: the file contains more data than expected" << std::endl;
+
+        auto rom = std::make_shared<std::vector<MBC::ROMBank>>(std::min(rom_banks, bytes.size() / ROMBankSize));
+        for (std::size_t bank = 0; bank < rom->size(); ++bank)
+            std::copy(bytes.begin() + bank * ROMBankSize, bytes.begin() + (bank + 1) * ROMBankSize, (*rom)[bank].begin());
+
+        mbc_ = CreateMBC(rom, *result);
         if (!mbc_)
             return false;
+        GetMBC()->SetClock(rtc_clock_);
 
         header_ = std::move(result);
         return true;
     }
 
+    bool Cartridge::Load(const Cartridge& other)
+    {
+        header_.reset();
+        mbc_.reset();
+
+        if (!other.Loaded())
+            return false;
+
+        mbc_ = CreateMBC(other.GetMBC()->GetROM(), *other.header_);
+        if (!mbc_)
+            return false;
+        GetMBC()->SetClock(rtc_clock_);
+
+        header_ = other.header_;
+        return true;
+    }
+
     bool Cartridge::Loaded() const
     {
         return mbc_ != nullptr;
@@ -527,12 +575,35 @@ namespace gandalf {
         return header_;
     }
 
+    const MBC* Cartridge::GetMBC() const
+    {
+        if (!mbc_)
+            return nullptr;
+
+        return std::visit([](const auto& mbc) -> const MBC* { return &mbc; }, mbc_->mbc);
+    }
+
+    MBC* Cartridge::GetMBC()
+    {
+        if (!mbc_)
+            return nullptr;
+
+        return std::visit([](auto& mbc) -> MBC* { return &mbc; }, mbc_->mbc);
+    }
+
+    void Cartridge::SetRTCClock(const RTCClock* clock)
+    {
+        rtc_clock_ = clock;
+        if (mbc_)
+            GetMBC()->SetClock(clock);
+    }
+
     void Cartridge::Write(word address, byte value)
     {
         if (!mbc_)
             return;
 
-        mbc_->Write(address, value);
+        std::visit([address, value](auto& mbc) { mbc.Write(address, value); }, mbc_->mbc);
     }
 
     byte Cartridge::Read(word address) const
@@ -540,7 +611,15 @@ namespace gandalf {
         if (!mbc_)
             return 0xFF;
 
-        return mbc_->Read(address);
+        return std::visit([address](const auto& mbc) { return mbc.Read(address); }, mbc_->mbc);
+    }
+
+    word Cartridge::GetBank(word address) const
+    {
+        if (!mbc_)
+            return 0;
+
+        return std::visit([address](const auto& mbc) { return mbc.GetBank(address); }, mbc_->mbc);
     }
 
     std::set<word> Cartridge::GetAddresses() const
@@ -556,28 +635,53 @@ namespace gandalf {
     }
 
     void Cartridge::Serialize(std::ostream& stream) const
+    {
+        Serialize(stream, true);
+    }
+
+    void Cartridge::Serialize(std::ostream& stream, bool include_rom) const
     {
         if (!header_ || !mbc_)
             throw SerializationException("No cartridge loaded");
 
         header_->Serialize(stream);
-        mbc_->Serialize(stream);
+        serialization::Serialize(stream, include_rom);
+        if (include_rom)
+            serialization::Serialize(stream, *GetMBC()->GetROM());
+        std::visit([&stream](const auto& mbc) { mbc.Serialize(stream); }, mbc_->mbc);
     }
 
     void Cartridge::Deserialize(std::istream& stream, std::uint16_t version)
     {
         auto header = std::make_shared<Header>();
         header->Deserialize(stream, version);
-        header_ = std::move(header);
 
-        ROM rom;
-        std::size_t rom_banks = std::size_t(1) << (header_->rom_size + 1);
-        rom.resize(ROMBankSize * (rom_banks));
+        bool include_rom;
+        serialization::Deserialize(stream, include_rom);
+        MBC::SharedROM rom;
+        if (include_rom)
+        {
+            auto banks = std::make_shared<std::vector<MBC::ROMBank>>();
+            serialization::Deserialize(stream, *banks);
+            if (banks->size() != GetROMBankCount(*header))
+                throw SerializationException("The ROM does not match the cartridge header");
+            rom = std::move(banks);
+        }
+        else
+        {
+            // The ROM of the loaded cartridge is shared instead
+            if (!mbc_ || !(*header == *header_))
+                throw SerializationException("The state does not contain the ROM, and was saved with another cartridge than the one that is loaded");
+            rom = GetMBC()->GetROM();
+        }
 
-        mbc_ = CreateMBC(rom, *header_);
-        if (!mbc_)
+        auto mbc = CreateMBC(rom, *header);
+        if (!mbc)
             throw SerializationException("Failed to create MBC");
+        std::visit([&stream, version](auto& mbc) { mbc.Deserialize(stream, version); }, mbc->mbc);
 
-        mbc_->Deserialize(stream, version);
+        header_ = std::move(header);
+        mbc_ = std::move(mbc);
+        GetMBC()->SetClock(rtc_clock_);
     }
-}
\ No newline at end of file
+}
@@ -5,25 +5,62 @@
 #include <gandalf/util.h>
 
 namespace gandalf {
-    MBC::MBC(const ROM& rom, std::size_t rom_banks, std::size_t ram_banks) {
-        rom_.resize(rom_banks);
-        ram_.resize(ram_banks);
-
-        for (size_t bank = 0; bank < rom_banks; ++bank)
-            std::copy(rom.begin() + bank * 0x4000, rom.begin() + (bank + 1) * 0x4000, rom_[bank].begin());
+    MBC::MBC(SharedROM rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery): rom_(rom->data()), rom_banks_(rom_banks),
+        has_battery_(has_battery), rom_storage_(std::move(rom)), dirty_ram_banks_(0), footer_dirty_(false) {
+        assert(rom_storage_->size() == rom_banks);
+        assert(ram_banks <= 32);
 
+        ram_.resize(ram_banks);
         for (size_t bank = 0; bank < ram_banks; ++bank)
             ram_[bank].fill(0);
     }
     MBC::~MBC() = default;
 
+    void MBC::LoadRAM(std::istream& is) {
+        for (RAMBank& bank : ram_) {
+            if (!is.read(reinterpret_cast<char*>(bank.data()), bank.size()))
+                throw SerializationException("The save is smaller than the cartridge RAM");
+        }
+        dirty_ram_banks_ = ram_.empty() ? 0 : static_cast<std::uint32_t>((std::uint64_t(1) << ram_.size()) - 1);
+        LoadFooter(is);
+    }
+
+    void MBC::SaveRAM(std::ostream& os) const {
+        for (const RAMBank& bank : ram_)
+            os.write(reinterpret_cast<const char*>(bank.data()), bank.size());
+        SaveFooter(os);
+    }
+
+    void MBC::SaveFooter(std::ostream&) const {
+    }
+
+    void MBC::LoadFooter(std::istream&) {
+    }
+
+    void MBC::SetClock(const RTCClock*) {
+    }
+
+    std::uint32_t MBC::TakeDirtyRAMBanks() {
+        const std::uint32_t result = dirty_ram_banks_;
+        dirty_ram_banks_ = 0;
+        return result;
+    }
+
+    bool MBC::TakeDirtyFooter() {
+        const bool result = footer_dirty_;
+        footer_dirty_ = false;
+        return result;
+    }
+
     void MBC::Serialize(std::ostream& os) const {
-        serialization::Serialize(os, rom_);
         serialization::Serialize(os, ram_);
     }
 
     void MBC::Deserialize(std::istream& is, std::uint16_t) {
-        serialization::Deserialize(is, rom_);
         serialization::Deserialize(is, ram_);
+        if (ram_.size() > 32)
+            throw SerializationException("Too many RAM banks");
+        dirty_ram_banks_ = ram_.empty() ? 0 : static_cast<std::uint32_t>((std::uint64_t(1) << ram_.size()) - 1);
+        footer_dirty_ = true;
     }
 }
\ No newline at end of file
@@ -5,13 +5,12 @@
 #include <gandalf/util.h>
 
 namespace gandalf {
-    MBC1::MBC1(const ROM& rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery): MBC(rom, rom_banks, ram_banks),
-        ram_enabled_(false), rom_bank_number_(1), ram_bank_number_(0), advanced_banking_mode_(false), has_battery_(has_battery)
+    MBC1::MBC1(SharedROM rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery): MBC(std::move(rom), rom_banks, ram_banks, has_battery),
+        ram_enabled_(false), rom_bank_number_(1), ram_bank_number_(0), advanced_banking_mode_(false)
     {
         assert(rom_banks % 2 == 0 && rom_banks <= 128);
         assert(ram_banks == 0 || ram_banks == 1 || ram_banks == 4);
 
-        (void)has_battery_;
     }
 
     MBC1::~MBC1() = default;
@@ -22,12 +21,12 @@ namespace gandalf {
         if (address < 0x4000) {
             word bank = 0;
             if (advanced_banking_mode_) {
-                bank = (ram_bank_number_ << 5) % static_cast<byte>(rom_.size());
+                bank = (ram_bank_number_ << 5) % static_cast<byte>(rom_banks_);
             }
             return rom_[bank][address];
         }
         else if (address < 0x8000) {
-            byte bank = (rom_bank_number_ | (ram_bank_number_ << 5)) % static_cast<byte>(rom_.size());
+            byte bank = (rom_bank_number_ | (ram_bank_number_ << 5)) % static_cast<byte>(rom_banks_);
             return rom_[bank][address - 0x4000];
         }
         else if (BETWEEN(address, 0xA000, 0xC000)) {
@@ -68,10 +67,21 @@ namespace gandalf {
             if (advanced_banking_mode_ && ram_bank_number_ < ram_.size())
                 bank_number = ram_bank_number_;
 
-            ram_[bank_number][address - 0xA000] = value;
+            WriteRAM(bank_number, address - 0xA000, value);
         }
     }
 
+    word MBC1::GetBank(word address) const {
+        if (address < 0x4000)
+            return advanced_banking_mode_ ? (ram_bank_number_ << 5) % static_cast<byte>(rom_banks_) : 0;
+        else if (address < 0x8000)
+            return (rom_bank_number_ | (ram_bank_number_ << 5)) % static_cast<byte>(rom_banks_);
+        else if (advanced_banking_mode_ && ram_bank_number_ < ram_.size())
+            return ram_bank_number_;
+
+        return 0;
+    }
+
     void MBC1::Serialize(std::ostream& os) const {
         MBC::Serialize(os);
 
@@ -5,13 +5,14 @@
 #include <gandalf/mbc.h>
 
 namespace gandalf {
-    class MBC1: public MBC {
+    class MBC1 final: public MBC {
     public:
-        MBC1(const ROM& rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery);
+        MBC1(SharedROM rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery);
         virtual ~MBC1();
 
         byte Read(word address) const override;
         void Write(word address, byte value) override;
+        word GetBank(word address) const override;
 
         void Serialize(std::ostream& os) const override;
         void Deserialize(std::istream& is, std::uint16_t version) override;
@@ -21,7 +22,6 @@ namespace gandalf {
         word rom_bank_number_;
         word ram_bank_number_;
         bool advanced_banking_mode_;
-        bool has_battery_; // TODO: implement battery
     };
 }
 
@@ -2,21 +2,46 @@
 
 #include <cassert>
 
+#include <gandalf/constants.h>
 #include <gandalf/util.h>
 
+namespace {
+    // The footer of battery saves that is used by most emulators: the clock registers and the latched registers as 32 bit values,
+    // followed by the UNIX time at which the save was written as a 64 bit value. Older saves use a 32 bit time. With the emulated time
+    // the seconds of emulated time are written instead, which the loader ignores.
+    constexpr std::size_t kFooterSize = 48;
+    constexpr std::size_t kShortFooterSize = 44;
+
+    void PutValue(char* output, std::uint64_t value, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            output[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    std::uint64_t GetValue(const char* input, std::size_t size)
+    {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < size; ++i)
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(input[i])) << (8 * i);
+        return value;
+    }
+}
+
 namespace gandalf {
-    MBC3::MBC3(const ROM& rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery, bool has_timer): MBC(rom, rom_banks, ram_banks),
+    MBC3::MBC3(SharedROM rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery, bool has_timer): MBC(std::move(rom), rom_banks, ram_banks, has_battery),
         ram_enabled_(false),
         rom_bank_number_(0),
         ram_bank_number_(0),
-        has_battery_(has_battery),
-        has_timer_(has_timer)
+        has_timer_(has_timer),
+        clock_(nullptr),
+        rtc_(),
+        rtc_reference_(0),
+        rtc_subsecond_(0),
+        latched_rtc_(),
+        latch_value_(0xFF)
     {
         assert(rom_banks % 2 == 0 && rom_banks <= 128);
         assert(ram_banks == 0 || ram_banks == 1 || ram_banks == 4);
-
-        (void)has_battery_;
-        (void)has_timer_;
     }
 
     MBC3::~MBC3() = default;
@@ -31,10 +56,16 @@ namespace gandalf {
             return rom_[rom_bank_number_][address - 0x4000];
         }
         else if (BETWEEN(address, 0xA000, 0xC000)) {
-            if (ram_.size() == 0 || !ram_enabled_)
+            if (!ram_enabled_)
+                return 0xFF;
+
+            if (ram_bank_number_ >= 0x08)
+                return has_timer_ ? ReadRTC(latched_rtc_, ram_bank_number_) : 0xFF;
+
+            if (ram_.size() == 0)
                 return 0xFF;
 
-            return ram_[ram_bank_number_][address - 0xA000];
+            return ram_[(ram_bank_number_ & 0x3) % ram_.size()][address - 0xA000];
         }
 
         return 0xFF;
@@ -46,22 +77,159 @@ namespace gandalf {
         if (address < 0x2000)
             ram_enabled_ = (value & 0x0F) == 0x0A;
         else if (address < 0x4000) {
-            rom_bank_number_ = (value & 0x7F) % rom_.size();
+            rom_bank_number_ = (value & 0x7F) % rom_banks_;
             if (rom_bank_number_ == 0)
                 rom_bank_number_ = 1;
         }
         else if (address < 0x6000)
-            ram_bank_number_ = (value & 0x3);
-        else if (address < 0x8000)
-            (void)value; // TODO latch
+            ram_bank_number_ = value <= 0x0C ? value : (value & 0x3);
+        else if (address < 0x8000) {
+            // Writing 0 and then 1 copies the clock to the latched registers, which are the ones that can be read
+            if (has_timer_ && latch_value_ == 0x00 && value == 0x01)
+                latched_rtc_ = GetRTC(GetTime());
+            latch_value_ = value;
+        }
         else if (BETWEEN(address, 0xA000, 0xC000)) {
-            if (ram_.size() == 0 || !ram_enabled_)
+            if (!ram_enabled_)
+                return;
+
+            if (ram_bank_number_ >= 0x08) {
+                if (!has_timer_)
+                    return;
+
+                UpdateRTC();
+                switch (ram_bank_number_) {
+                case 0x08: rtc_.seconds = value & 0x3F; rtc_subsecond_ = 0; break;
+                case 0x09: rtc_.minutes = value & 0x3F; break;
+                case 0x0A: rtc_.hours = value & 0x1F; break;
+                case 0x0B: rtc_.days = (rtc_.days & 0x100) | value; break;
+                case 0x0C:
+                    rtc_.days = (rtc_.days & 0xFF) | ((value & 0x01) << 8);
+                    rtc_.halt = value & 0x40;
+                    rtc_.carry = value & 0x80;
+                    break;
+                }
+                MarkFooterDirty();
                 return;
+            }
 
-            ram_[ram_bank_number_][address - 0xA000] = value;
+            if (ram_.size() == 0)
+                return;
+
+            WriteRAM((ram_bank_number_ & 0x3) % ram_.size(), address - 0xA000, value);
         }
     }
 
+    word MBC3::GetBank(word address) const {
+        if (address < 0x4000)
+            return 0;
+        else if (address < 0x8000)
+            return rom_bank_number_;
+
+        return ram_bank_number_;
+    }
+
+    std::uint64_t MBC3::GetTime() const {
+        return clock_ ? clock_->GetTime() : rtc_reference_;
+    }
+
+    MBC3::RTC MBC3::GetRTC(std::uint64_t time, std::uint64_t* subsecond) const {
+        RTC rtc = rtc_;
+        std::uint64_t cycles = rtc_subsecond_;
+        if (!rtc.halt && time > rtc_reference_) {
+            cycles += time - rtc_reference_;
+            const std::uint64_t seconds = cycles / CPUFrequency;
+            cycles %= CPUFrequency;
+
+            if (seconds > 0) {
+                std::uint64_t total = ((std::uint64_t(rtc.days) * 24 + rtc.hours) * 60 + rtc.minutes) * 60 + rtc.seconds + seconds;
+                rtc.seconds = static_cast<byte>(total % 60);
+                total /= 60;
+                rtc.minutes = static_cast<byte>(total % 60);
+                total /= 60;
+                rtc.hours = static_cast<byte>(total % 24);
+                total /= 24;
+                if (total > 0x1FF)
+                    rtc.carry = true;
+                rtc.days = static_cast<word>(total & 0x1FF);
+            }
+        }
+
+        if (subsecond)
+            *subsecond = cycles;
+        return rtc;
+    }
+
+    void MBC3::UpdateRTC() {
+        const std::uint64_t time = GetTime();
+        rtc_ = GetRTC(time, &rtc_subsecond_);
+        rtc_reference_ = time;
+    }
+
+    byte MBC3::ReadRTC(const RTC& rtc, word index) {
+        switch (index) {
+        case 0x08: return rtc.seconds;
+        case 0x09: return rtc.minutes;
+        case 0x0A: return rtc.hours;
+        case 0x0B: return static_cast<byte>(rtc.days & 0xFF);
+        case 0x0C: return static_cast<byte>((rtc.days >> 8) | (rtc.halt ? 0x40 : 0) | (rtc.carry ? 0x80 : 0));
+        default: return 0xFF;
+        }
+    }
+
+    void MBC3::SetClock(const RTCClock* clock) {
+        UpdateRTC();
+        clock_ = clock;
+        rtc_reference_ = GetTime();
+    }
+
+    void MBC3::SaveFooter(std::ostream& os) const {
+        if (!has_timer_)
+            return;
+
+        const std::uint64_t time = GetTime();
+        const RTC rtc = GetRTC(time);
+        const std::uint64_t timestamp = time / CPUFrequency;
+
+        char footer[kFooterSize];
+        for (word index = 0x08; index <= 0x0C; ++index) {
+            PutValue(footer + (index - 0x08) * 4, ReadRTC(rtc, index), 4);
+            PutValue(footer + 20 + (index - 0x08) * 4, ReadRTC(latched_rtc_, index), 4);
+        }
+        PutValue(footer + 40, timestamp, 8);
+        os.write(footer, kFooterSize);
+    }
+
+    void MBC3::LoadFooter(std::istream& is) {
+        if (!has_timer_)
+            return;
+
+        char footer[kFooterSize];
+        is.read(footer, kFooterSize);
+        const std::size_t size = static_cast<std::size_t>(is.gcount());
+        if (size != kFooterSize && size != kShortFooterSize)
+            return;
+
+        const auto to_rtc = [&footer](std::size_t offset) {
+            RTC rtc;
+            rtc.seconds = static_cast<byte>(GetValue(footer + offset, 1) & 0x3F);
+            rtc.minutes = static_cast<byte>(GetValue(footer + offset + 4, 1) & 0x3F);
+            rtc.hours = static_cast<byte>(GetValue(footer + offset + 8, 1) & 0x1F);
+            const byte high = static_cast<byte>(GetValue(footer + offset + 16, 1));
+            rtc.days = static_cast<word>(GetValue(footer + offset + 12, 1) | ((high & 0x01) << 8));
+            rtc.halt = high & 0x40;
+            rtc.carry = high & 0x80;
+            return rtc;
+        };
+        rtc_ = to_rtc(0);
+        latched_rtc_ = to_rtc(20);
+        rtc_subsecond_ = 0;
+
+        // With the host time the clock continues from the moment the save was written
+        const std::uint64_t timestamp = GetValue(footer + 40, size - 40);
+        rtc_reference_ = clock_ && clock_->IsHostTime() ? timestamp * CPUFrequency : GetTime();
+    }
+
     void MBC3::Serialize(std::ostream& os) const {
         MBC::Serialize(os);
 
@@ -70,6 +238,20 @@ namespace gandalf {
         serialization::Serialize(os, ram_bank_number_);
         serialization::Serialize(os, has_battery_);
         serialization::Serialize(os, has_timer_);
+
+        // The clock is stored as it is now, so that the state does not depend on the time source
+        std::uint64_t subsecond;
+        const RTC rtc = GetRTC(GetTime(), &subsecond);
+        for (const RTC* registers : { &rtc, &latched_rtc_ }) {
+            serialization::Serialize(os, registers->seconds);
+            serialization::Serialize(os, registers->minutes);
+            serialization::Serialize(os, registers->hours);
+            serialization::Serialize(os, registers->days);
+            serialization::Serialize(os, registers->halt);
+            serialization::Serialize(os, registers->carry);
+        }
+        serialization::Serialize(os, subsecond);
+        serialization::Serialize(os, latch_value_);
     }
 
     void MBC3::Deserialize(std::istream& is, std::uint16_t version) {
@@ -80,5 +262,17 @@ namespace gandalf {
         serialization::Deserialize(is, ram_bank_number_);
         serialization::Deserialize(is, has_battery_);
         serialization::Deserialize(is, has_timer_);
+
+        for (RTC* registers : { &rtc_, &latched_rtc_ }) {
+            serialization::Deserialize(is, registers->seconds);
+            serialization::Deserialize(is, registers->minutes);
+            serialization::Deserialize(is, registers->hours);
+            serialization::Deserialize(is, registers->days);
+            serialization::Deserialize(is, registers->halt);
+            serialization::Deserialize(is, registers->carry);
+        }
+        serialization::Deserialize(is, rtc_subsecond_);
+        serialization::Deserialize(is, latch_value_);
+        rtc_reference_ = GetTime();
     }
-}
\ No newline at end of file
+}
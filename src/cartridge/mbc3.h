@@ -5,24 +5,62 @@
 #include <gandalf/mbc.h>
 
 namespace gandalf {
-    class MBC3: public MBC {
+    class MBC3 final: public MBC {
     public:
-        MBC3(const ROM& rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery, bool has_timer);
+        MBC3(SharedROM rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery, bool has_timer);
         virtual ~MBC3();
 
         byte Read(word address) const override;
         void Write(word address, byte value) override;
+        word GetBank(word address) const override;
+
+        void SaveFooter(std::ostream& os) const override;
+        void SetClock(const RTCClock* clock) override;
 
         void Serialize(std::ostream& os) const override;
         void Deserialize(std::istream& is, std::uint16_t version) override;
 
+    protected:
+        void LoadFooter(std::istream& is) override;
+
     private:
+        struct RTC
+        {
+            byte seconds;
+            byte minutes;
+            byte hours;
+            word days; // 9 bits
+            bool halt;
+            bool carry; // Set when the day counter overflowed
+        };
+
+        std::uint64_t GetTime() const;
+
+        /**
+         * @param time the time of the clock source
+         * @param subsecond receives the cycles of the current second that have passed, if not null
+         * @returns The clock registers at the given time.
+         */
+        RTC GetRTC(std::uint64_t time, std::uint64_t* subsecond = nullptr) const;
+
+        /// Moves the reference to the current time.
+        void UpdateRTC();
+
+        static byte ReadRTC(const RTC& rtc, word index);
+
         bool ram_enabled_;
         word rom_bank_number_;
-        word ram_bank_number_;
-        bool has_battery_; // TODO: implement battery
+        word ram_bank_number_; // 0x00-0x03 select a RAM bank, 0x08-0x0C a clock register
         bool has_timer_;
+
+        // The clock is not ticked, the registers are computed from the time that passed since the reference when they are needed
+        const RTCClock* clock_;
+        RTC rtc_; // The registers at the reference time
+        std::uint64_t rtc_reference_;
+        std::uint64_t rtc_subsecond_; // Cycles of the current second that had passed at the reference time
+        RTC latched_rtc_;
+        byte latch_value_;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
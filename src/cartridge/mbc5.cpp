@@ -5,17 +5,15 @@
 #include <gandalf/util.h>
 
 namespace gandalf {
-    MBC5::MBC5(const ROM& rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery, bool has_rumble): MBC(rom, rom_banks, ram_banks),
+    MBC5::MBC5(SharedROM rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery, bool has_rumble): MBC(std::move(rom), rom_banks, ram_banks, has_battery),
         ram_enabled_(false),
         rom_bank_number_(1),
         ram_bank_number_(0),
-        has_battery_(has_battery),
         has_rumble_(has_rumble)
     {
         assert(rom_banks % 2 == 0 && rom_banks <= 512);
         assert(ram_banks == 0 || ram_banks == 1 || ram_banks == 4 || ram_banks == 8 || ram_banks == 16);
 
-        (void)has_battery_;
         (void)has_rumble_;
     }
 
@@ -46,19 +44,28 @@ namespace gandalf {
         if (address < 0x2000)
             ram_enabled_ = (value & 0x0F) == 0x0A;
         else if (address < 0x3000)
-            rom_bank_number_ = ((rom_bank_number_ & 0x100) | value) % rom_.size();
+            rom_bank_number_ = ((rom_bank_number_ & 0x100) | value) % rom_banks_;
         else if (address < 0x4000)
-            rom_bank_number_ = ((rom_bank_number_ & 0xFF) | ((value & 0x1) << 8)) % rom_.size();
+            rom_bank_number_ = ((rom_bank_number_ & 0xFF) | ((value & 0x1) << 8)) % rom_banks_;
         else if (address < 0x6000 && ram_.size() > 0)
             ram_bank_number_ = (value & 0x0F) % ram_.size();
         else if (BETWEEN(address, 0xA000, 0xC000)) {
             if (ram_.size() == 0 || !ram_enabled_)
                 return;
 
-            ram_[ram_bank_number_][address - 0xA000] = value;
+            WriteRAM(ram_bank_number_, address - 0xA000, value);
         }
     }
 
+    word MBC5::GetBank(word address) const {
+        if (address < 0x4000)
+            return 0;
+        else if (address < 0x8000)
+            return rom_bank_number_;
+
+        return ram_bank_number_;
+    }
+
     void MBC5::Serialize(std::ostream& os) const
     {
         MBC::Serialize(os);
@@ -5,13 +5,14 @@
 #include <gandalf/mbc.h>
 
 namespace gandalf {
-    class MBC5: public MBC {
+    class MBC5 final: public MBC {
     public:
-        MBC5(const ROM& rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery, bool has_rumble);
+        MBC5(SharedROM rom, std::size_t rom_banks, std::size_t ram_banks, bool has_battery, bool has_rumble);
         virtual ~MBC5();
 
         byte Read(word address) const override;
         void Write(word address, byte value) override;
+        word GetBank(word address) const override;
 
         void Serialize(std::ostream& os) const override;
         void Deserialize(std::istream& is, std::uint16_t version) override;
@@ -20,7 +21,6 @@ namespace gandalf {
         bool ram_enabled_;
         word rom_bank_number_;
         word ram_bank_number_;
-        bool has_battery_; // TODO: implement battery
         bool has_rumble_;
     };
 }
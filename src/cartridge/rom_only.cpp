@@ -5,7 +5,7 @@
 #include <gandalf/util.h>
 
 namespace gandalf {
-    ROMOnly::ROMOnly(const ROM& rom, std::size_t ram_banks) : MBC(rom, 2, ram_banks) {
+    ROMOnly::ROMOnly(SharedROM rom, std::size_t ram_banks) : MBC(std::move(rom), 2, ram_banks, false) {
         assert(ram_banks <= 1);
     }
 
@@ -32,8 +32,11 @@ namespace gandalf {
             return;
         else if (BETWEEN(address, 0xA000, 0xC000)) {
             if (ram_.size() > 0)
-                ram_[0][address % 0xA000] = value;
+                WriteRAM(0, address % 0xA000, value);
         }
     }
 
+    word ROMOnly::GetBank(word address) const {
+        return address >= ROMBankSize && address < 0x8000 ? 1 : 0;
+    }
 } // namespace gandalf
\ No newline at end of file
@@ -5,13 +5,14 @@
 #include <gandalf/mbc.h>
 
 namespace gandalf {
-    class ROMOnly : public MBC {
+    class ROMOnly final : public MBC {
     public:
-        ROMOnly(const ROM& rom, std::size_t ram_banks);
+        ROMOnly(SharedROM rom, std::size_t ram_banks);
         virtual ~ROMOnly();
 
         byte Read(word address) const override;
         void Write(word address, byte value) override;
+        word GetBank(word address) const override;
     };
 }
 
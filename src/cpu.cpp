@@ -22,12 +22,18 @@ namespace gandalf {
 #define CLEAR_CFLAG() registers_.f() &= ~CFlagMask;
 
 #define READ(address, destination)                                             \
-  (destination) = memory_.Read(address); \
+  {                                                                            \
+    GANDALF_PERF_SCOPE(io_.GetPerfCounters(), Memory);                         \
+    (destination) = memory_.Read(address);                                     \
+  }                                                                            \
   ADVANCE_IO(4);                                                  
 
 
 #define WRITE(address, value)                                                  \
-  memory_.Write(address, value); \
+  {                                                                            \
+    GANDALF_PERF_SCOPE(io_.GetPerfCounters(), Memory);                         \
+    memory_.Write(address, value);                                             \
+  }                                                                            \
   ADVANCE_IO(4);                                                  
 
 #define READ_PC(destination) READ(registers_.program_counter++, destination)
@@ -771,6 +777,11 @@ namespace gandalf {
   }
 
   void CPU::Tick() {
+    GANDALF_PERF_SCOPE(io_.GetPerfCounters(), CPU);
+#ifdef GANDALF_ENABLE_PROFILER
+    const std::uint64_t start_cycles = profiler_ ? io_.GetCycleCount() : 0;
+#endif
+
     // Handle interrupts if two corresponding bits in IE and IF are set
     if (registers_.interrupt_enable & registers_.interrupt_flags & 0x1F) {
       halt_ = false;
@@ -779,16 +790,32 @@ namespace gandalf {
       if (registers_.interrupt_master_enable) {
         registers_.interrupt_master_enable = false;
         InterruptServiceRoutine();
+#ifdef GANDALF_ENABLE_PROFILER
+        if (profiler_)
+          profiler_->OnInterrupt(registers_.program_counter, static_cast<std::uint32_t>(io_.GetCycleCount() - start_cycles));
+#endif
         return;
       }
     }
 
     if (!halt_ && !stop_) {
       const bool ei_pending_before = ei_pending_;
+#ifdef GANDALF_ENABLE_PROFILER
+      const word address = registers_.program_counter;
+      const word stack_pointer = registers_.stack_pointer;
+#endif
+
+      if (trace_buffer_)
+        TraceInstruction();
 
       READ_PC(opcode_);
       Execute(opcode_);
 
+#ifdef GANDALF_ENABLE_PROFILER
+      if (profiler_)
+        ProfileInstruction(address, stack_pointer, start_cycles);
+#endif
+
       // EI is delayed by one instruction.
       if (ei_pending_before && ei_pending_)
       {
@@ -796,8 +823,50 @@ namespace gandalf {
         registers_.interrupt_master_enable = true;
       }
     }
-    else
+    else {
       ADVANCE_IO(4);
+#ifdef GANDALF_ENABLE_PROFILER
+      if (profiler_)
+        profiler_->OnIdle(memory_.GetBank(registers_.program_counter), registers_.program_counter, static_cast<std::uint32_t>(io_.GetCycleCount() - start_cycles));
+#endif
+    }
+  }
+
+  void CPU::TraceInstruction()
+  {
+    const word address = registers_.program_counter;
+    TraceRecord record;
+    record.cycle = io_.GetCycleCount();
+    record.program_counter = address;
+    record.bank = memory_.GetBank(address);
+    record.af = registers_.af();
+    record.bc = registers_.bc();
+    record.de = registers_.de();
+    record.hl = registers_.hl();
+    record.stack_pointer = registers_.stack_pointer;
+    record.opcode = memory_.Read(address, false);
+    record.operand = memory_.Read(address + 1, false);
+    trace_buffer_->Push(record);
+  }
+
+  void CPU::ProfileInstruction(word address, word stack_pointer, std::uint64_t start_cycles)
+  {
+    const std::uint32_t cycles = static_cast<std::uint32_t>(io_.GetCycleCount() - start_cycles);
+    const word opcode = opcode_ == 0xCB ? 0x100 | memory_.Read(address + 1, false) : opcode_;
+    profiler_->OnInstruction(memory_.GetBank(address), address, opcode, cycles);
+
+    switch (opcode_) {
+    case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC: // CALL
+    case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF: // RST
+      // Conditional calls that were not taken leave the stack pointer untouched
+      if (registers_.stack_pointer == static_cast<word>(stack_pointer - 2))
+        profiler_->OnCall(memory_.GetBank(registers_.program_counter), registers_.program_counter);
+      break;
+    case 0xC0: case 0xC8: case 0xC9: case 0xD0: case 0xD8: case 0xD9: // RET
+      if (registers_.stack_pointer == static_cast<word>(stack_pointer + 2))
+        profiler_->OnReturn();
+      break;
+    }
   }
 
   void CPU::InterruptServiceRoutine()
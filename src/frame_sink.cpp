@@ -0,0 +1,295 @@
+#include <gandalf/frame_sink.h>
+
+#include <algorithm>
+#include <string>
+
+#include <gandalf/exception.h>
+#include <gandalf/pixel_format.h>
+#include <gandalf/serialization.h>
+
+namespace {
+    using gandalf::byte;
+    using gandalf::LCD;
+
+    constexpr char kMagic[4] = { 'G', 'B', 'R', 'L' };
+    constexpr std::uint16_t kFormatVersion = 1;
+    constexpr int kMaxLiteralRun = 128;
+    constexpr int kMaxRepeatRun = 129;
+    // A single literal pixel between two repeat runs takes 3 bytes, which is the most a pixel can take
+    constexpr std::size_t kMaxEncodedFrameSize = 3 * gandalf::ScreenWidth * gandalf::ScreenHeight;
+
+    // The Gameboy runs at 4194304 cycles per second and a frame takes 70224 cycles
+    constexpr const char* kY4MHeader = "YUV4MPEG2 W160 H144 F4194304:70224 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+
+    void PutPixel(std::vector<byte>& output, LCD::ABGR1555 pixel)
+    {
+        output.push_back(static_cast<byte>(pixel & 0xFF));
+        output.push_back(static_cast<byte>(pixel >> 8));
+    }
+
+    void EncodeRuns(const LCD::ABGR1555* pixels, std::size_t count, std::vector<byte>& output)
+    {
+        std::size_t i = 0;
+        while (i < count)
+        {
+            int run = 1;
+            while (i + run < count && run < kMaxRepeatRun && pixels[i + run] == pixels[i])
+                ++run;
+
+            if (run >= 2)
+            {
+                output.push_back(static_cast<byte>(126 + run));
+                PutPixel(output, pixels[i]);
+                i += run;
+                continue;
+            }
+
+            // Collect literal pixels until a repeated pixel starts
+            const std::size_t start = i;
+            int length = 0;
+            while (i < count && length < kMaxLiteralRun && !(i + 1 < count && pixels[i + 1] == pixels[i]))
+            {
+                ++i;
+                ++length;
+            }
+            output.push_back(static_cast<byte>(length - 1));
+            for (std::size_t j = start; j < start + length; ++j)
+                PutPixel(output, pixels[j]);
+        }
+    }
+
+    void DecodeRuns(const std::vector<byte>& input, LCD::VideoBuffer& delta)
+    {
+        std::size_t position = 0, pixel = 0;
+        const auto read_pixel = [&]() -> LCD::ABGR1555 {
+            if (position + 2 > input.size())
+                throw gandalf::SerializationException("Frame data is truncated");
+            const LCD::ABGR1555 value = static_cast<LCD::ABGR1555>(input[position] | (input[position + 1] << 8));
+            position += 2;
+            return value;
+        };
+
+        while (position < input.size())
+        {
+            const byte header = input[position++];
+            const std::size_t length = header < 128 ? header + 1u : header - 126u;
+            if (pixel + length > delta.size())
+                throw gandalf::SerializationException("Frame contains too many pixels");
+
+            if (header < 128)
+            {
+                for (std::size_t i = 0; i < length; ++i)
+                    delta[pixel++] = read_pixel();
+            }
+            else
+            {
+                const LCD::ABGR1555 value = read_pixel();
+                std::fill_n(delta.begin() + pixel, length, value);
+                pixel += length;
+            }
+        }
+
+        if (pixel != delta.size())
+            throw gandalf::SerializationException("Frame contains too few pixels");
+    }
+}
+
+namespace gandalf {
+    FrameSink::FrameSink(const LCD& lcd, std::ostream& os, Format format, std::size_t queue_capacity): lcd_(lcd), os_(os), format_(format),
+        closing_(false),
+        failed_(false),
+        written_frames_(0),
+        dropped_frames_(0)
+    {
+        if (queue_capacity == 0)
+            throw InvalidArgument("Frame queue capacity must be larger than 0");
+
+        slots_.resize(queue_capacity);
+        for (std::size_t i = 0; i < queue_capacity; ++i)
+            free_slots_.push_back(i);
+        previous_frame_.fill(0);
+
+        writer_ = std::thread(&FrameSink::Run, this);
+    }
+
+    FrameSink::~FrameSink()
+    {
+        try
+        {
+            Close();
+        }
+        catch (const Exception&)
+        {
+        }
+    }
+
+    void FrameSink::OnVBlank()
+    {
+        std::size_t slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_ || free_slots_.empty())
+            {
+                dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        }
+
+        // The slot is owned by this thread until it is queued, so the copy does not hold the lock
+        slots_[slot] = lcd_.GetVideoBuffer();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_slots_.push_back(slot);
+        }
+        condition_.notify_one();
+    }
+
+    void FrameSink::Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        condition_.notify_one();
+
+        if (writer_.joinable())
+            writer_.join();
+
+        if (failed_)
+            throw Exception("Failed to write frames");
+    }
+
+    void FrameSink::Run()
+    {
+        try
+        {
+            WriteHeader();
+        }
+        catch (const SerializationException&)
+        {
+            failed_ = true;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            condition_.wait(lock, [this]() { return !pending_slots_.empty() || closing_; });
+            if (pending_slots_.empty())
+                break;
+
+            const std::size_t slot = pending_slots_.front();
+            pending_slots_.pop_front();
+            const bool failed = failed_;
+            lock.unlock();
+
+            if (!failed)
+            {
+                try
+                {
+                    WriteFrame(slots_[slot]);
+                    written_frames_.fetch_add(1, std::memory_order_relaxed);
+                }
+                catch (const SerializationException&)
+                {
+                    lock.lock();
+                    failed_ = true;
+                    lock.unlock();
+                }
+            }
+
+            lock.lock();
+            free_slots_.push_back(slot);
+        }
+        lock.unlock();
+
+        os_.flush();
+        if (!os_)
+            failed_ = true;
+    }
+
+    void FrameSink::WriteHeader()
+    {
+        if (format_ == Format::Y4M)
+        {
+            os_ << kY4MHeader;
+        }
+        else
+        {
+            os_.write(kMagic, sizeof(kMagic));
+            serialization::Serialize(os_, kFormatVersion);
+            serialization::Serialize(os_, static_cast<std::uint16_t>(ScreenWidth));
+            serialization::Serialize(os_, static_cast<std::uint16_t>(ScreenHeight));
+        }
+
+        if (!os_)
+            throw SerializationException("Failed to write the header");
+    }
+
+    void FrameSink::WriteFrame(const LCD::VideoBuffer& frame)
+    {
+        if (format_ == Format::Y4M)
+        {
+            encoded_.resize(GetFrameSize(PixelFormat::YUV420));
+            ConvertFrame(frame, PixelFormat::YUV420, encoded_.data());
+            os_ << "FRAME\n";
+            os_.write(reinterpret_cast<const char*>(encoded_.data()), static_cast<std::streamsize>(encoded_.size()));
+        }
+        else
+        {
+            // Unchanged pixels become zero, so static parts of the screen are stored as long runs
+            for (std::size_t i = 0; i < frame.size(); ++i)
+                previous_frame_[i] ^= frame[i];
+
+            encoded_.clear();
+            EncodeRuns(previous_frame_.data(), previous_frame_.size(), encoded_);
+            previous_frame_ = frame;
+
+            serialization::Serialize(os_, static_cast<std::uint32_t>(encoded_.size()));
+            os_.write(reinterpret_cast<const char*>(encoded_.data()), static_cast<std::streamsize>(encoded_.size()));
+        }
+
+        if (!os_)
+            throw SerializationException("Failed to write a frame");
+    }
+
+    std::vector<LCD::VideoBuffer> FrameSink::ReadDeltaRLE(std::istream& is)
+    {
+        char magic[sizeof(kMagic)];
+        if (!is.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(kMagic)))
+            throw SerializationException("Not a frame recording");
+
+        std::uint16_t version, width, height;
+        serialization::Deserialize(is, version);
+        serialization::Deserialize(is, width);
+        serialization::Deserialize(is, height);
+        if (version != kFormatVersion)
+            throw SerializationException("Unsupported frame recording version " + std::to_string(version));
+        if (width != ScreenWidth || height != ScreenHeight)
+            throw SerializationException("Unsupported frame size");
+
+        std::vector<LCD::VideoBuffer> frames;
+        LCD::VideoBuffer frame;
+        frame.fill(0);
+        std::vector<byte> encoded;
+        LCD::VideoBuffer delta;
+        while (is.peek() != std::char_traits<char>::eof())
+        {
+            std::uint32_t size;
+            serialization::Deserialize(is, size);
+            if (size > kMaxEncodedFrameSize)
+                throw SerializationException("Frame data is too large");
+            encoded.resize(size);
+            if (!is.read(reinterpret_cast<char*>(encoded.data()), size))
+                throw SerializationException("Frame data is truncated");
+
+            DecodeRuns(encoded, delta);
+            for (std::size_t i = 0; i < frame.size(); ++i)
+                frame[i] ^= delta[i];
+            frames.push_back(frame);
+        }
+        return frames;
+    }
+} // namespace gandalf
@@ -1,5 +1,7 @@
 #include <gandalf/gameboy.h>
 
+#include <chrono>
+
 #include <gandalf/exception.h>
 
 #include "bootrom.h"
@@ -24,18 +26,27 @@ namespace gandalf {
         }
     }
 
-    constexpr std::uint16_t SAVESTATE_VERSION = 1; // Must be increased when the save state format changes
+    constexpr std::uint16_t SAVESTATE_VERSION = 6; // Must be increased when the save state format changes
 
     Gameboy::Gameboy(Model emulated_model):
         mode_(GetPreferredMode(emulated_model)),
         model_(emulated_model),
         io_(mode_, memory_),
         cpu_(mode_, io_, memory_),
-        wram_(mode_)
+        wram_(mode_),
+        rtc_clock_(io_),
+        debug_handler_(*this),
+        debug_listener_(nullptr),
+        stop_requested_(false),
+        stopped_at_breakpoint_(false)
     {
         memory_.Register(cpu_);
         memory_.Register(wram_);
         memory_.Register(hram_);
+        memory_.SetWatchListener(&debug_handler_);
+        io_.GetPPU().AddVBlankListener(&debug_handler_);
+        io_.GetSerial().SetTransferListener(&debug_handler_);
+        cartridge_.SetRTCClock(&rtc_clock_);
     }
 
     Gameboy::~Gameboy()
@@ -47,7 +58,7 @@ namespace gandalf {
             memory_.Unregister(cartridge_);
     }
 
-    bool Gameboy::SaveState(std::ostream& os)
+    bool Gameboy::SaveState(std::ostream& os, bool include_rom) const
     {
         try
         {
@@ -58,7 +69,7 @@ namespace gandalf {
             cpu_.Serialize(os);
             wram_.Serialize(os);
             hram_.Serialize(os);
-            cartridge_.Serialize(os);
+            cartridge_.Serialize(os, include_rom);
             serialization::Serialize(os, boot_rom_handler_ != nullptr);
             if (boot_rom_handler_)
                 boot_rom_handler_->Serialize(os);
@@ -92,7 +103,21 @@ namespace gandalf {
             cpu_.Deserialize(is, version);
             wram_.Deserialize(is, version);
             hram_.Deserialize(is, version);
+            const bool cartridge_mapped = cartridge_.Loaded();
             cartridge_.Deserialize(is, version);
+            stopped_at_breakpoint_ = false;
+
+            // A mapped cartridge keeps its addresses, so handlers that the embedder registered over it stay in place
+            if (!cartridge_mapped)
+                memory_.Register(cartridge_);
+
+            // The boot ROM of the current state may still be mapped, the loaded state decides whether it is
+            if (boot_rom_handler_)
+            {
+                memory_.Unregister(*boot_rom_handler_, cartridge_);
+                boot_rom_handler_.reset();
+            }
+
             bool in_boot_rom;
             serialization::Deserialize(is, in_boot_rom);
             if (in_boot_rom)
@@ -119,14 +144,45 @@ namespace gandalf {
         if (!cartridge_.Load(rom))
             return false;
 
+        MapCartridge();
+        return true;
+    }
+
+    bool Gameboy::LoadROM(const Gameboy& other)
+    {
+        if (!cartridge_.Load(other.cartridge_))
+            return false;
+
+        MapCartridge();
+        return true;
+    }
+
+    void Gameboy::MapCartridge()
+    {
         memory_.Register(cartridge_);
 
         // We need to register the boot ROM after the cartridge, loading the cartridge last would overwrite the boot ROM
         const auto boot_rom_bytes = GetBootROM(model_);
         boot_rom_handler_ = std::make_unique<BootROMHandler>(*this, boot_rom_bytes);
         memory_.Register(*boot_rom_handler_);
+    }
 
-        return true;
+    void Gameboy::SetRTCMode(RTCMode mode)
+    {
+        // Stopping the clock keeps the time that passed with the current source, the new source continues from there
+        cartridge_.SetRTCClock(nullptr);
+        rtc_clock_.SetMode(mode);
+        cartridge_.SetRTCClock(&rtc_clock_);
+    }
+
+    std::uint64_t Gameboy::RTCClockHandler::GetTime() const
+    {
+        if (mode_ == RTCMode::Emulated)
+            return io_.GetTime();
+
+        const auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const std::uint64_t microseconds = now > 0 ? static_cast<std::uint64_t>(now) : 0;
+        return microseconds / 1000000 * CPUFrequency + microseconds % 1000000 * CPUFrequency / 1000000;
     }
 
     void Gameboy::SetAudioHandler(std::shared_ptr<APU::OutputHandler> handler)
@@ -154,11 +210,30 @@ namespace gandalf {
         memory_.Register(handler);
     }
 
+    void Gameboy::SetProfiler(std::shared_ptr<Profiler> profiler)
+    {
+        cpu_.SetProfiler(profiler);
+    }
+
+    void Gameboy::SetSerialPeer(Gameboy* peer)
+    {
+        io_.GetSerial().SetPeer(peer ? &peer->io_.GetSerial() : nullptr);
+    }
+
+    void Gameboy::SetSerialEndpoint(SerialEndpoint* endpoint)
+    {
+        io_.GetSerial().SetEndpoint(endpoint);
+    }
+
+    void Gameboy::SetTraceBuffer(std::shared_ptr<TraceBuffer> trace_buffer)
+    {
+        cpu_.SetTraceBuffer(trace_buffer);
+    }
+
     void Gameboy::OnBootROMFinished()
     {
-        memory_.Unregister(*boot_rom_handler_);
         assert(cartridge_.Loaded());
-        memory_.Register(cartridge_);
+        memory_.Unregister(*boot_rom_handler_, cartridge_);
 
         const byte key0 = boot_rom_handler_->Read(address::KEY0);
         if (model_ == Model::CGB && key0 == 0x4)
@@ -180,5 +255,81 @@ namespace gandalf {
         cpu_.Tick();
     }
 
+    bool Gameboy::RunCycles(std::uint64_t cycles)
+    {
+        return RunUntil(GetCycleCount() + cycles, false, false);
+    }
+
+    bool Gameboy::RunCyclesUntilTransfer(std::uint64_t cycles)
+    {
+        return RunUntil(GetCycleCount() + cycles, false, true);
+    }
+
+    bool Gameboy::RunFrame()
+    {
+        // The PPU runs at half speed in double speed mode
+        const std::uint64_t frame_cycles = cpu_.GetDoubleSpeed() ? 2 * CyclesPerFrame : CyclesPerFrame;
+        return RunUntil(GetCycleCount() + frame_cycles, true, false);
+    }
+
+    bool Gameboy::RunUntil(std::uint64_t end_cycle, bool stop_at_vblank, bool stop_at_transfer)
+    {
+        if (!cartridge_.Loaded())
+            return true;
+
+        stop_requested_ = false;
+        debug_handler_.Reset();
+        while (GetCycleCount() < end_cycle)
+        {
+            // The instruction of a breakpoint that stopped the previous run is executed without reporting the breakpoint again
+            const word pc = cpu_.GetRegisters().program_counter;
+            if (!stopped_at_breakpoint_ && memory_.HasBreakpoint(pc) && memory_.IsBreakpoint(pc))
+            {
+                if (!debug_listener_ || debug_listener_->OnBreakpoint(memory_.GetBank(pc), pc))
+                {
+                    stopped_at_breakpoint_ = true;
+                    return false;
+                }
+            }
+            stopped_at_breakpoint_ = false;
+
+            cpu_.Tick();
+
+            if (stop_requested_)
+                return false;
+            if (stop_at_vblank && debug_handler_.GetVBlank())
+                break;
+            if (stop_at_transfer && debug_handler_.GetTransferStarted())
+                break;
+        }
+
+        return true;
+    }
+
+    void Gameboy::AddBreakpoint(word bank, word address)
+    {
+        memory_.AddBreakpoint(bank, address);
+        if (address == cpu_.GetRegisters().program_counter)
+            stopped_at_breakpoint_ = false;
+    }
+
+    void Gameboy::RemoveBreakpoint(word bank, word address)
+    {
+        memory_.RemoveBreakpoint(bank, address);
+        if (address == cpu_.GetRegisters().program_counter)
+            stopped_at_breakpoint_ = false;
+    }
+
+    void Gameboy::SetWatchpoint(word address, bool read, bool write)
+    {
+        memory_.SetWatchpoint(address, read, write);
+    }
+
+    void Gameboy::OnWatchpoint(word address, byte value, bool write)
+    {
+        if (!debug_listener_ || debug_listener_->OnWatchpoint(address, value, write))
+            stop_requested_ = true;
+    }
+
 
 } // namespace gandalf
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include <gandalf/gameboy_batch.h>
+
+#include <map>
+#include <sstream>
+
+#include <gandalf/exception.h>
+
+namespace gandalf {
+    GameboyBatch::GameboyBatch(Model model, const ROM& rom, std::size_t instances):
+        model_(model),
+        group_of_(instances, 0),
+        buttons_(instances, 0)
+    {
+        if (instances == 0)
+            throw InvalidArgument("A batch needs at least one instance");
+
+        auto gb = std::make_unique<Gameboy>(model_);
+        if (!gb->LoadROM(rom))
+            throw InvalidArgument("Failed to load the ROM");
+
+        groups_.push_back(Group{ std::move(gb), 0 });
+    }
+
+    GameboyBatch::~GameboyBatch() = default;
+
+    void GameboyBatch::SetButtonState(std::size_t instance, Joypad::Button button, bool pressed)
+    {
+        if (pressed)
+            buttons_.at(instance) |= 1 << button;
+        else
+            buttons_.at(instance) &= ~(1 << button);
+    }
+
+    void GameboyBatch::RunFrame()
+    {
+        UpdateGroups();
+        for (Group& group : groups_)
+            group.gb->RunFrame();
+    }
+
+    void GameboyBatch::RunCycles(std::uint64_t cycles)
+    {
+        UpdateGroups();
+        for (Group& group : groups_)
+            group.gb->RunCycles(cycles);
+    }
+
+    void GameboyBatch::Read(word address, std::vector<byte>& values) const
+    {
+        values.resize(GetSize());
+        for (std::size_t i = 0; i < GetSize(); ++i)
+            values[i] = GetGameboy(i).GetMemory().Read(address, false);
+    }
+
+    void GameboyBatch::UpdateGroups()
+    {
+        // The first instance with new buttons takes over the Gameboy of its group, the others get a clone. All clones are made before
+        // any buttons are applied, so they start from the state of the group.
+        std::vector<Group> groups;
+        std::map<std::pair<std::size_t, byte>, std::size_t> new_group_of; // (group, buttons) -> new group
+        std::vector<std::string> states(groups_.size());
+        std::vector<Gameboy*> sources(groups_.size());
+        for (std::size_t i = 0; i < groups_.size(); ++i)
+            sources[i] = groups_[i].gb.get();
+
+        for (std::size_t instance = 0; instance < GetSize(); ++instance)
+        {
+            const std::size_t group = group_of_[instance];
+            const auto key = std::make_pair(group, buttons_[instance]);
+            auto it = new_group_of.find(key);
+            if (it == new_group_of.end())
+            {
+                if (groups_[group].gb)
+                {
+                    groups.push_back(Group{ std::move(groups_[group].gb), groups_[group].buttons });
+                }
+                else
+                {
+                    // The clone shares the ROM of the group, so the state is saved without it
+                    if (states[group].empty())
+                    {
+                        std::ostringstream os;
+                        if (!sources[group]->SaveState(os, false))
+                            throw Exception("Failed to save the state of a group");
+                        states[group] = os.str();
+                    }
+
+                    auto clone = std::make_unique<Gameboy>(model_);
+                    std::istringstream is(states[group]);
+                    if (!clone->LoadROM(*sources[group]) || !clone->LoadState(is))
+                        throw Exception("Failed to clone the state of a group");
+                    groups.push_back(Group{ std::move(clone), groups_[group].buttons });
+                }
+                it = new_group_of.emplace(key, groups.size() - 1).first;
+            }
+            group_of_[instance] = it->second;
+        }
+
+        for (const auto& [key, index] : new_group_of)
+        {
+            Group& group = groups[index];
+            const byte changed = group.buttons ^ key.second;
+            for (int i = 0; i < 8; ++i)
+            {
+                if (changed & (1 << i))
+                    group.gb->SetButtonState(static_cast<Joypad::Button>(i), key.second & (1 << i));
+            }
+            group.buttons = key.second;
+        }
+
+        groups_ = std::move(groups);
+    }
+
+    void GameboyBatch::ReadRegisters(Registers& registers) const
+    {
+        const std::size_t size = GetSize();
+        registers.af.resize(size);
+        registers.bc.resize(size);
+        registers.de.resize(size);
+        registers.hl.resize(size);
+        registers.stack_pointer.resize(size);
+        registers.program_counter.resize(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const gandalf::Registers& cpu_registers = GetGameboy(i).GetCPU().GetRegisters();
+            registers.af[i] = cpu_registers.af();
+            registers.bc[i] = cpu_registers.bc();
+            registers.de[i] = cpu_registers.de();
+            registers.hl[i] = cpu_registers.hl();
+            registers.stack_pointer[i] = cpu_registers.stack_pointer;
+            registers.program_counter[i] = cpu_registers.program_counter;
+        }
+    }
+} // namespace gandalf
@@ -4,15 +4,18 @@
 
 namespace gandalf {
     IO::IO(GameboyMode mode, Memory& memory):
+        perf_frame_listener_(perf_counters_),
         memory_(memory),
         timer_(memory),
         lcd_(mode),
         ppu_(mode, memory, lcd_),
-        serial_(mode),
+        serial_(mode, memory),
         joypad_(memory),
         dma_(memory),
         hdma_(mode, memory, lcd_),
-        mode_(mode)
+        mode_(mode),
+        cycles_(0),
+        time_(0)
     {
         memory_.Register(ppu_);
         memory_.Register(lcd_);
@@ -22,6 +25,10 @@ namespace gandalf {
         memory_.Register(apu_);
         memory_.Register(dma_);
         memory_.Register(hdma_);
+
+#ifdef GANDALF_ENABLE_PERF_COUNTERS
+        ppu_.AddVBlankListener(&perf_frame_listener_);
+#endif
     }
 
     IO::~IO() {
@@ -48,26 +55,61 @@ namespace gandalf {
     {
         assert(cycles % 2 == 0);
 
+        cycles_ += cycles;
+        time_ += double_speed ? cycles / 2 : cycles;
+
+        switch (mode_)
+        {
+        case GameboyMode::DMG:
+            TickCycles<GameboyMode::DMG>(cycles, double_speed);
+            break;
+        case GameboyMode::DMGCompatibility:
+            TickCycles<GameboyMode::DMGCompatibility>(cycles, double_speed);
+            break;
+        case GameboyMode::CGB:
+            TickCycles<GameboyMode::CGB>(cycles, double_speed);
+            break;
+        }
+
+        // When using this transfer method, all data is transferred at once. The execution of the program is halted until the transfer has completed.
+        if (mode_ == GameboyMode::CGB && hdma_.GetRemainingGDMACycles() > 0)
+            Tick(double_speed ? hdma_.GetRemainingGDMACycles() * 2 : hdma_.GetRemainingGDMACycles(), double_speed);
+    }
+
+    template <GameboyMode mode>
+    void IO::TickCycles(unsigned int cycles, bool double_speed)
+    {
         for (unsigned int i = 0; i < cycles; ++i) {
-            timer_.Tick();
+            {
+                GANDALF_PERF_SCOPE(perf_counters_, Timer);
+                timer_.Tick();
+            }
             serial_.Tick();
-            dma_.Tick();
+            {
+                GANDALF_PERF_SCOPE(perf_counters_, DMA);
+                dma_.Tick();
+            }
 
             // In double speed the components above operate twice as fast. 
             // We implement this by running the components below twice as slow. 
             if (!double_speed || i % 2 == 0)
             {
-                ppu_.Tick();
-                apu_.Tick();
+                {
+                    GANDALF_PERF_SCOPE(perf_counters_, PPU);
+                    ppu_.Tick<mode>();
+                }
+                {
+                    GANDALF_PERF_SCOPE(perf_counters_, APU);
+                    apu_.Tick();
+                }
 
-                if (mode_ == GameboyMode::CGB)
+                if constexpr (mode == GameboyMode::CGB)
+                {
+                    GANDALF_PERF_SCOPE(perf_counters_, HDMA);
                     hdma_.Tick();
+                }
             }
         }
-
-        // When using this transfer method, all data is transferred at once. The execution of the program is halted until the transfer has completed.
-        if (mode_ == GameboyMode::CGB && hdma_.GetRemainingGDMACycles() > 0)
-            Tick(double_speed ? hdma_.GetRemainingGDMACycles() * 2 : hdma_.GetRemainingGDMACycles(), double_speed);
     }
 
     void IO::Serialize(std::ostream& os) const
@@ -81,6 +123,8 @@ namespace gandalf {
         dma_.Serialize(os);
         hdma_.Serialize(os);
         serialization::Serialize(os, static_cast<byte>(mode_));
+        serialization::Serialize(os, cycles_);
+        serialization::Serialize(os, time_);
     }
 
     void IO::Deserialize(std::istream& is, std::uint16_t version)
@@ -96,6 +140,8 @@ namespace gandalf {
         byte mode;
         serialization::Deserialize(is, mode);
         mode_ = static_cast<GameboyMode>(mode);
+        serialization::Deserialize(is, cycles_);
+        serialization::Deserialize(is, time_);
     }
 
 } // namespace gandalf
\ No newline at end of file
@@ -25,7 +25,7 @@ namespace
 
 namespace gandalf
 {
-    Joypad::Joypad(Memory& memory): Memory::AddressHandler("Joypad"), p1_(0xCF), memory_(memory)
+    Joypad::Joypad(Memory& memory): Memory::AddressHandler("Joypad"), p1_(0xCF), memory_(memory), listener_(nullptr)
     {
         pressed_buttons_.fill(false);
     }
@@ -35,6 +35,9 @@ namespace gandalf
     void Joypad::SetButtonState(Button button, bool pressed)
     {
         bool was_pressed = pressed_buttons_[button];
+        if (listener_ && pressed != was_pressed)
+            listener_->OnButtonStateChanged(button, pressed);
+
         pressed_buttons_[button] = pressed;
         Update();
         if (pressed && !was_pressed)
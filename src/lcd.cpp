@@ -8,11 +8,39 @@
 
 namespace {
     constexpr gandalf::LCD::ABGR1555 kColorsDMG[4] = { 0xEBFC, 0xBB11, 0xA9A6, 0x9061 };
+
+    // Final mixing step of MurmurHash3, spreads every input bit over the whole hash
+    inline std::uint64_t Mix(std::uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDull;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    std::uint64_t CombineLineHashes(const std::array<std::uint64_t, gandalf::ScreenHeight>& line_hashes)
+    {
+        std::uint64_t hash = 0;
+        for (std::uint64_t line_hash : line_hashes)
+            hash = Mix(hash ^ line_hash);
+        return hash;
+    }
 }
 
 namespace gandalf
 {
     LCD::LCD(GameboyMode mode): Memory::AddressHandler("LCD"),
+        frame_hash_(0),
+        frame_unchanged_(false),
+        frame_published_(false),
+        color_output_(true),
+        back_index_(0),
+        front_index_(1),
+        ready_index_(2),
+        published_index_(2),
+        frame_acquired_(false),
         lcdc_(0),
         ly_(0),
         lyc_(0),
@@ -28,9 +56,22 @@ namespace gandalf
         ocps_(0),
         mode_(mode)
     {
-        video_buffer_.fill((byte)std::rand());
+        for (auto& buffer : buffers_)
+            buffer.fill((byte)std::rand());
         bcpd_.fill((word)std::rand());
         ocpd_.fill((word)std::rand());
+
+        for (unsigned int i = 0; i < kBufferCount; ++i)
+        {
+            for (int line = 0; line < ScreenHeight; ++line)
+                HashLine(i, static_cast<byte>(line));
+            frame_hashes_[i] = CombineLineHashes(line_hashes_[i]);
+        }
+        frame_hash_ = frame_hashes_[ready_index_ & kIndexMask];
+        published_line_hashes_ = line_hashes_[ready_index_ & kIndexMask];
+        dirty_lines_.set();
+        for (auto& lines : acquired_dirty_lines_)
+            lines.set();
     }
 
     LCD::~LCD() = default;
@@ -179,7 +220,7 @@ namespace gandalf
 
     void LCD::Serialize(std::ostream& os) const
     {
-        serialization::Serialize(os, video_buffer_);
+        serialization::Serialize(os, buffers_[back_index_]);
         serialization::Serialize(os, lcdc_);
         serialization::Serialize(os, ly_);
         serialization::Serialize(os, lyc_);
@@ -200,7 +241,9 @@ namespace gandalf
 
     void LCD::Deserialize(std::istream& is, std::uint16_t)
     {
-        serialization::Deserialize(is, video_buffer_);
+        serialization::Deserialize(is, buffers_[back_index_]);
+        for (int line = 0; line < ScreenHeight; ++line)
+            HashLine(back_index_, static_cast<byte>(line));
         serialization::Deserialize(is, lcdc_);
         serialization::Deserialize(is, ly_);
         serialization::Deserialize(is, lyc_);
@@ -267,6 +310,124 @@ namespace gandalf
 
     void LCD::RenderPixel(byte x, byte color_index, bool is_sprite, byte palette_index)
     {
-        video_buffer_[ScreenWidth * ly_ + x] = is_sprite ? GetSpriteColor(color_index, palette_index) : GetBackgroundColor(color_index, palette_index);
+        if (palette_index > (mode_ != GameboyMode::DMG ? 7 : is_sprite ? 1 : 0))
+            throw InvalidArgument("Palette index out of range");
+
+        switch (mode_)
+        {
+        case GameboyMode::DMG:
+            RenderPixel<GameboyMode::DMG>(x, color_index, is_sprite, palette_index);
+            break;
+        case GameboyMode::DMGCompatibility:
+            RenderPixel<GameboyMode::DMGCompatibility>(x, color_index, is_sprite, palette_index);
+            break;
+        case GameboyMode::CGB:
+            RenderPixel<GameboyMode::CGB>(x, color_index, is_sprite, palette_index);
+            break;
+        }
+    }
+
+    template <GameboyMode mode>
+    void LCD::RenderPixel(byte x, byte color_index, bool is_sprite, byte palette_index)
+    {
+        const std::size_t position = ScreenWidth * ly_ + x;
+        if (color_output_)
+        {
+            if constexpr (mode == GameboyMode::DMG)
+            {
+                const byte palette = !is_sprite ? bgp_ : palette_index == 0 ? obp0_ : obp1_;
+                buffers_[back_index_][position] = kColorsDMG[(palette >> (2 * color_index)) & 0x3];
+            }
+            else
+                buffers_[back_index_][position] = (is_sprite ? ocpd_ : bcpd_)[palette_index * 4 + color_index];
+            if (x == ScreenWidth - 1)
+                HashLine(back_index_, ly_);
+        }
+
+        if (!observations_.empty())
+        {
+            Observation& observation = observations_[back_index_];
+            observation.color_indices[position] = color_index;
+            const byte bit = static_cast<byte>(0x80 >> (position % 8));
+            byte& mask = observation.sprite_mask[position / 8];
+            mask = is_sprite ? (mask | bit) : (mask & ~bit);
+        }
     }
-}
\ No newline at end of file
+
+    void LCD::HashLine(unsigned int buffer_index, byte line)
+    {
+        // Four pixels are hashed at a time, the pixels are combined explicitly so that the hash does not depend on the byte order
+        const ABGR1555* pixels = buffers_[buffer_index].data() + ScreenWidth * line;
+        std::uint64_t hash = line;
+        for (int x = 0; x < ScreenWidth; x += 4)
+        {
+            const std::uint64_t value = pixels[x] | (std::uint64_t(pixels[x + 1]) << 16) | (std::uint64_t(pixels[x + 2]) << 32)
+                | (std::uint64_t(pixels[x + 3]) << 48);
+            hash = (hash ^ value) * 0x100000001B3ull;
+            hash ^= hash >> 29;
+        }
+        line_hashes_[buffer_index][line] = Mix(hash);
+    }
+
+    template void LCD::RenderPixel<GameboyMode::DMG>(byte x, byte color_index, bool is_sprite, byte palette_index);
+    template void LCD::RenderPixel<GameboyMode::DMGCompatibility>(byte x, byte color_index, bool is_sprite, byte palette_index);
+    template void LCD::RenderPixel<GameboyMode::CGB>(byte x, byte color_index, bool is_sprite, byte palette_index);
+
+    void LCD::PublishFrame()
+    {
+        const std::uint64_t hash = CombineLineHashes(line_hashes_[back_index_]);
+        frame_unchanged_ = hash == frame_hash_;
+        frame_hash_ = hash;
+        frame_hashes_[back_index_] = hash;
+
+        for (int line = 0; line < ScreenHeight; ++line)
+            dirty_lines_[line] = !frame_published_ || line_hashes_[back_index_][line] != published_line_hashes_[line];
+        published_line_hashes_ = line_hashes_[back_index_];
+        frame_published_ = true;
+
+        // When the previous frame was never acquired, the reader has to catch up with its changes as well. If the reader acquires it
+        // after this check, the mask just contains more lines than needed.
+        LineMask& acquired_dirty_lines = acquired_dirty_lines_[back_index_];
+        acquired_dirty_lines = dirty_lines_;
+        const unsigned int ready_index = ready_index_.load(std::memory_order_acquire);
+        if ((ready_index & kNewFrameFlag) != 0)
+            acquired_dirty_lines |= acquired_dirty_lines_[ready_index & kIndexMask];
+
+        published_index_ = back_index_;
+        back_index_ = ready_index_.exchange(back_index_ | kNewFrameFlag, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    const LCD::VideoBuffer* LCD::AcquireFrame()
+    {
+        if (frame_acquired_)
+            throw Exception("The previous frame was not released");
+
+        if ((ready_index_.load(std::memory_order_relaxed) & kNewFrameFlag) == 0)
+            return nullptr;
+
+        front_index_ = ready_index_.exchange(front_index_, std::memory_order_acq_rel) & kIndexMask;
+        frame_acquired_ = true;
+        return &buffers_[front_index_];
+    }
+
+    void LCD::ReleaseFrame()
+    {
+        frame_acquired_ = false;
+    }
+
+    void LCD::SetObservationOutput(bool enabled)
+    {
+        if (frame_acquired_)
+            throw Exception("The observation output cannot be changed while a frame is acquired");
+
+        if (!enabled)
+            observations_.clear();
+        else if (observations_.empty())
+            observations_.resize(kBufferCount, Observation{});
+    }
+
+    const Observation* LCD::GetAcquiredObservation() const
+    {
+        return frame_acquired_ && !observations_.empty() ? &observations_[front_index_] : nullptr;
+    }
+}
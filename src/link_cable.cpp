@@ -0,0 +1,88 @@
+#include <gandalf/link_cable.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <gandalf/exception.h>
+
+namespace {
+    // While neither instance shifts bits, the instances only need to meet when one of them starts a transfer, which ends its run early.
+    // The first instance is rewound when the second one starts a transfer, so a chunk must be long enough to amortize the snapshot.
+    constexpr std::uint64_t kIdleChunk = 4096;
+
+    std::uint64_t GetCyclesBeforeShift(const gandalf::Serial& serial)
+    {
+        // The chunk ends one cycle before the shift, so that the shift is done at the start of the next chunk when both instances are in sync.
+        const unsigned int cycles = serial.GetCyclesUntilShift();
+        return cycles > 0 ? std::max(1u, cycles - 1) : kIdleChunk;
+    }
+}
+
+namespace gandalf {
+    LinkCable::LinkCable(Gameboy& first, Gameboy& second): first_(first), second_(second), first_start_(first.GetCycleCount()),
+        second_start_(second.GetCycleCount()), elapsed_(0)
+    {
+        first_.SetSerialPeer(&second_);
+        second_.SetSerialPeer(&first_);
+    }
+
+    LinkCable::~LinkCable()
+    {
+        first_.SetSerialPeer(nullptr);
+        second_.SetSerialPeer(nullptr);
+    }
+
+    std::uint64_t LinkCable::GetMaximumChunk() const
+    {
+        return std::min(GetCyclesBeforeShift(first_.GetSerial()), GetCyclesBeforeShift(second_.GetSerial()));
+    }
+
+    bool LinkCable::RunCycles(std::uint64_t cycles)
+    {
+        const std::uint64_t end = elapsed_ + cycles;
+        while (elapsed_ < end)
+        {
+            const std::uint64_t chunk = GetMaximumChunk();
+            const std::uint64_t target = elapsed_ + std::min(end - elapsed_, chunk);
+
+            // While the link is idle, the second instance may start a transfer at a cycle the first one has already passed. The first
+            // instance is then restored from this snapshot and run again up to that cycle.
+            const bool idle = chunk == kIdleChunk;
+            std::ostringstream snapshot;
+            if (idle && !first_.SaveState(snapshot, false))
+                throw Exception("Failed to save the state of the first instance");
+
+            // Both instances may have run a few cycles past the previous chunk, because instructions are not interrupted.
+            // An instance that starts a transfer returns early, the other one then only runs up to the same cycle.
+            const std::uint64_t first_target = first_start_ + target;
+            if (first_.GetCycleCount() < first_target && !first_.RunCyclesUntilTransfer(first_target - first_.GetCycleCount()))
+                return false;
+
+            const std::uint64_t second_target = second_start_ + std::min(target, first_.GetCycleCount() - first_start_);
+            if (second_.GetCycleCount() < second_target && !second_.RunCyclesUntilTransfer(second_target - second_.GetCycleCount()))
+                return false;
+
+            const std::uint64_t second_elapsed = second_.GetCycleCount() - second_start_;
+            if (idle && second_.GetSerial().GetCyclesUntilShift() > 0 && second_elapsed < first_.GetCycleCount() - first_start_)
+            {
+                std::istringstream is(snapshot.str());
+                if (!first_.LoadState(is))
+                    throw Exception("Failed to rewind the first instance");
+
+                const std::uint64_t rewind_target = first_start_ + second_elapsed;
+                if (first_.GetCycleCount() < rewind_target && !first_.RunCyclesUntilTransfer(rewind_target - first_.GetCycleCount()))
+                    return false;
+            }
+
+            elapsed_ = std::min({ target, first_.GetCycleCount() - first_start_, second_elapsed });
+        }
+
+        return true;
+    }
+
+    bool LinkCable::RunFrame()
+    {
+        // The PPU runs at half speed in double speed mode
+        return RunCycles(first_.GetCPU().GetDoubleSpeed() ? 2 * CyclesPerFrame : CyclesPerFrame);
+    }
+} // namespace gandalf
@@ -0,0 +1,208 @@
+#include <gandalf/link_transport.h>
+
+#include <cstring>
+
+#include <gandalf/exception.h>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace gandalf {
+    void LinkMessage::Encode(byte* buffer) const
+    {
+        buffer[0] = static_cast<byte>(type);
+        for (std::size_t i = 0; i < 8; ++i)
+            buffer[1 + i] = static_cast<byte>(time >> (8 * i));
+        buffer[9] = value;
+    }
+
+    LinkMessage LinkMessage::Decode(const byte* buffer)
+    {
+        LinkMessage message;
+        message.type = static_cast<Type>(buffer[0]);
+        message.time = 0;
+        for (std::size_t i = 0; i < 8; ++i)
+            message.time |= static_cast<std::uint64_t>(buffer[1 + i]) << (8 * i);
+        message.value = buffer[9];
+        return message;
+    }
+
+    LoopbackTransport::LoopbackTransport(std::shared_ptr<Channel> incoming, std::shared_ptr<Channel> outgoing):
+        incoming_(incoming), outgoing_(outgoing)
+    {
+    }
+
+    LoopbackTransport::~LoopbackTransport()
+    {
+        std::lock_guard<std::mutex> lock(outgoing_->mutex);
+        outgoing_->closed = true;
+        outgoing_->condition.notify_all();
+    }
+
+    std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>> LoopbackTransport::CreatePair()
+    {
+        auto first = std::make_shared<Channel>();
+        auto second = std::make_shared<Channel>();
+        return { std::unique_ptr<LoopbackTransport>(new LoopbackTransport(first, second)), std::unique_ptr<LoopbackTransport>(new LoopbackTransport(second, first)) };
+    }
+
+    void LoopbackTransport::Send(const LinkMessage& message)
+    {
+        std::lock_guard<std::mutex> lock(outgoing_->mutex);
+        outgoing_->messages.push_back(message);
+        outgoing_->condition.notify_all();
+    }
+
+    bool LoopbackTransport::Receive(LinkMessage& message, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(incoming_->mutex);
+        if (!incoming_->condition.wait_for(lock, timeout, [this]() { return !incoming_->messages.empty() || incoming_->closed; }))
+            return false;
+
+        if (incoming_->messages.empty())
+            return false;
+
+        message = incoming_->messages.front();
+        incoming_->messages.pop_front();
+        return true;
+    }
+
+    bool LoopbackTransport::IsConnected() const
+    {
+        std::lock_guard<std::mutex> lock(incoming_->mutex);
+        return !incoming_->closed || !incoming_->messages.empty();
+    }
+
+#ifndef _WIN32
+    SocketTransport::SocketTransport(int socket): socket_(socket), connected_(true)
+    {
+    }
+
+    SocketTransport::~SocketTransport()
+    {
+        close(socket_);
+    }
+
+    std::unique_ptr<SocketTransport> SocketTransport::Listen(const std::string& path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            throw InvalidArgument("Socket path is too long");
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+        const int listen_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_socket < 0)
+            throw Exception("Failed to create socket");
+
+        unlink(path.c_str());
+        if (bind(listen_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listen_socket, 1) != 0)
+        {
+            close(listen_socket);
+            throw Exception("Failed to listen on socket");
+        }
+
+        const int connection = accept(listen_socket, nullptr, nullptr);
+        close(listen_socket);
+        unlink(path.c_str());
+        if (connection < 0)
+            throw Exception("Failed to accept connection");
+
+        return std::make_unique<SocketTransport>(connection);
+    }
+
+    std::unique_ptr<SocketTransport> SocketTransport::Connect(const std::string& path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            throw InvalidArgument("Socket path is too long");
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+        const int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connection < 0)
+            throw Exception("Failed to create socket");
+
+        if (connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            close(connection);
+            throw Exception("Failed to connect to socket");
+        }
+
+        return std::make_unique<SocketTransport>(connection);
+    }
+
+    std::pair<std::unique_ptr<SocketTransport>, std::unique_ptr<SocketTransport>> SocketTransport::CreatePair()
+    {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+            throw Exception("Failed to create socket pair");
+
+        return { std::make_unique<SocketTransport>(sockets[0]), std::make_unique<SocketTransport>(sockets[1]) };
+    }
+
+    void SocketTransport::Send(const LinkMessage& message)
+    {
+        if (!connected_)
+            return;
+
+        byte buffer[LinkMessage::Size];
+        message.Encode(buffer);
+
+        std::size_t sent = 0;
+        while (sent < sizeof(buffer))
+        {
+            const ssize_t result = send(socket_, buffer + sent, sizeof(buffer) - sent, MSG_NOSIGNAL);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+            {
+                connected_ = false;
+                return;
+            }
+            sent += static_cast<std::size_t>(result);
+        }
+    }
+
+    bool SocketTransport::Receive(LinkMessage& message, std::chrono::milliseconds timeout)
+    {
+        while (receive_buffer_.size() < LinkMessage::Size)
+        {
+            if (!connected_)
+                return false;
+
+            pollfd descriptor{ socket_, POLLIN, 0 };
+            if (poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0)
+                return false;
+
+            byte buffer[256];
+            const ssize_t result = recv(socket_, buffer, sizeof(buffer), 0);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return false;
+
+            // Only the end of the stream or a real error ends the connection
+            if (result <= 0)
+            {
+                connected_ = false;
+                return false;
+            }
+            receive_buffer_.insert(receive_buffer_.end(), buffer, buffer + result);
+        }
+
+        message = LinkMessage::Decode(receive_buffer_.data());
+        receive_buffer_.erase(receive_buffer_.begin(), receive_buffer_.begin() + LinkMessage::Size);
+        return true;
+    }
+#endif
+} // namespace gandalf
@@ -1,6 +1,10 @@
 #include <gandalf/memory.h>
 
+#include <gandalf/cartridge.h>
 #include <gandalf/exception.h>
+#include <gandalf/hram.h>
+#include <gandalf/lcd.h>
+#include <gandalf/wram.h>
 
 namespace gandalf {
   Memory::AddressHandler::AddressHandler(const std::string& name): name_(name) {
@@ -9,38 +13,111 @@ namespace gandalf {
 
   Memory::AddressHandler::~AddressHandler() = default;
 
-  Memory::Memory() {
+  word Memory::AddressHandler::GetBank(word) const {
+    return 0;
+  }
+
+  Memory::Memory(): watch_listener_(nullptr) {
     AddressWrapper w;
-    w.blocked = false;
+    w.flags = 0;
     w.handler = nullptr;
+    w.component = Component::Handler;
     address_space_.fill(w);
   }
 
   Memory::~Memory() = default;
 
+  inline void Memory::WriteHandler(const AddressWrapper& wrapper, word address, byte value) {
+    // The qualified calls are not virtual
+    switch (wrapper.component) {
+    case Component::Cartridge: static_cast<Cartridge*>(wrapper.handler)->Cartridge::Write(address, value); break;
+    case Component::HRAM: static_cast<HRAM*>(wrapper.handler)->HRAM::Write(address, value); break;
+    case Component::LCD: static_cast<LCD*>(wrapper.handler)->LCD::Write(address, value); break;
+    case Component::WRAM: static_cast<WRAM*>(wrapper.handler)->WRAM::Write(address, value); break;
+    case Component::Handler:
+      if (wrapper.handler != nullptr)
+        wrapper.handler->Write(address, value);
+      break;
+    }
+  }
+
+  inline byte Memory::ReadHandler(const AddressWrapper& wrapper, word address) const {
+    switch (wrapper.component) {
+    case Component::Cartridge: return static_cast<const Cartridge*>(wrapper.handler)->Cartridge::Read(address);
+    case Component::HRAM: return static_cast<const HRAM*>(wrapper.handler)->HRAM::Read(address);
+    case Component::LCD: return static_cast<const LCD*>(wrapper.handler)->LCD::Read(address);
+    case Component::WRAM: return static_cast<const WRAM*>(wrapper.handler)->WRAM::Read(address);
+    case Component::Handler: break;
+    }
+
+    return wrapper.handler != nullptr ? wrapper.handler->Read(address) : 0xFF;
+  }
+
   void Memory::Write(word address, byte value, bool check_access) {
-    if (check_access && address_space_[address].blocked) // TODO ?
+    const AddressWrapper& wrapper = address_space_[address];
+    if (wrapper.flags != 0) {
+      WriteSlow(address, value, check_access);
       return;
-
-    if (address_space_[address].handler != nullptr) {
-      address_space_[address].handler->Write(address, value);
     }
+
+    WriteHandler(wrapper, address, value);
   }
 
   byte Memory::Read(word address, bool check_access) const {
-    if (check_access && address_space_[address].blocked)
+    const AddressWrapper& wrapper = address_space_[address];
+    if (wrapper.flags != 0)
+      return ReadSlow(address, check_access);
+
+    return ReadHandler(wrapper, address);
+  }
+
+  void Memory::WriteSlow(word address, byte value, bool check_access) {
+    const AddressWrapper& wrapper = address_space_[address];
+    if (check_access && (wrapper.flags & BlockedFlag)) // TODO ?
+      return;
+
+    WriteHandler(wrapper, address, value);
+
+    if (check_access && (wrapper.flags & WatchWriteFlag) && watch_listener_)
+      watch_listener_->OnWatchpoint(address, value, true);
+  }
+
+  byte Memory::ReadSlow(word address, bool check_access) const {
+    const AddressWrapper& wrapper = address_space_[address];
+    if (check_access && (wrapper.flags & BlockedFlag))
       return 0xFF; // TODO this is not correct. It should return the value of the last read.
 
-    if (address_space_[address].handler != nullptr) {
-      return address_space_[address].handler->Read(address);
-    }
+    const byte value = ReadHandler(wrapper, address);
+    if (check_access && (wrapper.flags & WatchReadFlag) && watch_listener_)
+      watch_listener_->OnWatchpoint(address, value, false);
 
-    return 0xFF;
+    return value;
   }
 
   void Memory::Register(AddressHandler& handler) {
+    Register(handler, Component::Handler);
+  }
+
+  void Memory::Register(Cartridge& component) {
+    Register(component, Component::Cartridge);
+  }
+
+  void Memory::Register(HRAM& component) {
+    Register(component, Component::HRAM);
+  }
+
+  void Memory::Register(LCD& component) {
+    Register(component, Component::LCD);
+  }
+
+  void Memory::Register(WRAM& component) {
+    Register(component, Component::WRAM);
+  }
+
+  void Memory::Register(AddressHandler& handler, Component component) {
     for (const word address : handler.GetAddresses()) {
       address_space_[address].handler = &handler;
+      address_space_[address].component = component;
     }
   }
 
@@ -48,6 +125,21 @@ namespace gandalf {
   {
     for (const word address : handler.GetAddresses()) {
       address_space_[address].handler = nullptr;
+      address_space_[address].component = Component::Handler;
+    }
+  }
+
+  void Memory::Unregister(AddressHandler& handler, Cartridge& cartridge)
+  {
+    const std::set<word> cartridge_addresses = cartridge.GetAddresses();
+    for (const word address : handler.GetAddresses()) {
+      AddressWrapper& wrapper = address_space_[address];
+      if (wrapper.handler != &handler)
+        continue;
+
+      const bool cartridge_address = cartridge_addresses.count(address) > 0;
+      wrapper.handler = cartridge_address ? &cartridge : nullptr;
+      wrapper.component = cartridge_address ? Component::Cartridge : Component::Handler;
     }
   }
 
@@ -59,6 +151,14 @@ namespace gandalf {
     return address_space_[address].handler->GetName();
   }
 
+  word Memory::GetBank(word address) const
+  {
+    if (!address_space_[address].handler)
+      return 0;
+
+    return address_space_[address].handler->GetBank(address);
+  }
+
   Memory::Bus Memory::GetBus(word address)
   {
     if (address <= 0x7FFF)
@@ -78,21 +178,57 @@ namespace gandalf {
     switch (bus) {
     case Bus::External:
       for (std::uint32_t start = 0; start <= 0x7FFF; ++start)
-        address_space_[start].blocked = block;
+        SetFlag(start, BlockedFlag, block);
       for (std::uint32_t start = 0xA000; start <= 0xFDFF; ++start)
-        address_space_[start].blocked = block;
+        SetFlag(start, BlockedFlag, block);
       break;
     case Bus::VideoRAM:
       for (std::uint32_t start = 0x8000; start <= 0x9FFF; ++start)
-        address_space_[start].blocked = block;
+        SetFlag(start, BlockedFlag, block);
       break;
     case Bus::OAM:
       for (std::uint32_t start = 0xFE00; start <= 0xFE9F; ++start)
-        address_space_[start].blocked = block;
+        SetFlag(start, BlockedFlag, block);
       break;
     default:
       throw Exception("Invalid bus");
     }
   }
 
+  void Memory::SetFlag(word address, Flags flag, bool set)
+  {
+    if (set)
+      address_space_[address].flags |= flag;
+    else
+      address_space_[address].flags &= ~flag;
+  }
+
+  void Memory::SetWatchpoint(word address, bool read, bool write)
+  {
+    SetFlag(address, WatchReadFlag, read);
+    SetFlag(address, WatchWriteFlag, write);
+  }
+
+  void Memory::AddBreakpoint(word bank, word address)
+  {
+    breakpoints_.emplace(address, bank);
+    SetFlag(address, BreakpointFlag, true);
+  }
+
+  void Memory::RemoveBreakpoint(word bank, word address)
+  {
+    breakpoints_.erase(std::make_pair(address, bank));
+
+    const auto it = breakpoints_.lower_bound(std::make_pair(address, word(0)));
+    SetFlag(address, BreakpointFlag, it != breakpoints_.end() && it->first == address);
+  }
+
+  bool Memory::IsBreakpoint(word address) const
+  {
+    if (!HasBreakpoint(address))
+      return false;
+
+    return breakpoints_.count(std::make_pair(address, AnyBank)) > 0 || breakpoints_.count(std::make_pair(address, GetBank(address))) > 0;
+  }
+
 } // namespace gandalf
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include <gandalf/movie.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <gandalf/exception.h>
+
+namespace {
+    using namespace gandalf;
+
+    constexpr char kMagic[4] = { 'G', 'M', 'O', 'V' };
+    constexpr std::uint16_t kMovieVersion = 1;
+
+    void SerializeVarint(std::ostream& os, std::uint64_t value)
+    {
+        do {
+            byte b = value & 0x7F;
+            value >>= 7;
+            if (value != 0)
+                b |= 0x80;
+            serialization::Serialize(os, b);
+        } while (value != 0);
+    }
+
+    std::uint64_t DeserializeVarint(std::istream& is)
+    {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            byte b;
+            serialization::Deserialize(is, b);
+            value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return value;
+        }
+        throw SerializationException("Varint is too long");
+    }
+
+    byte GetButtons(const Joypad& joypad)
+    {
+        byte buttons = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (joypad.IsPressed(static_cast<Joypad::Button>(i)))
+                buttons |= 1 << i;
+        }
+        return buttons;
+    }
+}
+
+namespace gandalf {
+    Movie::Movie(): length_(0) {}
+
+    Movie::Movie(const std::string& state, const std::vector<Event>& events, std::uint64_t length): state_(state), events_(events), length_(length)
+    {
+        for (std::size_t i = 0; i < events_.size(); ++i)
+        {
+            if ((i > 0 && events_[i].cycle < events_[i - 1].cycle) || events_[i].cycle > length_)
+                throw InvalidArgument("The events are not in order or exceed the length of the movie");
+        }
+    }
+
+    Movie Movie::Load(std::istream& is)
+    {
+        char magic[sizeof(kMagic)];
+        if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic))
+            throw SerializationException("Not a movie file");
+
+        std::uint16_t version;
+        serialization::Deserialize(is, version);
+        if (version != kMovieVersion)
+            throw SerializationException("Unsupported movie version " + std::to_string(version));
+
+        const std::uint64_t state_size = DeserializeVarint(is);
+        std::string state;
+        // Read in chunks, so a corrupt size fails at the end of the stream instead of allocating
+        char buffer[4096];
+        while (state.size() < state_size)
+        {
+            const std::size_t chunk = static_cast<std::size_t>(std::min<std::uint64_t>(sizeof(buffer), state_size - state.size()));
+            if (!is.read(buffer, chunk))
+                throw SerializationException("Failed to read the save state of the movie");
+            state.append(buffer, chunk);
+        }
+
+        const std::uint64_t length = DeserializeVarint(is);
+        const std::uint64_t event_count = DeserializeVarint(is);
+        std::vector<Event> events;
+        std::uint64_t cycle = 0;
+        for (std::uint64_t i = 0; i < event_count; ++i)
+        {
+            const std::uint64_t delta = DeserializeVarint(is);
+            if (delta > length - cycle)
+                throw SerializationException("Movie event exceeds the length of the movie");
+
+            cycle += delta;
+            Event event{ cycle, 0 };
+            serialization::Deserialize(is, event.buttons);
+            events.push_back(event);
+        }
+
+        return Movie(state, events, length);
+    }
+
+    void Movie::Save(std::ostream& os) const
+    {
+        if (!os.write(kMagic, sizeof(kMagic)))
+            throw SerializationException("Failed to write the movie");
+
+        serialization::Serialize(os, kMovieVersion);
+        SerializeVarint(os, state_.size());
+        if (!os.write(state_.data(), state_.size()))
+            throw SerializationException("Failed to write the movie");
+
+        SerializeVarint(os, length_);
+        SerializeVarint(os, events_.size());
+        std::uint64_t cycle = 0;
+        for (const Event& event : events_)
+        {
+            SerializeVarint(os, event.cycle - cycle);
+            serialization::Serialize(os, event.buttons);
+            cycle = event.cycle;
+        }
+    }
+
+    MovieRecorder::MovieRecorder(Gameboy& gb): gb_(gb), start_cycles_(gb.GetCycleCount()), buttons_(GetButtons(gb.GetJoypad()))
+    {
+        std::ostringstream state;
+        if (!gb_.SaveState(state))
+            throw Exception("Failed to save the state at the start of the movie");
+
+        state_ = state.str();
+        gb_.SetJoypadListener(this);
+    }
+
+    MovieRecorder::~MovieRecorder()
+    {
+        gb_.SetJoypadListener(nullptr);
+    }
+
+    void MovieRecorder::OnButtonStateChanged(Joypad::Button button, bool pressed)
+    {
+        if (pressed)
+            buttons_ |= 1 << button;
+        else
+            buttons_ &= ~(1 << button);
+
+        events_.push_back(Movie::Event{ gb_.GetCycleCount() - start_cycles_, buttons_ });
+    }
+
+    Movie MovieRecorder::GetMovie() const
+    {
+        return Movie(state_, events_, gb_.GetCycleCount() - start_cycles_);
+    }
+
+    MoviePlayer::MoviePlayer(Gameboy& gb, const Movie& movie): gb_(gb), movie_(movie), next_event_(0)
+    {
+        std::istringstream state(movie_.GetState());
+        if (!gb_.LoadState(state))
+            throw Exception("Failed to load the state at the start of the movie");
+
+        start_cycles_ = gb_.GetCycleCount();
+        buttons_ = GetButtons(gb_.GetJoypad());
+    }
+
+    bool MoviePlayer::RunCycles(std::uint64_t cycles)
+    {
+        const std::uint64_t end = std::min(GetPosition() + cycles, movie_.GetLength());
+        const std::vector<Movie::Event>& events = movie_.GetEvents();
+        while (true)
+        {
+            ApplyEvents();
+
+            const std::uint64_t now = GetPosition();
+            if (now >= end)
+                return true;
+
+            // The instruction boundaries are the same as during the recording, so the run stops exactly at the cycle of the next event
+            std::uint64_t target = end;
+            if (next_event_ < events.size())
+                target = std::min(target, events[next_event_].cycle);
+
+            if (!gb_.RunCycles(target - now))
+                return false;
+        }
+    }
+
+    void MoviePlayer::ApplyEvents()
+    {
+        const std::vector<Movie::Event>& events = movie_.GetEvents();
+        for (; next_event_ < events.size() && events[next_event_].cycle <= GetPosition(); ++next_event_)
+        {
+            const byte changed = buttons_ ^ events[next_event_].buttons;
+            buttons_ = events[next_event_].buttons;
+            for (int i = 0; i < 8; ++i)
+            {
+                if (changed & (1 << i))
+                    gb_.SetButtonState(static_cast<Joypad::Button>(i), buttons_ & (1 << i));
+            }
+        }
+    }
+} // namespace gandalf
@@ -0,0 +1,33 @@
+#include <gandalf/observation.h>
+
+#include <gandalf/exception.h>
+
+namespace gandalf {
+    void PackColorIndices(const byte* indices, byte* output, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            *output++ = static_cast<byte>(((indices[i] & 3) << 6) | ((indices[i + 1] & 3) << 4) | ((indices[i + 2] & 3) << 2) | (indices[i + 3] & 3));
+
+        if (i < count)
+        {
+            byte last = 0;
+            for (int shift = 6; i < count; ++i, shift -= 2)
+                last |= static_cast<byte>((indices[i] & 3) << shift);
+            *output = last;
+        }
+    }
+
+    void DownsampleColorIndices(const Observation& observation, int factor, byte* output)
+    {
+        if (factor <= 0 || ScreenWidth % factor != 0 || ScreenHeight % factor != 0)
+            throw InvalidArgument("Downsampling factor must divide the screen size");
+
+        for (int y = 0; y < ScreenHeight; y += factor)
+        {
+            const byte* row = observation.color_indices.data() + y * ScreenWidth;
+            for (int x = 0; x < ScreenWidth; x += factor)
+                *output++ = row[x];
+        }
+    }
+} // namespace gandalf
@@ -0,0 +1,158 @@
+#include <gandalf/perf_counters.h>
+
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+// The intrinsics are only included here, so that embedders of the library do not get them through the public headers
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GANDALF_HAS_RDTSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define GANDALF_HAS_RDTSC
+#endif
+
+namespace {
+    constexpr std::size_t kDefaultMaxFrames = 600;
+
+    double MeasureTicksPerSecond()
+    {
+#ifdef GANDALF_HAS_RDTSC
+        // The time stamp counter frequency is not exposed by the OS, so it is measured against the steady clock.
+        const auto start_time = std::chrono::steady_clock::now();
+        const std::uint64_t start_ticks = gandalf::PerfClock::Now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const std::uint64_t end_ticks = gandalf::PerfClock::Now();
+        const auto end_time = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(end_time - start_time).count();
+        return static_cast<double>(end_ticks - start_ticks) / seconds;
+#else
+        return 1e9;
+#endif
+    }
+}
+
+namespace gandalf {
+    std::uint64_t PerfClock::Now()
+    {
+#ifdef GANDALF_HAS_RDTSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    double PerfClock::GetTicksPerSecond()
+    {
+        static const double ticks_per_second = MeasureTicksPerSecond();
+        return ticks_per_second;
+    }
+
+    PerfCounters::PerfCounters(): max_frames_(kDefaultMaxFrames)
+    {
+        Reset();
+    }
+
+    PerfCounters::~PerfCounters() = default;
+
+    void PerfCounters::Reset()
+    {
+        ticks_.fill(0);
+        calls_.fill(0);
+        current_ = Component::None;
+        last_timestamp_ = PerfClock::Now();
+
+        frames_.clear();
+        frame_start_ = last_timestamp_;
+        frame_start_ticks_.fill(0);
+    }
+
+    void PerfCounters::EndFrame()
+    {
+        // Account the time of the active component up to now to the frame that ends.
+        Switch(current_);
+
+        Frame frame;
+        frame.start = frame_start_;
+        frame.end = last_timestamp_;
+        for (std::size_t i = 0; i < ComponentCount; ++i)
+            frame.ticks[i] = ticks_[i] - frame_start_ticks_[i];
+
+        frames_.push_back(frame);
+        while (frames_.size() > max_frames_)
+            frames_.pop_front();
+
+        frame_start_ = last_timestamp_;
+        frame_start_ticks_ = ticks_;
+    }
+
+    void PerfCounters::SetMaxFrames(std::size_t max_frames)
+    {
+        max_frames_ = max_frames;
+        while (frames_.size() > max_frames_)
+            frames_.pop_front();
+    }
+
+    double PerfCounters::GetSeconds(Component component) const
+    {
+        return static_cast<double>(GetTicks(component)) / PerfClock::GetTicksPerSecond();
+    }
+
+    const char* PerfCounters::GetComponentName(Component component)
+    {
+        switch (component)
+        {
+        case Component::CPU: return "CPU";
+        case Component::Memory: return "Memory";
+        case Component::Timer: return "Timer";
+        case Component::PPU: return "PPU";
+        case Component::APU: return "APU";
+        case Component::DMA: return "DMA";
+        case Component::HDMA: return "HDMA";
+        default: return "None";
+        }
+    }
+
+    void PerfCounters::WriteChromeTrace(std::ostream& os) const
+    {
+        const double ticks_per_us = PerfClock::GetTicksPerSecond() / 1e6;
+        const std::uint64_t origin = frames_.empty() ? 0 : frames_.front().start;
+        const auto to_us = [ticks_per_us](std::uint64_t ticks) { return static_cast<double>(ticks) / ticks_per_us; };
+
+        const std::ios_base::fmtflags flags(os.flags());
+        const std::streamsize precision = os.precision();
+        os << std::fixed << std::setprecision(3);
+
+        // Track 0 contains the frames, the components are shown on tracks 1 to ComponentCount.
+        os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Frame\"}}";
+        for (std::size_t i = 0; i < ComponentCount; ++i)
+        {
+            os << ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i + 1
+                << ",\"args\":{\"name\":\"" << GetComponentName(static_cast<Component>(i)) << "\"}}";
+        }
+
+        std::size_t frame_number = 0;
+        for (const Frame& frame : frames_)
+        {
+            const double start = to_us(frame.start - origin);
+            os << ",{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":" << start << ",\"dur\":" << to_us(frame.end - frame.start)
+                << ",\"args\":{\"frame\":" << frame_number << "}}";
+
+            for (std::size_t i = 0; i < ComponentCount; ++i)
+            {
+                if (frame.ticks[i] == 0)
+                    continue;
+                os << ",{\"name\":\"" << GetComponentName(static_cast<Component>(i)) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << i + 1
+                    << ",\"ts\":" << start << ",\"dur\":" << to_us(frame.ticks[i]) << "}";
+            }
+            ++frame_number;
+        }
+        os << "]}" << std::endl;
+
+        os.flags(flags);
+        os.precision(precision);
+    }
+} // namespace gandalf
@@ -0,0 +1,221 @@
+#include <gandalf/pixel_format.h>
+
+#include <cstring>
+
+#include <gandalf/exception.h>
+
+#include "simd.h"
+
+namespace {
+    using gandalf::byte;
+    using gandalf::LCD;
+
+    constexpr std::size_t kPixelCount = gandalf::ScreenWidth * gandalf::ScreenHeight;
+    constexpr std::size_t kChromaPlaneSize = (gandalf::ScreenWidth / 2) * (gandalf::ScreenHeight / 2);
+
+    // Luma coefficients in 1/256 units, BT.601
+    struct LumaCoefficients {
+        std::uint16_t r, g, b, offset;
+    };
+    constexpr LumaCoefficients kFullRangeLuma = { 77, 150, 29, 0 };
+    constexpr LumaCoefficients kVideoRangeLuma = { 66, 129, 25, 16 };
+
+    // Expands a 5 bit color channel to 8 bits, such that 0x1F becomes 0xFF
+    inline unsigned int Expand5(unsigned int value)
+    {
+        return (value << 3) | (value >> 2);
+    }
+
+    inline void Unpack(LCD::ABGR1555 pixel, unsigned int& r, unsigned int& g, unsigned int& b)
+    {
+        r = Expand5(pixel & 0x1F);
+        g = Expand5((pixel >> 5) & 0x1F);
+        b = Expand5((pixel >> 10) & 0x1F);
+    }
+
+    inline byte GetLuma(LCD::ABGR1555 pixel, const LumaCoefficients& coefficients)
+    {
+        unsigned int r, g, b;
+        Unpack(pixel, r, g, b);
+        return static_cast<byte>(((coefficients.r * r + coefficients.g * g + coefficients.b * b + 128) >> 8) + coefficients.offset);
+    }
+
+#if defined(GANDALF_SIMD_SSE2)
+    constexpr std::size_t kVectorWidth = 8;
+
+    inline void UnpackVector(const LCD::ABGR1555* input, __m128i& r, __m128i& g, __m128i& b)
+    {
+        const __m128i mask = _mm_set1_epi16(0x1F);
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+        r = _mm_and_si128(pixels, mask);
+        g = _mm_and_si128(_mm_srli_epi16(pixels, 5), mask);
+        b = _mm_and_si128(_mm_srli_epi16(pixels, 10), mask);
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+    }
+
+    void ConvertToRGBA8888Vector(const LCD::ABGR1555* input, byte* output)
+    {
+        __m128i r, g, b;
+        UnpackVector(input, r, g, b);
+        const __m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+        const __m128i ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_set1_epi8(-1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+
+    void ConvertToLumaVector(const LCD::ABGR1555* input, byte* output, const LumaCoefficients& coefficients)
+    {
+        __m128i r, g, b;
+        UnpackVector(input, r, g, b);
+        // The sum is at most 256 * 255 + 128, so it fits in an unsigned 16 bit lane
+        __m128i sum = _mm_mullo_epi16(r, _mm_set1_epi16(static_cast<short>(coefficients.r)));
+        sum = _mm_add_epi16(sum, _mm_mullo_epi16(g, _mm_set1_epi16(static_cast<short>(coefficients.g))));
+        sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi16(static_cast<short>(coefficients.b))));
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+        sum = _mm_add_epi16(sum, _mm_set1_epi16(static_cast<short>(coefficients.offset)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(sum, sum));
+    }
+#elif defined(GANDALF_SIMD_NEON)
+    constexpr std::size_t kVectorWidth = 8;
+
+    inline void UnpackVector(const LCD::ABGR1555* input, uint16x8_t& r, uint16x8_t& g, uint16x8_t& b)
+    {
+        const uint16x8_t mask = vdupq_n_u16(0x1F);
+        const uint16x8_t pixels = vld1q_u16(input);
+        r = vandq_u16(pixels, mask);
+        g = vandq_u16(vshrq_n_u16(pixels, 5), mask);
+        b = vandq_u16(vshrq_n_u16(pixels, 10), mask);
+        r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+        g = vorrq_u16(vshlq_n_u16(g, 3), vshrq_n_u16(g, 2));
+        b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+    }
+
+    void ConvertToRGBA8888Vector(const LCD::ABGR1555* input, byte* output)
+    {
+        uint16x8_t r, g, b;
+        UnpackVector(input, r, g, b);
+        uint8x8x4_t rgba;
+        rgba.val[0] = vmovn_u16(r);
+        rgba.val[1] = vmovn_u16(g);
+        rgba.val[2] = vmovn_u16(b);
+        rgba.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(output, rgba);
+    }
+
+    void ConvertToLumaVector(const LCD::ABGR1555* input, byte* output, const LumaCoefficients& coefficients)
+    {
+        uint16x8_t r, g, b;
+        UnpackVector(input, r, g, b);
+        uint16x8_t sum = vmulq_n_u16(r, coefficients.r);
+        sum = vmlaq_n_u16(sum, g, coefficients.g);
+        sum = vmlaq_n_u16(sum, b, coefficients.b);
+        sum = vshrq_n_u16(vaddq_u16(sum, vdupq_n_u16(128)), 8);
+        sum = vaddq_u16(sum, vdupq_n_u16(coefficients.offset));
+        vst1_u8(output, vmovn_u16(sum));
+    }
+#endif
+
+    void ConvertToLuma(const LCD::ABGR1555* input, byte* output, std::size_t count, const LumaCoefficients& coefficients)
+    {
+        std::size_t i = 0;
+#if defined(GANDALF_SIMD_SSE2) || defined(GANDALF_SIMD_NEON)
+        for (const std::size_t vector_count = count - count % kVectorWidth; i < vector_count; i += kVectorWidth)
+            ConvertToLumaVector(input + i, output + i, coefficients);
+#endif
+        for (; i < count; ++i)
+            output[i] = GetLuma(input[i], coefficients);
+    }
+
+    // The chroma planes are subsampled by averaging every 2x2 block, which is a small part of the work so it is not vectorized
+    void ConvertToChroma(const LCD::VideoBuffer& frame, byte* u_plane, byte* v_plane)
+    {
+        for (int y = 0; y < gandalf::ScreenHeight; y += 2)
+        {
+            for (int x = 0; x < gandalf::ScreenWidth; x += 2)
+            {
+                int r = 0, g = 0, b = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    unsigned int pixel_r, pixel_g, pixel_b;
+                    Unpack(frame[(y + i / 2) * gandalf::ScreenWidth + x + i % 2], pixel_r, pixel_g, pixel_b);
+                    r += pixel_r;
+                    g += pixel_g;
+                    b += pixel_b;
+                }
+                r = (r + 2) / 4;
+                g = (g + 2) / 4;
+                b = (b + 2) / 4;
+
+                const std::size_t index = (y / 2) * (gandalf::ScreenWidth / 2) + x / 2;
+                u_plane[index] = static_cast<byte>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+                v_plane[index] = static_cast<byte>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+            }
+        }
+    }
+}
+
+namespace gandalf {
+    std::size_t GetFrameSize(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PixelFormat::ABGR1555:
+            return kPixelCount * sizeof(LCD::ABGR1555);
+        case PixelFormat::RGBA8888:
+            return kPixelCount * 4;
+        case PixelFormat::Grayscale8:
+            return kPixelCount;
+        case PixelFormat::YUV420:
+            return kPixelCount + 2 * kChromaPlaneSize;
+        default:
+            throw InvalidArgument("Invalid pixel format");
+        }
+    }
+
+    void ConvertFrame(const LCD::VideoBuffer& frame, PixelFormat format, byte* output)
+    {
+        switch (format)
+        {
+        case PixelFormat::ABGR1555:
+            std::memcpy(output, frame.data(), GetFrameSize(format));
+            break;
+        case PixelFormat::RGBA8888:
+            ConvertToRGBA8888(frame.data(), output, frame.size());
+            break;
+        case PixelFormat::Grayscale8:
+            ConvertToGrayscale8(frame.data(), output, frame.size());
+            break;
+        case PixelFormat::YUV420:
+            ConvertToLuma(frame.data(), output, frame.size(), kVideoRangeLuma);
+            ConvertToChroma(frame, output + kPixelCount, output + kPixelCount + kChromaPlaneSize);
+            break;
+        default:
+            throw InvalidArgument("Invalid pixel format");
+        }
+    }
+
+    void ConvertToRGBA8888(const LCD::ABGR1555* input, byte* output, std::size_t count)
+    {
+        std::size_t i = 0;
+#if defined(GANDALF_SIMD_SSE2) || defined(GANDALF_SIMD_NEON)
+        for (const std::size_t vector_count = count - count % kVectorWidth; i < vector_count; i += kVectorWidth)
+            ConvertToRGBA8888Vector(input + i, output + 4 * i);
+#endif
+        for (; i < count; ++i)
+        {
+            unsigned int r, g, b;
+            Unpack(input[i], r, g, b);
+            output[4 * i] = static_cast<byte>(r);
+            output[4 * i + 1] = static_cast<byte>(g);
+            output[4 * i + 2] = static_cast<byte>(b);
+            output[4 * i + 3] = 0xFF;
+        }
+    }
+
+    void ConvertToGrayscale8(const LCD::ABGR1555* input, byte* output, std::size_t count)
+    {
+        ConvertToLuma(input, output, count, kFullRangeLuma);
+    }
+} // namespace gandalf
@@ -0,0 +1,123 @@
+#include <gandalf/pixel_kernels.h>
+
+#include "simd.h"
+
+namespace {
+    using gandalf::byte;
+
+    void DecodeTileRow(byte low, byte high, bool flip_x, byte* output)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            const int bit = flip_x ? i : 7 - i;
+            output[i] = static_cast<byte>(((low >> bit) & 1) | (((high >> bit) & 1) << 1));
+        }
+    }
+}
+
+namespace gandalf {
+    namespace kernels {
+        void DecodeTileRows(const byte* data, std::size_t rows, bool flip_x, byte* output)
+        {
+            std::size_t row = 0;
+#if defined(GANDALF_SIMD_SSE2)
+            // Two rows per iteration: every byte is broadcast to 8 lanes and each lane tests its own bit
+            const __m128i mask = flip_x ? _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1)
+                : _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+            for (; row + 2 <= rows; row += 2)
+            {
+                const byte* row_data = data + row * 2;
+                const __m128i low = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(row_data[0])), _mm_set1_epi8(static_cast<char>(row_data[2])));
+                const __m128i high = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(row_data[1])), _mm_set1_epi8(static_cast<char>(row_data[3])));
+                const __m128i low_bits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(low, mask), mask), _mm_set1_epi8(1));
+                const __m128i high_bits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(high, mask), mask), _mm_set1_epi8(2));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + row * 8), _mm_or_si128(low_bits, high_bits));
+            }
+#elif defined(GANDALF_SIMD_NEON)
+            static const byte kNormalMask[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+            static const byte kFlippedMask[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+            const uint8x8_t mask = vld1_u8(flip_x ? kFlippedMask : kNormalMask);
+            for (; row < rows; ++row)
+            {
+                const uint8x8_t low_bits = vand_u8(vtst_u8(vdup_n_u8(data[row * 2]), mask), vdup_n_u8(1));
+                const uint8x8_t high_bits = vand_u8(vtst_u8(vdup_n_u8(data[row * 2 + 1]), mask), vdup_n_u8(2));
+                vst1_u8(output + row * 8, vorr_u8(low_bits, high_bits));
+            }
+#endif
+            for (; row < rows; ++row)
+                DecodeTileRow(data[row * 2], data[row * 2 + 1], flip_x, output + row * 8);
+        }
+
+        void MergeSprites(const byte* background, const byte* sprite, const byte* sprite_behind, byte* output, byte* from_sprite, std::size_t count)
+        {
+            std::size_t i = 0;
+#if defined(GANDALF_SIMD_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            for (const std::size_t vector_count = count - count % 16; i < vector_count; i += 16)
+            {
+                const __m128i background_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(background + i));
+                const __m128i sprite_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sprite + i));
+                const __m128i behind = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sprite_behind + i));
+
+                // hidden = sprite transparent || (behind && background not transparent)
+                const __m128i background_visible = _mm_andnot_si128(_mm_cmpeq_epi8(background_pixels, zero), _mm_set1_epi8(-1));
+                const __m128i covered = _mm_andnot_si128(_mm_cmpeq_epi8(behind, zero), background_visible);
+                const __m128i show = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi8(sprite_pixels, zero), covered), _mm_set1_epi8(-1));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_or_si128(_mm_and_si128(show, sprite_pixels), _mm_andnot_si128(show, background_pixels)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(from_sprite + i), _mm_and_si128(show, _mm_set1_epi8(1)));
+            }
+#elif defined(GANDALF_SIMD_NEON)
+            for (const std::size_t vector_count = count - count % 16; i < vector_count; i += 16)
+            {
+                const uint8x16_t background_pixels = vld1q_u8(background + i);
+                const uint8x16_t sprite_pixels = vld1q_u8(sprite + i);
+                const uint8x16_t behind = vld1q_u8(sprite_behind + i);
+
+                const uint8x16_t covered = vandq_u8(vtstq_u8(behind, behind), vtstq_u8(background_pixels, background_pixels));
+                const uint8x16_t show = vbicq_u8(vtstq_u8(sprite_pixels, sprite_pixels), covered);
+
+                vst1q_u8(output + i, vbslq_u8(show, sprite_pixels, background_pixels));
+                vst1q_u8(from_sprite + i, vandq_u8(show, vdupq_n_u8(1)));
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                const bool show = sprite[i] != 0 && !(sprite_behind[i] != 0 && background[i] != 0);
+                output[i] = show ? sprite[i] : background[i];
+                from_sprite[i] = show ? 1 : 0;
+            }
+        }
+
+        void ApplyPalette(const byte* indices, const LCD::ABGR1555* palette, LCD::ABGR1555* output, std::size_t count)
+        {
+            std::size_t i = 0;
+#if defined(GANDALF_SIMD_SSE2)
+            // SSE2 has no byte shuffle, with only 4 colors a compare and select per color is cheap enough
+            for (const std::size_t vector_count = count - count % 8; i < vector_count; i += 8)
+            {
+                const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i));
+                const __m128i index = _mm_and_si128(_mm_unpacklo_epi8(bytes, _mm_setzero_si128()), _mm_set1_epi16(3));
+                __m128i colors = _mm_setzero_si128();
+                for (int color = 0; color < 4; ++color)
+                {
+                    const __m128i match = _mm_cmpeq_epi16(index, _mm_set1_epi16(static_cast<short>(color)));
+                    colors = _mm_or_si128(colors, _mm_and_si128(match, _mm_set1_epi16(static_cast<short>(palette[color]))));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), colors);
+            }
+#elif defined(GANDALF_SIMD_NEON)
+            for (const std::size_t vector_count = count - count % 8; i < vector_count; i += 8)
+            {
+                const uint16x8_t index = vandq_u16(vmovl_u8(vld1_u8(indices + i)), vdupq_n_u16(3));
+                uint16x8_t colors = vdupq_n_u16(palette[0]);
+                for (int color = 1; color < 4; ++color)
+                    colors = vbslq_u16(vceqq_u16(index, vdupq_n_u16(static_cast<std::uint16_t>(color))), vdupq_n_u16(palette[color]), colors);
+                vst1q_u16(output + i, colors);
+            }
+#endif
+            for (; i < count; ++i)
+                output[i] = palette[indices[i] & 3];
+        }
+    } // namespace kernels
+} // namespace gandalf
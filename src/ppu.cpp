@@ -30,6 +30,8 @@ namespace gandalf {
         line_ticks_(0),
         stat_interrupt_line_(0),
         mode_(mode),
+        vram_(),
+        tile_cache_(vram_),
         current_vram_bank_(0),
         opri_(0),
         pipeline_(mode, lcd_, vram_, fetched_sprites_)
@@ -59,7 +61,9 @@ namespace gandalf {
         {
             UpdateStatInterruptLine(kStatBitModeOAM, true); // This bit also triggers an interrupt when VBlank starts
 
+            // The frame is published first, so that the listeners see the completed frame and its hashes
             memory_.Write(address::IF, memory_.Read(address::IF) | VBlankInterruptMask);
+            lcd_.PublishFrame();
             for (auto listener : vblank_listeners_)
                 listener->OnVBlank();
         }
@@ -67,6 +71,23 @@ namespace gandalf {
         lcd_.SetMode(mode);
     }
 
+    void PPU::Tick()
+    {
+        switch (mode_)
+        {
+        case GameboyMode::DMG:
+            Tick<GameboyMode::DMG>();
+            break;
+        case GameboyMode::DMGCompatibility:
+            Tick<GameboyMode::DMGCompatibility>();
+            break;
+        case GameboyMode::CGB:
+            Tick<GameboyMode::CGB>();
+            break;
+        }
+    }
+
+    template <GameboyMode mode>
     void PPU::Tick()
     {
         if ((lcd_.GetLCDControl() & 0x80) == 0)
@@ -74,9 +95,7 @@ namespace gandalf {
         // TODO: block access to vram/oam/palettes
         ++line_ticks_;
 
-        const LCD::Mode mode = lcd_.GetMode();
-
-        switch (mode)
+        switch (lcd_.GetMode())
         {
         case LCD::Mode::OamSearch:
         {
@@ -105,7 +124,7 @@ namespace gandalf {
         }
         break;
         case LCD::Mode::PixelTransfer:
-            pipeline_.Process();
+            pipeline_.Process<mode>();
 
             if (pipeline_.Done()) {
                 //assert(BETWEEN(line_ticks_, 172 + 80, 289 + 80)); TODO
@@ -208,7 +227,10 @@ namespace gandalf {
 
         // TODO only accessible during certain modes
         if (address >= 0x8000 && address < 0xA000)
+        {
             vram_[current_vram_bank_][address - 0x8000] = value;
+            tile_cache_.Invalidate(current_vram_bank_, address - 0x8000);
+        }
         else if (address >= 0xFE00 && address < 0xFEA0)
             oam_[address - 0xFE00] = value;
         else if (mode_ != GameboyMode::DMG && address == address::VBK)
@@ -246,18 +268,21 @@ namespace gandalf {
         serialization::Serialize(os, opri_);
         serialization::Serialize(os, oam_);
         serialization::Serialize(os, fetched_sprites_);
+        pipeline_.Serialize(os);
     }
 
-    void PPU::Deserialize(std::istream& is, std::uint16_t)
+    void PPU::Deserialize(std::istream& is, std::uint16_t version)
     {
         serialization::Deserialize(is, line_ticks_);
         serialization::Deserialize(is, stat_interrupt_line_);
         serialization::Deserialize(is, reinterpret_cast<byte&>(mode_));
         serialization::Deserialize(is, vram_);
+        tile_cache_.InvalidateAll();
         serialization::Deserialize(is, current_vram_bank_);
         serialization::Deserialize(is, opri_);
         serialization::Deserialize(is, oam_);
         serialization::Deserialize(is, fetched_sprites_);
+        pipeline_.Deserialize(is, version);
     }
 
     void PPU::Sprite::Serialize(std::ostream& os) const
@@ -381,6 +406,7 @@ namespace gandalf {
         return pixels_pushed_ == ScreenWidth && fetcher_state_ == FetcherState::FetchTileSleep;
     }
 
+    template <GameboyMode mode>
     void PPU::Pipeline::Process()
     {
         // TODO we only need to check once x increases after this check fails, but for now this is easier
@@ -407,15 +433,16 @@ namespace gandalf {
 
         const bool sprite_was_in_progress = sprite_in_progress_;
         if (!sprite_in_progress_ || fetcher_state_ != FetcherState::Push || background_fifo_.empty())
-            TileStateMachine();
+            TileStateMachine<mode>();
         else {
-            SpriteStateMachine();
+            SpriteStateMachine<mode>();
         }
 
         if (!sprite_was_in_progress)
-            RenderPixel();
+            RenderPixel<mode>();
     }
 
+    template <GameboyMode mode>
     void PPU::Pipeline::TileStateMachine()
     {
         switch (fetcher_state_)
@@ -430,7 +457,7 @@ namespace gandalf {
             const word tile_address = tile_map_offset + (fetch_y_ / 8 * 32) + fetch_x_;
             tile_number_ = vram_[0].at(tile_address);
 
-            if (mode_ == GameboyMode::CGB)
+            if constexpr (mode == GameboyMode::CGB)
                 tile_attributes_ = vram_[1].at(tile_address);
             fetcher_state_ = FetcherState::FetchDataLowSleep;
             break;
@@ -446,10 +473,10 @@ namespace gandalf {
             int tile_offset = (tile_data_select ? tile_number_ : (signed_byte)(tile_number_));
             tile_offset *= 16;
             byte line = fetch_y_ % 8;
-            if (mode_ == GameboyMode::CGB && (tile_attributes_ & 0x40) != 0) // Horizontal flip
+            if (mode == GameboyMode::CGB && (tile_attributes_ & 0x40) != 0) // Horizontal flip
                 line = 7 - line;
             const int total_offset = tile_base_address + tile_offset + (line * 2);
-            tile_data_low_ = vram_[mode_ == GameboyMode::CGB ? (tile_attributes_ >> 3) & 0x1 : 0].at(total_offset);
+            tile_data_low_ = vram_[mode == GameboyMode::CGB ? (tile_attributes_ >> 3) & 0x1 : 0].at(total_offset);
             fetcher_state_ = FetcherState::FetchDataHighSleep;
         }
         break;
@@ -462,21 +489,22 @@ namespace gandalf {
             const word tile_base_address = tile_data_select ? 0 : 0x1000;
             const int tile_offset = (tile_data_select ? tile_number_ : (signed_byte)(tile_number_)) * 16;
             byte line = fetch_y_ % 8;
-            if (mode_ == GameboyMode::CGB && (tile_attributes_ & 0x40) != 0) // Horizontal flip
+            if (mode == GameboyMode::CGB && (tile_attributes_ & 0x40) != 0) // Horizontal flip
                 line = 7 - line;
             const int total_offset = tile_base_address + tile_offset + (line * 2 + 1);
-            tile_data_high_ = vram_[mode_ == GameboyMode::CGB ? (tile_attributes_ >> 3) & 0x1 : 0].at(total_offset);
+            tile_data_high_ = vram_[mode == GameboyMode::CGB ? (tile_attributes_ >> 3) & 0x1 : 0].at(total_offset);
             fetcher_state_ = FetcherState::Push;
 
-            TryPush();
+            TryPush<mode>();
             break;
         }
         case FetcherState::Push:
-            TryPush();
+            TryPush<mode>();
             break;
         }
     }
 
+    template <GameboyMode mode>
     void PPU::Pipeline::SpriteStateMachine()
     {
         switch (sprite_state_)
@@ -502,7 +530,7 @@ namespace gandalf {
             const bool flip_y = current_sprite_.attributes & 0x40;
             sprite_line_ = flip_y ? sprite_height - 1 - (lcd_.GetLY() + 16 - current_sprite_.y) : lcd_.GetLY() + 16 - current_sprite_.y;
 
-            current_sprite_.tile_data_low = vram_[mode_ == GameboyMode::CGB ? (current_sprite_.attributes >> 3) & 0x1 : 0][current_sprite_.tile_index * 16 + sprite_line_ * 2];
+            current_sprite_.tile_data_low = vram_[mode == GameboyMode::CGB ? (current_sprite_.attributes >> 3) & 0x1 : 0][current_sprite_.tile_index * 16 + sprite_line_ * 2];
             sprite_state_ = SpriteState::ReadDataHighSleep;
             break;
         }
@@ -510,13 +538,14 @@ namespace gandalf {
             sprite_state_ = SpriteState::ReadDataHigh;
             break;
         case SpriteState::ReadDataHigh:
-            current_sprite_.tile_data_high = vram_[mode_ == GameboyMode::CGB ? (current_sprite_.attributes >> 3) & 0x1 : 0][current_sprite_.tile_index * 16 + sprite_line_ * 2 + 1];
+            current_sprite_.tile_data_high = vram_[mode == GameboyMode::CGB ? (current_sprite_.attributes >> 3) & 0x1 : 0][current_sprite_.tile_index * 16 + sprite_line_ * 2 + 1];
             sprite_in_progress_ = false;
-            PushSprite();
+            PushSprite<mode>();
             break;
         }
     }
 
+    template <GameboyMode mode>
     void PPU::Pipeline::PushSprite()
     {
         const bool flip_x = current_sprite_.attributes & 0x20;
@@ -529,25 +558,25 @@ namespace gandalf {
                 sprite_fifo_.push_back(Pixel(0, 0, 0, 0));
         }
 
+        byte colors[8];
+        TileCache::DecodeLine(current_sprite_.tile_data_low, current_sprite_.tile_data_high, flip_x, colors);
         for (int i = 0; i < 8; ++i)
         {
-            byte color_bit_0 = flip_x ? !!((current_sprite_.tile_data_low) & (1 << i)) : !!(current_sprite_.tile_data_low & (1 << (7 - i)));
-            byte color_bit_1 = flip_x ? !!((current_sprite_.tile_data_high) & (1 << i)) : !!(current_sprite_.tile_data_high & (1 << (7 - i)));
-            byte color = color_bit_0 | (color_bit_1 << 1);
+            const byte color = colors[i];
 
             if (color == 0) // New pixel is transparent, do not replace existing pixel
                 continue;
 
             Pixel& pixel = sprite_fifo_.at(i);
             // In DMG mode, only replace pixel if it is transparent
-            if (mode_ != GameboyMode::CGB && pixel.color == 0)
+            if (mode != GameboyMode::CGB && pixel.color == 0)
             {
                 pixel.background_priority = !!(current_sprite_.attributes & 0x80);
                 pixel.color = color;
                 pixel.palette = (current_sprite_.attributes & 0b10000) >> 4;
             }
             // In CGB mode, replace pixel when it is transparent OR the current sprite has higher priority (lower OAM index)
-            else if (mode_ == GameboyMode::CGB && (pixel.color == 0 || current_sprite_.oam_index < pixel.sprite_priority))
+            else if (mode == GameboyMode::CGB && (pixel.color == 0 || current_sprite_.oam_index < pixel.sprite_priority))
             {
                 pixel.background_priority = !!(current_sprite_.attributes & 0x80);
                 pixel.color = color;
@@ -558,6 +587,7 @@ namespace gandalf {
     }
 
 
+    template <GameboyMode mode>
     void PPU::Pipeline::TryPush()
     {
         if (pixels_pushed_ == 160) {
@@ -566,21 +596,18 @@ namespace gandalf {
         }
 
         if (background_fifo_.size() <= 8) {
+            const bool flip_x = mode == GameboyMode::CGB ? (tile_attributes_ & 0b00100000) != 0 : false;
+            const byte palette = (mode == GameboyMode::CGB) ? tile_attributes_ & 0x7 : 0;
+            byte colors[8];
+            TileCache::DecodeLine(tile_data_low_, tile_data_high_, flip_x, colors);
             for (byte i = 0; i < 8; ++i)
-            {
-                const bool flip_x = mode_ == GameboyMode::CGB ? (tile_attributes_ & 0b00100000) != 0 : false;
-                byte color_bit_0 = flip_x ? !!((tile_data_low_) & (1 << i)) : !!(tile_data_low_ & (1 << (7 - i)));
-                byte color_bit_1 = flip_x ? !!((tile_data_high_) & (1 << i)) : !!(tile_data_high_ & (1 << (7 - i)));
-                byte color = color_bit_0 | (color_bit_1 << 1);
-                byte palette = (mode_ == GameboyMode::CGB) ? tile_attributes_ & 0x7 : 0;
-
-                background_fifo_.push_back(Pixel(color, palette, false, 0));
-            }
+                background_fifo_.push_back(Pixel(colors[i], palette, false, 0));
             fetch_x_ = (fetch_x_ + 1) & 0x1F;
             fetcher_state_ = FetcherState::FetchTileSleep;
         }
     }
 
+    template <GameboyMode mode>
     void PPU::Pipeline::RenderPixel()
     {
         if (drop_pixels_ > 0 && !background_fifo_.empty()) {
@@ -613,10 +640,14 @@ namespace gandalf {
          * 2. The sprite pixel is transparent (color 0)
          * 3. The background pixel is not transparent and the sprite pixel gives the background pixel priority (bit 7 of sprite attributes is set) */
         if (sprite_pixel.color == 0 || (sprite_pixel.background_priority && background_pixel.color != 0))
-            lcd_.RenderPixel(pixels_pushed_, background_pixel.color, false, mode_ == GameboyMode::CGB ? background_pixel.palette : 0);
+            lcd_.RenderPixel<mode>(pixels_pushed_, background_pixel.color, false, mode == GameboyMode::CGB ? background_pixel.palette : 0);
         else
-            lcd_.RenderPixel(pixels_pushed_, sprite_pixel.color, true, sprite_pixel.palette);
+            lcd_.RenderPixel<mode>(pixels_pushed_, sprite_pixel.color, true, sprite_pixel.palette);
 
         ++pixels_pushed_;
     }
+
+    template void PPU::Tick<GameboyMode::DMG>();
+    template void PPU::Tick<GameboyMode::DMGCompatibility>();
+    template void PPU::Tick<GameboyMode::CGB>();
 } // namespace gandalf
\ No newline at end of file
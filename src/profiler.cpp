@@ -0,0 +1,200 @@
+#include <gandalf/profiler.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    constexpr std::size_t kRootNode = 0;
+    constexpr std::size_t kMaxStackDepth = 256; // Deeper calls are accounted to the deepest frame
+    constexpr gandalf::word kInterruptBank = 0xFFFF;
+
+    std::uint32_t MakeKey(gandalf::word bank, gandalf::word address)
+    {
+        return (static_cast<std::uint32_t>(bank) << 16) | address;
+    }
+}
+
+namespace gandalf {
+    Profiler::Profiler()
+    {
+        Reset();
+    }
+
+    Profiler::~Profiler() = default;
+
+    void Profiler::Reset()
+    {
+        locations_.clear();
+        opcodes_.fill(Counters());
+        total_cycles_ = 0;
+
+        stack_nodes_.clear();
+        stack_nodes_.push_back(StackNode{ 0, kRootNode, {}, 0 });
+        current_node_ = kRootNode;
+        depth_ = 0;
+        overflow_depth_ = 0;
+    }
+
+    void Profiler::OnInstruction(word bank, word address, word opcode, std::uint32_t cycles)
+    {
+        Counters& location = locations_[MakeKey(bank, address)];
+        ++location.instructions;
+        location.cycles += cycles;
+
+        Counters& op = opcodes_[opcode % OpcodeCount];
+        ++op.instructions;
+        op.cycles += cycles;
+
+        stack_nodes_[current_node_].cycles += cycles;
+        total_cycles_ += cycles;
+    }
+
+    void Profiler::OnIdle(word bank, word address, std::uint32_t cycles)
+    {
+        locations_[MakeKey(bank, address)].cycles += cycles;
+        stack_nodes_[current_node_].cycles += cycles;
+        total_cycles_ += cycles;
+    }
+
+    void Profiler::OnCall(word bank, word address)
+    {
+        Enter(MakeKey(bank, address));
+    }
+
+    void Profiler::OnInterrupt(word address, std::uint32_t cycles)
+    {
+        Enter(MakeKey(kInterruptBank, address));
+        stack_nodes_[current_node_].cycles += cycles;
+        total_cycles_ += cycles;
+    }
+
+    void Profiler::OnReturn()
+    {
+        // Programs may discard return addresses or use RET as a jump, in which case there is nothing to return from.
+        if (overflow_depth_ > 0)
+        {
+            --overflow_depth_;
+            return;
+        }
+        if (current_node_ == kRootNode)
+            return;
+
+        current_node_ = stack_nodes_[current_node_].parent;
+        --depth_;
+    }
+
+    void Profiler::Enter(std::uint32_t key)
+    {
+        if (depth_ >= kMaxStackDepth)
+        {
+            ++overflow_depth_;
+            return;
+        }
+
+        auto it = stack_nodes_[current_node_].children.find(key);
+        if (it == stack_nodes_[current_node_].children.end())
+        {
+            const std::size_t node = stack_nodes_.size();
+            stack_nodes_.push_back(StackNode{ key, current_node_, {}, 0 });
+            it = stack_nodes_[current_node_].children.emplace(key, node).first;
+        }
+
+        current_node_ = it->second;
+        ++depth_;
+    }
+
+    std::string Profiler::GetFrameName(std::uint32_t key) const
+    {
+        const word bank = key >> 16;
+        const word address = key & 0xFFFF;
+
+        std::ostringstream name;
+        name << std::hex << std::setfill('0');
+        if (bank == kInterruptBank)
+            name << "int_" << std::setw(4) << address;
+        else
+            name << std::setw(2) << bank << ':' << std::setw(4) << address;
+        return name.str();
+    }
+
+    std::vector<Profiler::HotSpot> Profiler::GetHotSpots() const
+    {
+        std::vector<HotSpot> result;
+        result.reserve(locations_.size());
+        for (const auto& [key, counters] : locations_)
+            result.push_back(HotSpot{ { static_cast<word>(key >> 16), static_cast<word>(key & 0xFFFF) }, counters });
+
+        std::sort(result.begin(), result.end(), [](const HotSpot& a, const HotSpot& b) {
+            if (a.counters.cycles != b.counters.cycles)
+                return a.counters.cycles > b.counters.cycles;
+            return MakeKey(a.location.bank, a.location.address) < MakeKey(b.location.bank, b.location.address);
+        });
+        return result;
+    }
+
+    void Profiler::WriteReport(std::ostream& os, std::size_t max_entries) const
+    {
+        const auto percentage = [this](std::uint64_t cycles) {
+            return total_cycles_ == 0 ? 0.0 : 100.0 * static_cast<double>(cycles) / static_cast<double>(total_cycles_);
+        };
+
+        const std::ios_base::fmtflags flags(os.flags());
+        const std::streamsize precision = os.precision();
+        const auto hot_spots = GetHotSpots();
+        os << "Total cycles: " << total_cycles_ << std::endl << std::endl;
+        os << "Location        Instructions          Cycles       %" << std::endl;
+        for (std::size_t i = 0; i < hot_spots.size() && i < max_entries; ++i)
+        {
+            const HotSpot& spot = hot_spots[i];
+            os << std::left << std::setw(10) << GetFrameName(MakeKey(spot.location.bank, spot.location.address)) << std::right
+                << std::setw(18) << spot.counters.instructions
+                << std::setw(16) << spot.counters.cycles
+                << std::setw(8) << std::fixed << std::setprecision(2) << percentage(spot.counters.cycles) << std::endl;
+        }
+
+        std::vector<word> opcodes;
+        for (word i = 0; i < OpcodeCount; ++i)
+        {
+            if (opcodes_[i].instructions > 0)
+                opcodes.push_back(i);
+        }
+        std::sort(opcodes.begin(), opcodes.end(), [this](word a, word b) { return opcodes_[a].cycles > opcodes_[b].cycles; });
+
+        os << std::endl << "Opcode          Instructions          Cycles       %" << std::endl;
+        for (std::size_t i = 0; i < opcodes.size() && i < max_entries; ++i)
+        {
+            const word opcode = opcodes[i];
+            std::ostringstream name;
+            name << std::hex << std::uppercase << std::setfill('0');
+            if (opcode >= 0x100)
+                name << "CB ";
+            name << std::setw(2) << (opcode & 0xFF);
+
+            os << std::left << std::setw(10) << name.str() << std::right
+                << std::setw(18) << opcodes_[opcode].instructions
+                << std::setw(16) << opcodes_[opcode].cycles
+                << std::setw(8) << std::fixed << std::setprecision(2) << percentage(opcodes_[opcode].cycles) << std::endl;
+        }
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    void Profiler::WriteFoldedStacks(std::ostream& os) const
+    {
+        for (std::size_t node = 0; node < stack_nodes_.size(); ++node)
+        {
+            if (stack_nodes_[node].cycles == 0)
+                continue;
+
+            std::vector<std::string> frames;
+            for (std::size_t current = node; current != kRootNode; current = stack_nodes_[current].parent)
+                frames.push_back(GetFrameName(stack_nodes_[current].key));
+
+            os << "root";
+            for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+                os << ';' << *it;
+            os << ' ' << stack_nodes_[node].cycles << '\n';
+        }
+    }
+} // namespace gandalf
@@ -0,0 +1,268 @@
+#include <gandalf/remote_link.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include <gandalf/exception.h>
+
+namespace {
+    // The snapshot for a prediction is taken when the transfer completes within this number of cycles, which must be larger than the longest instruction.
+    constexpr std::uint64_t kSnapshotWindow = 32;
+    constexpr std::chrono::milliseconds kWaitTimeout(100);
+}
+
+namespace gandalf {
+    RemoteLink::RemoteLink(Gameboy& gb, std::unique_ptr<LinkTransport> transport, std::uint64_t max_lead):
+        gb_(gb),
+        transport_(std::move(transport)),
+        max_lead_(std::max<std::uint64_t>(max_lead, 1)),
+        start_cycles_(gb.GetCycleCount()),
+        remote_time_(0),
+        last_sync_time_(0),
+        snapshot_valid_(false),
+        speculating_(false),
+        speculation_time_(0),
+        prediction_(0xFF),
+        rollback_pending_(false),
+        replaying_(false),
+        replay_value_(0xFF),
+        waiting_for_reply_(false),
+        waiting_time_(0),
+        reply_(0xFF)
+    {
+        gb_.SetSerialEndpoint(this);
+    }
+
+    RemoteLink::~RemoteLink()
+    {
+        gb_.SetSerialEndpoint(nullptr);
+    }
+
+    bool RemoteLink::RunCycles(std::uint64_t cycles)
+    {
+        const std::uint64_t end = GetTime() + cycles;
+        while (GetTime() < end)
+        {
+            ReceiveMessages(std::chrono::milliseconds(0));
+            if (rollback_pending_)
+            {
+                Rollback();
+                continue;
+            }
+            ApplyIncomingTransfers();
+
+            const std::uint64_t now = GetTime();
+            std::uint64_t limit = end;
+            if (transport_->IsConnected())
+            {
+                limit = std::min(limit, remote_time_ + max_lead_);
+                if (!incoming_transfers_.empty())
+                    limit = std::min(limit, incoming_transfers_.front().time);
+            }
+
+            if (limit <= now)
+            {
+                ++statistics_.stalls;
+                SendSync();
+                ReceiveMessages(kWaitTimeout);
+                continue;
+            }
+
+            // Messages of the partner are only handled between runs
+            limit = std::min(limit, now + std::max<std::uint64_t>(max_lead_ / 4, 1));
+
+            // A transfer in progress must not complete before the next snapshot point. A transfer that starts during this run ends the run
+            // early, so an idle port does not limit the run and the messages of the partner are checked less often.
+            if (!speculating_)
+            {
+                const unsigned int cycles_until_transfer = gb_.GetSerial().GetCyclesUntilTransferComplete();
+                if (cycles_until_transfer > kSnapshotWindow)
+                    limit = std::min(limit, now + cycles_until_transfer - kSnapshotWindow);
+                else if (cycles_until_transfer > 0)
+                    TakeSnapshot();
+            }
+
+            const bool completed = gb_.RunCyclesUntilTransfer(limit - now);
+
+            // Report progress to the partner regularly, so that it does not have to wait for us
+            if (GetTime() >= last_sync_time_ + std::max<std::uint64_t>(max_lead_ / 4, 1))
+                SendSync();
+
+            if (!completed)
+            {
+                SendSync();
+                return false;
+            }
+        }
+
+        SendSync();
+        return true;
+    }
+
+    byte RemoteLink::OnTransferCompleted(byte value)
+    {
+        const std::uint64_t time = GetTime();
+        if (replaying_ && time == speculation_time_)
+        {
+            replaying_ = false;
+            snapshot_valid_ = false;
+            applied_since_snapshot_.clear();
+            return replay_value_;
+        }
+
+        // Only one prediction can be outstanding
+        if (speculating_)
+        {
+            ++statistics_.stalls;
+            while (speculating_ && transport_->IsConnected())
+            {
+                ReceiveMessages(kWaitTimeout);
+                ApplyIncomingTransfers();
+            }
+            speculating_ = false;
+        }
+
+        // The current execution will be discarded by the rollback, the transfer is sent when it is executed again
+        if (rollback_pending_ || !transport_->IsConnected())
+            return 0xFF;
+
+        Send(LinkMessage::Type::Transfer, time, value);
+        ++statistics_.transfers_sent;
+
+        if (snapshot_valid_)
+        {
+            speculating_ = true;
+            speculation_time_ = time;
+            return prediction_;
+        }
+
+        // Without a snapshot the transfer cannot be undone, so we have to wait for the reply
+        ++statistics_.stalls;
+        waiting_for_reply_ = true;
+        waiting_time_ = time;
+        while (waiting_for_reply_ && transport_->IsConnected())
+        {
+            ReceiveMessages(kWaitTimeout);
+            ApplyIncomingTransfers();
+        }
+
+        if (waiting_for_reply_)
+        {
+            waiting_for_reply_ = false;
+            return 0xFF;
+        }
+        return reply_;
+    }
+
+    void RemoteLink::ReceiveMessages(std::chrono::milliseconds timeout)
+    {
+        LinkMessage message;
+        if (!transport_->Receive(message, timeout))
+            return;
+
+        HandleMessage(message);
+        while (transport_->Receive(message, std::chrono::milliseconds(0)))
+            HandleMessage(message);
+    }
+
+    void RemoteLink::HandleMessage(const LinkMessage& message)
+    {
+        remote_time_ = std::max(remote_time_, message.time);
+
+        switch (message.type)
+        {
+        case LinkMessage::Type::Sync:
+            break;
+        case LinkMessage::Type::Transfer:
+            incoming_transfers_.push_back(IncomingTransfer{ message.time, message.value, false });
+            ++statistics_.transfers_received;
+            break;
+        case LinkMessage::Type::Reply:
+            if (waiting_for_reply_ && message.time == waiting_time_)
+            {
+                waiting_for_reply_ = false;
+                reply_ = message.value;
+            }
+            else if (speculating_ && message.time == speculation_time_)
+            {
+                speculating_ = false;
+                if (message.value != prediction_)
+                {
+                    ++statistics_.mispredictions;
+                    rollback_pending_ = true;
+                    replay_value_ = message.value;
+                }
+                else
+                {
+                    snapshot_valid_ = false;
+                    applied_since_snapshot_.clear();
+                }
+            }
+            prediction_ = message.value;
+            break;
+        default:
+            throw Exception("Invalid link message");
+        }
+    }
+
+    void RemoteLink::ApplyIncomingTransfers()
+    {
+        const std::uint64_t now = GetTime();
+        while (!incoming_transfers_.empty() && incoming_transfers_.front().time <= now)
+        {
+            const IncomingTransfer transfer = incoming_transfers_.front();
+            incoming_transfers_.pop_front();
+
+            const byte reply = gb_.GetSerial().TransferExternal(transfer.value);
+            if (!transfer.replay)
+                Send(LinkMessage::Type::Reply, transfer.time, reply);
+
+            if (snapshot_valid_)
+                applied_since_snapshot_.push_back(IncomingTransfer{ now, transfer.value, true });
+        }
+    }
+
+    void RemoteLink::TakeSnapshot()
+    {
+        // The ROM does not change, so it is left out of the snapshot
+        std::ostringstream os;
+        if (!gb_.SaveState(os, false))
+            throw Exception("Failed to save the state for the link prediction");
+
+        snapshot_ = os.str();
+        snapshot_valid_ = true;
+        applied_since_snapshot_.clear();
+    }
+
+    void RemoteLink::Rollback()
+    {
+        std::istringstream is(snapshot_);
+        if (!gb_.LoadState(is))
+            throw Exception("Failed to restore the state for the link prediction");
+
+        // The transfers of the partner are applied again at the same time, the partner already has the reply
+        for (auto it = applied_since_snapshot_.rbegin(); it != applied_since_snapshot_.rend(); ++it)
+            incoming_transfers_.push_front(*it);
+
+        applied_since_snapshot_.clear();
+        snapshot_valid_ = false;
+        rollback_pending_ = false;
+        replaying_ = true;
+    }
+
+    void RemoteLink::SendSync()
+    {
+        const std::uint64_t time = GetTime();
+        if (time == last_sync_time_)
+            return;
+
+        Send(LinkMessage::Type::Sync, time, 0);
+        last_sync_time_ = time;
+    }
+
+    void RemoteLink::Send(LinkMessage::Type type, std::uint64_t time, byte value)
+    {
+        transport_->Send(LinkMessage{ type, time, value });
+    }
+} // namespace gandalf
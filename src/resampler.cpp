@@ -0,0 +1,132 @@
+#include <gandalf/resampler.h>
+
+#include <cmath>
+
+#include <gandalf/exception.h>
+
+#include "simd.h"
+
+namespace {
+    constexpr double kPi = 3.14159265358979323846;
+    constexpr std::int64_t kOne = std::int64_t(1) << 32;
+
+    // Cutoff frequency relative to the output rate, the remaining part up to half the output rate is the transition band of the filter
+    constexpr double kCutoff = 0.45;
+
+    double Sinc(double x)
+    {
+        return x == 0 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+    }
+
+    double Blackman(double position, double width)
+    {
+        return 0.42 + 0.5 * std::cos(2 * kPi * position / width) + 0.08 * std::cos(4 * kPi * position / width);
+    }
+
+    void DotProduct(const float* coefficients, const float* left, const float* right, int count, float& left_result, float& right_result)
+    {
+        int i = 0;
+#if defined(GANDALF_SIMD_SSE2)
+        __m128 left_sum = _mm_setzero_ps(), right_sum = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 c = _mm_loadu_ps(coefficients + i);
+            left_sum = _mm_add_ps(left_sum, _mm_mul_ps(c, _mm_loadu_ps(left + i)));
+            right_sum = _mm_add_ps(right_sum, _mm_mul_ps(c, _mm_loadu_ps(right + i)));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, left_sum);
+        left_result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        _mm_storeu_ps(lanes, right_sum);
+        right_result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(GANDALF_SIMD_NEON)
+        float32x4_t left_sum = vdupq_n_f32(0), right_sum = vdupq_n_f32(0);
+        for (; i + 4 <= count; i += 4)
+        {
+            const float32x4_t c = vld1q_f32(coefficients + i);
+            left_sum = vmlaq_f32(left_sum, c, vld1q_f32(left + i));
+            right_sum = vmlaq_f32(right_sum, c, vld1q_f32(right + i));
+        }
+        float lanes[4];
+        vst1q_f32(lanes, left_sum);
+        left_result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        vst1q_f32(lanes, right_sum);
+        right_result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+        left_result = 0;
+        right_result = 0;
+#endif
+        for (; i < count; ++i)
+        {
+            left_result += coefficients[i] * left[i];
+            right_result += coefficients[i] * right[i];
+        }
+    }
+}
+
+namespace gandalf {
+    Resampler::Resampler(std::shared_ptr<APU::OutputHandler> output, std::uint32_t output_rate): output_(output), output_rate_(output_rate),
+        history_index_(0),
+        time_until_output_(kOne)
+    {
+        if (!output_)
+            throw InvalidArgument("Output handler must not be null");
+        if (output_rate == 0 || output_rate > InputRate)
+            throw InvalidArgument("Output rate must be between 1 and the input rate");
+
+        // Row p holds the filter for an output that lies p / Phases input samples before the center of the history. Every row is
+        // normalized, so that a constant input results in the same constant output.
+        const double cutoff = kCutoff * output_rate / InputRate;
+        coefficients_.resize((Phases + 1) * Taps);
+        for (int phase = 0; phase <= Phases; ++phase)
+        {
+            float* row = coefficients_.data() + phase * Taps;
+            double sum = 0;
+            for (int tap = 0; tap < Taps; ++tap)
+            {
+                const double position = Taps / 2.0 - static_cast<double>(phase) / Phases - tap;
+                const double value = 2 * cutoff * Sinc(2 * cutoff * position) * Blackman(position, Taps);
+                row[tap] = static_cast<float>(value);
+                sum += value;
+            }
+            for (int tap = 0; tap < Taps; ++tap)
+                row[tap] = static_cast<float>(row[tap] / sum);
+        }
+
+        left_history_.resize(2 * Taps, 0.0f);
+        right_history_.resize(2 * Taps, 0.0f);
+        SetRateAdjustment(1.0);
+    }
+
+    Resampler::~Resampler() = default;
+
+    void Resampler::SetRateAdjustment(double factor)
+    {
+        if (!(factor >= 0.5 && factor <= 2.0))
+            throw InvalidArgument("Rate adjustment must be between 0.5 and 2");
+
+        step_ = static_cast<std::uint64_t>(std::llround(static_cast<double>(InputRate) / (output_rate_ * factor) * kOne));
+    }
+
+    void Resampler::Play(float left, float right)
+    {
+        left_history_[history_index_] = left_history_[history_index_ + Taps] = left;
+        right_history_[history_index_] = right_history_[history_index_ + Taps] = right;
+        history_index_ = (history_index_ + 1) % Taps;
+
+        // The time was positive before a sample was added, so the fraction is always smaller than one input sample
+        time_until_output_ -= kOne;
+        while (time_until_output_ <= 0)
+        {
+            const std::uint64_t fraction = static_cast<std::uint64_t>(-time_until_output_);
+            const std::uint64_t phase = (fraction * Phases + (kOne / 2)) >> 32;
+
+            float left_output, right_output;
+            DotProduct(coefficients_.data() + phase * Taps, left_history_.data() + history_index_, right_history_.data() + history_index_, Taps,
+                left_output, right_output);
+            output_->Play(left_output, right_output);
+
+            time_until_output_ += static_cast<std::int64_t>(step_);
+        }
+    }
+} // namespace gandalf
@@ -0,0 +1,257 @@
+#include <gandalf/save_file.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <gandalf/exception.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    gandalf::MBC& GetBatteryMBC(gandalf::Cartridge& cartridge)
+    {
+        gandalf::MBC* mbc = cartridge.GetMBC();
+        if (!mbc || !mbc->HasBattery())
+            throw gandalf::InvalidArgument("The cartridge has no battery");
+        return *mbc;
+    }
+
+    bool SyncFile(std::FILE* file)
+    {
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+
+    /// Writes the image to a temporary file next to the save and renames it over the save, so the save is never partially written.
+    bool WriteImage(const std::string& path, const std::vector<gandalf::MBC::RAMBank>& banks, const std::string& footer)
+    {
+        const std::string temporary_path = path + ".tmp";
+        std::FILE* file = std::fopen(temporary_path.c_str(), "wb");
+        if (!file)
+            return false;
+
+        bool ok = true;
+        for (const gandalf::MBC::RAMBank& bank : banks)
+            ok = ok && std::fwrite(bank.data(), 1, bank.size(), file) == bank.size();
+        ok = ok && std::fwrite(footer.data(), 1, footer.size(), file) == footer.size();
+        ok = ok && std::fflush(file) == 0 && SyncFile(file);
+        ok = std::fclose(file) == 0 && ok;
+
+        std::error_code error;
+        if (ok)
+            std::filesystem::rename(temporary_path, path, error);
+        if (!ok || error)
+        {
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    int CountBanks(std::uint32_t mask)
+    {
+        int count = 0;
+        for (; mask != 0; mask &= mask - 1)
+            ++count;
+        return count;
+    }
+}
+
+namespace gandalf {
+    SaveFile::SaveFile(Cartridge& cartridge, const std::string& path, unsigned int flush_interval): cartridge_(cartridge),
+        path_(path),
+        flush_interval_(flush_interval),
+        frames_until_flush_(flush_interval),
+        mismatch_(false),
+        pending_banks_(0),
+        footer_pending_(false),
+        queued_generation_(0),
+        written_generation_(0),
+        closing_(false),
+        failed_(false),
+        written_banks_(0)
+    {
+        MBC& mbc = GetBatteryMBC(cartridge_);
+        if (flush_interval == 0)
+            throw InvalidArgument("Flush interval must be larger than 0");
+
+        std::ifstream file(path, std::ios::binary);
+        if (file.is_open())
+        {
+            // A save that cannot be loaded is left alone instead of replacing it with the current RAM, it may be the only copy
+            try
+            {
+                mbc.LoadRAM(file);
+            }
+            catch (const SerializationException&)
+            {
+                throw Exception("The save file is smaller than the cartridge RAM");
+            }
+            if (file.bad())
+                throw Exception("Failed to read the save file");
+        }
+
+        std::ostringstream footer;
+        mbc.SaveFooter(footer);
+        footer_ = footer.str();
+        image_ = mbc.GetRAM();
+        if (!file.is_open() && !WriteImage(path_, image_, footer_))
+            throw Exception("Failed to create the save file");
+        mbc.TakeDirtyRAMBanks();
+
+        pending_.resize(image_.size());
+        writer_ = std::thread(&SaveFile::Run, this);
+    }
+
+    SaveFile::~SaveFile()
+    {
+        try
+        {
+            Close();
+        }
+        catch (const Exception&)
+        {
+        }
+    }
+
+    void SaveFile::OnVBlank()
+    {
+        if (--frames_until_flush_ > 0)
+            return;
+
+        frames_until_flush_ = flush_interval_;
+        QueueDirtyBanks(false);
+    }
+
+    void SaveFile::Flush()
+    {
+        QueueDirtyBanks(true);
+        if (mismatch_)
+            throw Exception("The cartridge RAM no longer matches the save file");
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        const std::uint64_t generation = queued_generation_;
+        condition_.wait(lock, [this, generation]() { return written_generation_ >= generation || failed_; });
+        if (failed_)
+            throw Exception("Failed to write the save file");
+    }
+
+    void SaveFile::Close()
+    {
+        // The writer thread is stopped even when the RAM no longer matches, the changes before the mismatch are in the file
+        QueueDirtyBanks(true);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        condition_.notify_all();
+
+        if (writer_.joinable())
+            writer_.join();
+
+        if (mismatch_)
+            throw Exception("The cartridge RAM no longer matches the save file");
+        if (failed_)
+            throw Exception("Failed to write the save file");
+    }
+
+    MBC* SaveFile::FindMBC()
+    {
+        MBC* mbc = cartridge_.GetMBC();
+        if (!mbc || !mbc->HasBattery() || mbc->GetRAM().size() != pending_.size())
+            return nullptr;
+        return mbc;
+    }
+
+    void SaveFile::QueueDirtyBanks(bool write_footer)
+    {
+        // This runs from the VBlank of the emulation and must not throw, a mismatch is reported by Flush() and Close()
+        MBC* mbc = mismatch_ ? nullptr : FindMBC();
+        if (!mbc)
+        {
+            mismatch_ = true;
+            return;
+        }
+
+        // A running clock changes the footer every second, so the time alone does not cause a write
+        const std::uint32_t dirty = mbc->TakeDirtyRAMBanks();
+        if (mbc->TakeDirtyFooter())
+            write_footer = true;
+        if (dirty == 0 && !write_footer)
+            return;
+
+        std::ostringstream footer;
+        mbc->SaveFooter(footer);
+        const bool footer_changed = footer.str() != footer_;
+        if (dirty == 0 && !footer_changed)
+            return;
+
+        // A bank that is still queued is overwritten with its newer contents, so the queue never holds more than one copy of the RAM
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_)
+                return;
+
+            for (std::size_t bank = 0; bank < pending_.size(); ++bank)
+            {
+                if (dirty & (std::uint32_t(1) << bank))
+                    pending_[bank] = mbc->GetRAM()[bank];
+            }
+            pending_banks_ |= dirty;
+            if (footer_changed)
+            {
+                footer_ = footer.str();
+                pending_footer_ = footer_;
+                footer_pending_ = true;
+            }
+            ++queued_generation_;
+        }
+        condition_.notify_all();
+    }
+
+    void SaveFile::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::string footer = footer_;
+        while (true)
+        {
+            condition_.wait(lock, [this]() { return pending_banks_ != 0 || footer_pending_ || closing_; });
+            if (pending_banks_ == 0 && !footer_pending_)
+                break;
+
+            const std::uint32_t mask = pending_banks_;
+            const std::uint64_t generation = queued_generation_;
+            for (std::size_t bank = 0; bank < image_.size(); ++bank)
+            {
+                if (mask & (std::uint32_t(1) << bank))
+                    image_[bank] = pending_[bank];
+            }
+            pending_banks_ = 0;
+            if (footer_pending_)
+                footer.swap(pending_footer_);
+            footer_pending_ = false;
+            const bool failed = failed_;
+            lock.unlock();
+
+            const bool ok = !failed && WriteImage(path_, image_, footer);
+            if (ok)
+                written_banks_.fetch_add(static_cast<std::uint64_t>(CountBanks(mask)), std::memory_order_relaxed);
+
+            lock.lock();
+            if (!ok)
+                failed_ = true;
+            written_generation_ = generation;
+            condition_.notify_all();
+        }
+    }
+} // namespace gandalf
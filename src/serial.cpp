@@ -5,15 +5,90 @@
 #include <gandalf/constants.h>
 #include <gandalf/serialization.h>
 
+namespace {
+    constexpr gandalf::word kNormalBitCycles = 512; // 8192 Hz
+    constexpr gandalf::word kFastBitCycles = 16; // 262144 Hz, CGB only
+}
+
 namespace gandalf {
-    Serial::Serial(GameboyMode mode): Memory::AddressHandler("Serial"), sb_(0), sc_(0), mode_(mode)
+    Serial::Serial(GameboyMode mode, Memory& memory): Memory::AddressHandler("Serial"), sb_(0), sc_(0), mode_(mode), memory_(memory), peer_(nullptr),
+        endpoint_(nullptr), transfer_listener_(nullptr), transfer_byte_(0), bit_count_(0), cycle_counter_(0)
     {
     }
 
     Serial::~Serial() = default;
 
     void Serial::Tick() {
+        if (!GetInProgress() || !GetInternalClock())
+            return;
+
+        if (--cycle_counter_ > 0)
+            return;
+
+        cycle_counter_ = GetFastClockSpeed() ? kFastBitCycles : kNormalBitCycles;
+
+        // Without a connected peer the input line is pulled high
+        const byte out = sb_ >> 7;
+        ShiftBit(peer_ ? peer_->ShiftExternal(out) : 1);
+    }
+
+    byte Serial::ShiftExternal(byte bit)
+    {
+        if (!GetInProgress() || GetInternalClock())
+            return 1;
+
+        const byte out = sb_ >> 7;
+        ShiftBit(bit);
+        return out;
+    }
+
+    byte Serial::TransferExternal(byte value)
+    {
+        if (!GetInProgress() || GetInternalClock())
+            return 0xFF;
+
+        const byte sent = sb_;
+        sb_ = value;
+        CompleteTransfer();
+        return sent;
+    }
+
+    void Serial::ShiftBit(byte bit)
+    {
+        sb_ = static_cast<byte>((sb_ << 1) | (bit & 1));
+        if (++bit_count_ < 8)
+            return;
 
+        if (endpoint_ && !peer_ && GetInternalClock())
+            sb_ = endpoint_->OnTransferCompleted(transfer_byte_);
+
+        CompleteTransfer();
+    }
+
+    void Serial::CompleteTransfer()
+    {
+        bit_count_ = 0;
+        sc_ &= 0x7F;
+        memory_.Write(address::IF, memory_.Read(address::IF) | SerialInterruptMask);
+    }
+
+    unsigned int Serial::GetCyclesUntilShift() const
+    {
+        return GetInProgress() && GetInternalClock() ? cycle_counter_ : 0;
+    }
+
+    unsigned int Serial::GetCyclesUntilTransferComplete() const
+    {
+        if (!GetInProgress() || !GetInternalClock())
+            return 0;
+
+        const unsigned int bit_cycles = GetFastClockSpeed() ? kFastBitCycles : kNormalBitCycles;
+        return cycle_counter_ + (7 - bit_count_) * bit_cycles;
+    }
+
+    unsigned int Serial::GetMinimumBitCycles() const
+    {
+        return mode_ == GameboyMode::CGB ? kFastBitCycles : kNormalBitCycles;
     }
 
     void Serial::Write(word address, byte value) {
@@ -22,7 +97,17 @@ namespace gandalf {
         if (address == address::SB)
             sb_ = value;
         else if (address == address::SC)
+        {
             sc_ = value;
+            if (GetInProgress())
+            {
+                transfer_byte_ = sb_;
+                bit_count_ = 0;
+                cycle_counter_ = GetFastClockSpeed() ? kFastBitCycles : kNormalBitCycles;
+                if (transfer_listener_ && GetInternalClock())
+                    transfer_listener_->OnTransferStarted();
+            }
+        }
     }
 
     std::set<word> Serial::GetAddresses() const
@@ -59,10 +144,16 @@ namespace gandalf {
     void Serial::Serialize(std::ostream& os) const {
         serialization::Serialize(os, sb_);
         serialization::Serialize(os, sc_);
+        serialization::Serialize(os, transfer_byte_);
+        serialization::Serialize(os, bit_count_);
+        serialization::Serialize(os, cycle_counter_);
     }
 
     void Serial::Deserialize(std::istream& is, std::uint16_t) {
         serialization::Deserialize(is, sb_);
         serialization::Deserialize(is, sc_);
+        serialization::Deserialize(is, transfer_byte_);
+        serialization::Deserialize(is, bit_count_);
+        serialization::Deserialize(is, cycle_counter_);
     }
-} // namespace gandalf
\ No newline at end of file
+} // namespace gandalf
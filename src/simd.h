@@ -0,0 +1,14 @@
+#ifndef __GANDALF_SIMD_H
+#define __GANDALF_SIMD_H
+
+// Selects the vector instruction set that is used by the pixel and audio kernels. SSE2 is part of every x86-64 target, NEON of every
+// AArch64 target. Wider instruction sets such as AVX2 are not used, because they would require dispatching at runtime.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GANDALF_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define GANDALF_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#endif
@@ -44,6 +44,28 @@ namespace gandalf
             return;
 
         counter_ = 0;
+        Step();
+    }
+
+    void FrameSequencer::Advance(std::uint64_t ticks)
+    {
+        while (ticks > 0)
+        {
+            const std::uint64_t ticks_until_step = counter_ < kDivider ? kDivider - counter_ : 1;
+            if (ticks < ticks_until_step)
+            {
+                counter_ += static_cast<int>(ticks);
+                return;
+            }
+
+            ticks -= ticks_until_step;
+            counter_ = 0;
+            Step();
+        }
+    }
+
+    void FrameSequencer::Step()
+    {
         current_step_ = (current_step_ + 1) % 8;
 
         for (auto it = listeners_[current_step_].begin(); it != listeners_[current_step_].end(); ++it) {
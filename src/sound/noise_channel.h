@@ -8,7 +8,7 @@
 
 namespace gandalf
 {
-    class NoiseChannel: public SoundChannel
+    class NoiseChannel final: public SoundChannel
     {
     public:
         NoiseChannel(FrameSequencer& frame_sequencer);
@@ -9,7 +9,7 @@
 
 namespace gandalf
 {
-    class SquareWaveChannel: public SoundChannel
+    class SquareWaveChannel final: public SoundChannel
     {
     public:
         SquareWaveChannel(FrameSequencer& frame_sequencer, bool has_frequency_sweep_unit);
@@ -6,7 +6,7 @@
 
 namespace gandalf
 {
-    class WaveChannel: public SoundChannel
+    class WaveChannel final: public SoundChannel
     {
     public:
         WaveChannel(FrameSequencer& frame_sequencer, const std::array<byte, 0x20>& wave_ram);
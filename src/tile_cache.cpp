@@ -0,0 +1,70 @@
+#include <gandalf/tile_cache.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include <gandalf/pixel_kernels.h>
+
+namespace {
+    using gandalf::byte;
+
+    // For every byte the 8 bits spread over 8 bytes, so that the two bit planes of a line are combined with a shift and an or.
+    // The tables are built through memory so that they do not depend on the byte order of the host.
+    struct SpreadTables {
+        SpreadTables()
+        {
+            for (int value = 0; value < 256; ++value)
+            {
+                byte bits[8], flipped_bits[8];
+                for (int i = 0; i < 8; ++i)
+                {
+                    bits[i] = (value >> (7 - i)) & 1;
+                    flipped_bits[i] = (value >> i) & 1;
+                }
+                std::memcpy(&normal[value], bits, sizeof(bits));
+                std::memcpy(&flipped[value], flipped_bits, sizeof(flipped_bits));
+            }
+        }
+
+        std::uint64_t normal[256];
+        std::uint64_t flipped[256];
+    };
+
+    const SpreadTables kSpreadTables;
+}
+
+namespace gandalf {
+    TileCache::TileCache(const VRAM& vram): vram_(vram)
+    {
+        InvalidateAll();
+    }
+
+    void TileCache::InvalidateAll()
+    {
+        valid_.fill(false);
+    }
+
+    const TileCache::Tile& TileCache::GetTile(int bank, int index, bool flip_x) const
+    {
+        const int slot = bank * TilesPerBank + index;
+        if (!valid_.at(slot))
+            Decode(slot);
+
+        return tiles_[slot][flip_x ? 1 : 0];
+    }
+
+    void TileCache::DecodeLine(byte low, byte high, bool flip_x, byte* output)
+    {
+        const std::uint64_t* table = flip_x ? kSpreadTables.flipped : kSpreadTables.normal;
+        const std::uint64_t line = table[low] | (table[high] << 1);
+        std::memcpy(output, &line, sizeof(line));
+    }
+
+    void TileCache::Decode(int slot) const
+    {
+        const byte* data = vram_[slot / TilesPerBank].data() + (slot % TilesPerBank) * 16;
+        kernels::DecodeTileRows(data, 8, false, tiles_[slot][0].data());
+        kernels::DecodeTileRows(data, 8, true, tiles_[slot][1].data());
+        valid_[slot] = true;
+    }
+} // namespace gandalf
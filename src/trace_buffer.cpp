@@ -0,0 +1,141 @@
+#include <gandalf/trace_buffer.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+#include <gandalf/exception.h>
+#include <gandalf/serialization.h>
+
+namespace {
+    constexpr char kMagic[4] = { 'G', 'B', 'T', 'R' };
+    constexpr std::uint16_t kFormatVersion = 1;
+
+    std::size_t RoundUpToPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+}
+
+namespace gandalf {
+    TraceBuffer::TraceBuffer(std::size_t capacity): write_index_(0)
+    {
+        if (capacity == 0)
+            throw InvalidArgument("Trace buffer capacity must be larger than 0");
+
+        // One slot is kept free for the record that is being written, see GetRecords()
+        records_.resize(RoundUpToPowerOfTwo(capacity + 1));
+        mask_ = records_.size() - 1;
+    }
+
+    TraceBuffer::~TraceBuffer() = default;
+
+    void TraceBuffer::Clear()
+    {
+        write_index_.store(0, std::memory_order_release);
+    }
+
+    std::vector<TraceRecord> TraceBuffer::GetRecords() const
+    {
+        const std::uint64_t end = write_index_.load(std::memory_order_acquire);
+        const std::uint64_t begin = end > GetCapacity() ? end - GetCapacity() : 0;
+
+        std::vector<TraceRecord> result;
+        result.reserve(static_cast<std::size_t>(end - begin));
+        for (std::uint64_t i = begin; i < end; ++i)
+            result.push_back(records_[i & mask_]);
+
+        // Records that were overwritten by the writer while copying are no longer valid. The writer may be halfway through the free slot,
+        // which held record end_after_copy - capacity - 1, so only newer records are kept. The fence orders the copy before the second load.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t end_after_copy = write_index_.load(std::memory_order_relaxed);
+        if (end_after_copy > GetCapacity() && end_after_copy - GetCapacity() > begin)
+        {
+            const std::uint64_t overwritten = std::min<std::uint64_t>(end_after_copy - GetCapacity() - begin, result.size());
+            result.erase(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(overwritten));
+        }
+
+        return result;
+    }
+
+    void TraceBuffer::Write(std::ostream& os) const
+    {
+        const auto records = GetRecords();
+
+        os.write(kMagic, sizeof(kMagic));
+        serialization::Serialize(os, kFormatVersion);
+        serialization::Serialize(os, static_cast<std::uint16_t>(RecordSize));
+        serialization::Serialize(os, static_cast<std::uint32_t>(records.size()));
+        for (const TraceRecord& record : records)
+        {
+            serialization::Serialize(os, record.cycle);
+            serialization::Serialize(os, record.program_counter);
+            serialization::Serialize(os, record.bank);
+            serialization::Serialize(os, record.af);
+            serialization::Serialize(os, record.bc);
+            serialization::Serialize(os, record.de);
+            serialization::Serialize(os, record.hl);
+            serialization::Serialize(os, record.stack_pointer);
+            serialization::Serialize(os, record.opcode);
+            serialization::Serialize(os, record.operand);
+        }
+    }
+
+    std::vector<TraceRecord> TraceBuffer::Read(std::istream& is)
+    {
+        char magic[sizeof(kMagic)];
+        if (!is.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(kMagic)))
+            throw SerializationException("Not a trace file");
+
+        std::uint16_t version, record_size;
+        std::uint32_t count;
+        serialization::Deserialize(is, version);
+        serialization::Deserialize(is, record_size);
+        serialization::Deserialize(is, count);
+        if (version != kFormatVersion || record_size != RecordSize)
+            throw SerializationException("Unsupported trace format version " + std::to_string(version));
+
+        // The count is not trusted, the records are read one at a time so a corrupt count fails on the end of the stream
+        std::vector<TraceRecord> records;
+        records.reserve(std::min<std::uint32_t>(count, 4096));
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            TraceRecord record;
+            serialization::Deserialize(is, record.cycle);
+            serialization::Deserialize(is, record.program_counter);
+            serialization::Deserialize(is, record.bank);
+            serialization::Deserialize(is, record.af);
+            serialization::Deserialize(is, record.bc);
+            serialization::Deserialize(is, record.de);
+            serialization::Deserialize(is, record.hl);
+            serialization::Deserialize(is, record.stack_pointer);
+            serialization::Deserialize(is, record.opcode);
+            serialization::Deserialize(is, record.operand);
+            records.push_back(record);
+        }
+        return records;
+    }
+
+    void TraceBuffer::WriteText(std::ostream& os, const TraceRecord& record)
+    {
+        const std::ios_base::fmtflags flags(os.flags());
+        const char fill = os.fill();
+        os << std::dec << std::setfill(' ') << std::setw(12) << record.cycle << std::hex << std::uppercase << std::setfill('0')
+            << "  " << std::setw(2) << record.bank << ':' << std::setw(4) << record.program_counter
+            << "  " << std::setw(2) << static_cast<int>(record.opcode);
+        if (record.opcode == 0xCB)
+            os << ' ' << std::setw(2) << static_cast<int>(record.operand);
+        else
+            os << "   ";
+        os << "  AF=" << std::setw(4) << record.af
+            << " BC=" << std::setw(4) << record.bc
+            << " DE=" << std::setw(4) << record.de
+            << " HL=" << std::setw(4) << record.hl
+            << " SP=" << std::setw(4) << record.stack_pointer << '\n';
+        os.flags(flags);
+        os.fill(fill);
+    }
+} // namespace gandalf
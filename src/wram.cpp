@@ -66,6 +66,14 @@ namespace gandalf {
         return result;
     }
 
+    word WRAM::GetBank(word address) const
+    {
+        if ((address >= 0xD000 && address < 0xE000) || (address >= 0xF000 && address < 0xFE00))
+            return static_cast<word>(wram_bank_);
+
+        return 0;
+    }
+
     void WRAM::Serialize(std::ostream& os) const
     {
         serialization::Serialize(os, data_);
@@ -0,0 +1,230 @@
+// Runs the test ROM corpus on all cores and writes a JSON report with the result and the emulation speed of every ROM and model.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gandalf/gameboy.h>
+
+#include "../src/test_rom.h"
+
+namespace {
+    struct Job
+    {
+        const test_rom::TestROM* test;
+        const gandalf::ROM* rom;
+        gandalf::Model model;
+        test_rom::Result result;
+    };
+
+    struct Options
+    {
+        unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+        std::uint64_t max_cycles = test_rom::kMaxCycles;
+        std::string filter;
+        std::string report;
+#ifdef RESOURCE_PATH
+        std::string resource_path = RESOURCE_PATH;
+#else
+        std::string resource_path;
+#endif
+    };
+
+    void PrintUsage(const char* name)
+    {
+        std::cout << "Usage: " << name << " [options]" << std::endl
+            << "  --jobs <n>           number of ROMs to run in parallel, defaults to the number of cores" << std::endl
+            << "  --max-cycles <n>     emulated cycles after which a ROM times out, defaults to " << test_rom::kMaxCycles << std::endl
+            << "  --filter <text>      only run the ROMs of which the suite or path contains the text" << std::endl
+            << "  --report <file>      write a JSON report to the file" << std::endl
+            << "  --resources <path>   the folder that contains the blargg and mooneye folders" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h" || i + 1 >= argc)
+                return false;
+
+            const std::string value = argv[++i];
+            try {
+                if (arg == "--jobs")
+                    options.jobs = std::max(1u, static_cast<unsigned int>(std::stoul(value)));
+                else if (arg == "--max-cycles")
+                    options.max_cycles = std::stoull(value);
+                else if (arg == "--filter")
+                    options.filter = value;
+                else if (arg == "--report")
+                    options.report = value;
+                else if (arg == "--resources")
+                    options.resource_path = value;
+                else
+                    return false;
+            }
+            catch (const std::exception&) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ReadFile(const std::string& path, gandalf::ROM& rom)
+    {
+        std::ifstream input(path, std::ios::binary);
+        if (input.fail())
+            return false;
+
+        rom = gandalf::ROM(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    std::string EscapeJSON(const std::string& text)
+    {
+        std::ostringstream os;
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '"': os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                else
+                    os << c;
+            }
+        }
+        return os.str();
+    }
+
+    double CyclesPerSecond(const test_rom::Result& result)
+    {
+        return result.seconds > 0 ? result.cycles / result.seconds : 0;
+    }
+
+    void WriteReport(std::ostream& os, const Options& options, const std::vector<Job>& jobs, double wall_seconds)
+    {
+        std::uint64_t total_cycles = 0;
+        double total_seconds = 0;
+        for (const Job& job : jobs)
+        {
+            total_cycles += job.result.cycles;
+            total_seconds += job.result.seconds;
+        }
+
+        os << std::setprecision(10);
+        os << "{" << std::endl
+            << "  \"jobs\": " << options.jobs << "," << std::endl
+            << "  \"max_cycles\": " << options.max_cycles << "," << std::endl
+            << "  \"wall_seconds\": " << wall_seconds << "," << std::endl
+            << "  \"total_cycles\": " << total_cycles << "," << std::endl
+            << "  \"cycles_per_second\": " << (total_seconds > 0 ? total_cycles / total_seconds : 0) << "," << std::endl
+            << "  \"results\": [";
+
+        for (std::size_t i = 0; i < jobs.size(); ++i)
+        {
+            const Job& job = jobs[i];
+            os << (i == 0 ? "" : ",") << std::endl
+                << "    {"
+                << "\"suite\": \"" << EscapeJSON(job.test->suite) << "\", "
+                << "\"rom\": \"" << EscapeJSON(job.test->path) << "\", "
+                << "\"model\": \"" << EscapeJSON(gandalf::GetModelName(job.model)) << "\", "
+                << "\"passed\": " << (job.result.passed ? "true" : "false") << ", "
+                << "\"timed_out\": " << (job.result.timed_out ? "true" : "false") << ", "
+                << "\"cycles\": " << job.result.cycles << ", "
+                << "\"seconds\": " << job.result.seconds << ", "
+                << "\"cycles_per_second\": " << CyclesPerSecond(job.result) << ", "
+                << "\"output\": \"" << EscapeJSON(job.result.output) << "\"}";
+        }
+        os << std::endl << "  ]" << std::endl << "}" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<test_rom::TestROM> tests;
+    for (const test_rom::TestROM& test : test_rom::GetTestROMs())
+    {
+        if (test.suite.find(options.filter) != std::string::npos || test.path.find(options.filter) != std::string::npos)
+            tests.push_back(test);
+    }
+
+    // Read all ROMs up front so the workers only emulate, a ROM that cannot be read fails on every model
+    std::vector<gandalf::ROM> roms(tests.size());
+    std::vector<bool> missing(tests.size());
+    std::vector<Job> jobs;
+    for (std::size_t i = 0; i < tests.size(); ++i)
+    {
+        missing[i] = !ReadFile(options.resource_path + "/" + test_rom::GetResourcePath(tests[i]), roms[i]);
+        for (gandalf::Model model : tests[i].models)
+            jobs.push_back(Job{ &tests[i], &roms[i], model, {} });
+    }
+
+    const unsigned int thread_count = static_cast<unsigned int>(std::min<std::size_t>(options.jobs, std::max<std::size_t>(1, jobs.size())));
+    std::cout << "Running " << jobs.size() << " test ROMs on " << thread_count << " threads" << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next_job(0);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back([&]() {
+            for (std::size_t j = next_job++; j < jobs.size(); j = next_job++)
+            {
+                if (missing[jobs[j].test - tests.data()])
+                    jobs[j].result.output = "Failed to read the ROM";
+                else
+                    jobs[j].result = test_rom::Run(*jobs[j].test, *jobs[j].rom, jobs[j].model, options.max_cycles);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    const double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t failed = 0;
+    for (const Job& job : jobs)
+    {
+        if (job.result.passed)
+            continue;
+
+        ++failed;
+        std::cout << "FAILED: " << job.test->path << " on " << gandalf::GetModelName(job.model)
+            << (job.result.timed_out ? " (timed out)" : "") << std::endl;
+    }
+
+    std::cout << jobs.size() - failed << "/" << jobs.size() << " passed in " << std::fixed << std::setprecision(2) << wall_seconds << " s" << std::endl;
+
+    if (!options.report.empty())
+    {
+        std::ofstream report(options.report);
+        WriteReport(report, options, jobs, wall_seconds);
+        if (report.fail())
+        {
+            std::cerr << "Failed to write the report: " << options.report << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <gandalf/apu.h>
+#include <gandalf/constants.h>
+
+using namespace gandalf;
+
+namespace {
+    class NullOutputHandler: public APU::OutputHandler
+    {
+    public:
+        std::uint32_t GetNextSampleTime() override { return 95; }
+        void Play(float, float) override {}
+    };
+
+    void StartChannels(APU& apu)
+    {
+        apu.Write(address::NR52, 0x80);
+
+        // Channel 1: frequency sweep that overflows after a few sweep steps
+        apu.Write(address::NR10, 0x12);
+        apu.Write(address::NR12, 0xF0);
+        apu.Write(address::NR13, 0x00);
+        apu.Write(address::NR14, 0x84);
+
+        // Channel 2: length counter that expires after 8 length steps
+        apu.Write(address::NR21, 0x38);
+        apu.Write(address::NR22, 0xF0);
+        apu.Write(address::NR24, 0xC0);
+
+        // Channel 3: length counter that expires after 40 length steps
+        apu.Write(address::NR30, 0x80);
+        apu.Write(address::NR31, 216);
+        apu.Write(address::NR34, 0xC0);
+
+        // Channel 4: no length, stays enabled
+        apu.Write(address::NR42, 0xF0);
+        apu.Write(address::NR44, 0x80);
+    }
+}
+
+TEST(APU, nr52_without_output_handler_matches_synthesis)
+{
+    APU synthesized;
+    synthesized.SetAudioHandler(std::make_shared<NullOutputHandler>());
+    APU lazy;
+
+    StartChannels(synthesized);
+    StartChannels(lazy);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        for (int tick = 0; tick < 1234; ++tick)
+        {
+            synthesized.Tick();
+            lazy.Tick();
+        }
+
+        ASSERT_EQ(synthesized.Read(address::NR52), lazy.Read(address::NR52)) << "after " << (i + 1) * 1234 << " ticks";
+    }
+
+    // All channels except the noise channel should have been disabled by now
+    EXPECT_EQ(lazy.Read(address::NR52) & 0xF, 0x8);
+}
+
+TEST(APU, attaching_output_handler_applies_pending_ticks)
+{
+    APU apu;
+    apu.Write(address::NR52, 0x80);
+    apu.Write(address::NR21, 0x3F); // Length of 1
+    apu.Write(address::NR22, 0xF0);
+    apu.Write(address::NR24, 0xC0);
+    ASSERT_EQ(apu.Read(address::NR52) & 0x2, 0x2);
+
+    for (int tick = 0; tick < CPUFrequency / 256; ++tick)
+        apu.Tick();
+
+    apu.SetAudioHandler(std::make_shared<NullOutputHandler>());
+    EXPECT_EQ(apu.Read(address::NR52) & 0x2, 0x0);
+}
+
+TEST(APU, serialize_applies_pending_ticks)
+{
+    APU apu;
+    apu.Write(address::NR52, 0x80);
+    apu.Write(address::NR21, 0x3F); // Length of 1
+    apu.Write(address::NR22, 0xF0);
+    apu.Write(address::NR24, 0xC0);
+
+    for (int tick = 0; tick < CPUFrequency / 256; ++tick)
+        apu.Tick();
+
+    std::stringstream ss;
+    apu.Serialize(ss);
+
+    APU deserialized;
+    deserialized.Deserialize(ss, 1);
+    EXPECT_EQ(deserialized.Read(address::NR52) & 0x2, 0x0);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <gandalf/audio_ring_buffer.h>
+#include <gandalf/exception.h>
+
+using namespace gandalf;
+
+TEST(AudioRingBuffer, read_wraps_around_and_fills_silence)
+{
+    AudioRingBuffer buffer(6, 44100);
+    ASSERT_EQ(buffer.GetCapacity(), 8u);
+
+    std::vector<float> output(2 * 8);
+    float next = 1;
+    float expected = 1;
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < 5; ++i, next += 2)
+            buffer.Play(next, next + 1);
+        EXPECT_EQ(buffer.GetAvailable(), 5u);
+
+        ASSERT_EQ(buffer.Read(output.data(), 6), 5u);
+        for (int i = 0; i < 10; ++i, ++expected)
+            ASSERT_EQ(output[i], expected) << round << " " << i;
+        EXPECT_EQ(output[10], 0.0f);
+        EXPECT_EQ(output[11], 0.0f);
+    }
+    EXPECT_EQ(buffer.GetUnderruns(), 3u);
+    EXPECT_EQ(buffer.GetOverruns(), 0u);
+}
+
+TEST(AudioRingBuffer, overrun)
+{
+    AudioRingBuffer buffer(4, 44100);
+    for (int i = 0; i < 10; ++i)
+        buffer.Play(static_cast<float>(i), 0);
+    EXPECT_EQ(buffer.GetOverruns(), 6u);
+
+    float output[8];
+    ASSERT_EQ(buffer.Read(output, 4), 4u);
+    EXPECT_EQ(output[0], 0.0f);
+    EXPECT_EQ(output[6], 3.0f);
+}
+
+TEST(AudioRingBuffer, blocking_writer_waits_for_reader)
+{
+    constexpr int kSamples = 20000;
+    AudioRingBuffer buffer(64, 44100);
+    buffer.SetBlocking(true);
+
+    std::thread writer([&buffer]() {
+        for (int i = 0; i < kSamples; ++i)
+            buffer.Play(static_cast<float>(i), static_cast<float>(-i));
+        });
+
+    std::vector<float> output(2 * 16);
+    int received = 0;
+    while (received < kSamples)
+    {
+        const std::size_t count = buffer.Read(output.data(), 16);
+        for (std::size_t i = 0; i < count; ++i, ++received)
+        {
+            ASSERT_EQ(output[2 * i], static_cast<float>(received));
+            ASSERT_EQ(output[2 * i + 1], static_cast<float>(-received));
+        }
+    }
+    writer.join();
+    EXPECT_EQ(buffer.GetOverruns(), 0u);
+}
+
+TEST(AudioRingBuffer, disabling_blocking_releases_writer)
+{
+    AudioRingBuffer buffer(4, 44100);
+    buffer.SetBlocking(true);
+    std::thread writer([&buffer]() {
+        for (int i = 0; i < 10; ++i)
+            buffer.Play(0, 0);
+        });
+
+    while (buffer.GetAvailable() < 4)
+        std::this_thread::yield();
+    buffer.SetBlocking(false);
+    writer.join();
+    EXPECT_EQ(buffer.GetOverruns(), 6u);
+}
+
+TEST(AudioRingBuffer, invalid_arguments)
+{
+    EXPECT_THROW(AudioRingBuffer(0, 44100), InvalidArgument);
+    EXPECT_THROW(AudioRingBuffer(16, 0), InvalidArgument);
+}
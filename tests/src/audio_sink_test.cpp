@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include <gandalf/audio_sink.h>
+#include <gandalf/constants.h>
+#include <gandalf/exception.h>
+
+using namespace gandalf;
+
+namespace {
+    std::uint32_t ReadU32(const std::string& data, std::size_t offset)
+    {
+        std::uint32_t value = 0;
+        for (int i = 3; i >= 0; --i)
+            value = (value << 8) | static_cast<unsigned char>(data[offset + i]);
+        return value;
+    }
+
+    std::int16_t ReadS16(const std::string& data, std::size_t offset)
+    {
+        return static_cast<std::int16_t>(static_cast<unsigned char>(data[offset]) | (static_cast<unsigned char>(data[offset + 1]) << 8));
+    }
+}
+
+TEST(AudioSink, sample_times_match_sample_rate)
+{
+    std::stringstream stream;
+    AudioSink sink(stream, AudioSink::Format::RawPCM, 44100);
+
+    std::uint64_t cycles = 0;
+    for (int i = 0; i < 44100; ++i)
+        cycles += sink.GetNextSampleTime();
+    EXPECT_EQ(cycles, static_cast<std::uint64_t>(CPUFrequency));
+}
+
+TEST(AudioSink, wav)
+{
+    // Blocks are small so that several full blocks and a partial block are written
+    constexpr int kSamples = 1000;
+    std::stringstream stream;
+    AudioSink sink(stream, AudioSink::Format::WAV, 48000, 64, 64);
+    for (int i = 0; i < kSamples; ++i)
+        sink.Play(i % 2 == 0 ? 1.0f : -2.0f, 0.5f);
+    sink.Close();
+    EXPECT_EQ(sink.GetWrittenSamples(), static_cast<std::uint64_t>(kSamples));
+    EXPECT_EQ(sink.GetDroppedSamples(), 0u);
+
+    const std::string data = stream.str();
+    ASSERT_EQ(data.size(), 44u + kSamples * 4);
+    EXPECT_EQ(data.compare(0, 4, "RIFF"), 0);
+    EXPECT_EQ(ReadU32(data, 4), 36u + kSamples * 4);
+    EXPECT_EQ(data.compare(8, 8, "WAVEfmt "), 0);
+    EXPECT_EQ(ReadU32(data, 24), 48000u);
+    EXPECT_EQ(data.compare(36, 4, "data"), 0);
+    EXPECT_EQ(ReadU32(data, 40), static_cast<std::uint32_t>(kSamples * 4));
+
+    EXPECT_EQ(ReadS16(data, 44), 32767);
+    EXPECT_EQ(ReadS16(data, 46), 16384);
+    EXPECT_EQ(ReadS16(data, 48), -32767);
+    EXPECT_EQ(ReadS16(data, 44 + (kSamples - 1) * 4), -32767);
+}
+
+TEST(AudioSink, raw_pcm_drops_samples_when_queue_is_full)
+{
+    // The queue holds fewer samples than are played, the writer thread may not keep up
+    std::stringstream stream;
+    AudioSink sink(stream, AudioSink::Format::RawPCM, 32768, 16, 4);
+    for (int i = 0; i < 100; ++i)
+        sink.Play(0.0f, 0.0f);
+    sink.Close();
+
+    EXPECT_EQ(sink.GetWrittenSamples() + sink.GetDroppedSamples(), 100u);
+    EXPECT_EQ(stream.str().size(), sink.GetWrittenSamples() * 4);
+}
+
+TEST(AudioSink, invalid_arguments)
+{
+    std::stringstream stream;
+    EXPECT_THROW(AudioSink(stream, AudioSink::Format::WAV, 0), InvalidArgument);
+    EXPECT_THROW(AudioSink(stream, AudioSink::Format::WAV, 44100, 0), InvalidArgument);
+}
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <gandalf/cartridge.h>
+#include <gandalf/constants.h>
 #include <array>
+#include <sstream>
 
 namespace gandalf {
     class CartridgeTest : public ::testing::Test {
@@ -101,6 +103,35 @@ namespace gandalf {
         EXPECT_FALSE(cartridge_.Load(bytes_));
     }
 
+    TEST_F(CartridgeTest, shared_rom_and_state_without_rom)
+    {
+        bytes_.at(0x147) = 0x03; // MBC1 + RAM + battery
+        bytes_.at(0x149) = 0x02;
+        bytes_.at(0x4000) = 0x42;
+        ASSERT_TRUE(cartridge_.Load(bytes_));
+
+        Cartridge clone;
+        ASSERT_TRUE(clone.Load(cartridge_));
+        EXPECT_EQ(cartridge_.GetMBC()->GetROM(), clone.GetMBC()->GetROM());
+        EXPECT_EQ(0x42, clone.Read(0x4000));
+
+        cartridge_.Write(0x0000, 0x0A); // Enable the RAM
+        cartridge_.Write(0xA000, 0x12);
+        std::stringstream with_rom, without_rom;
+        cartridge_.Serialize(with_rom, true);
+        cartridge_.Serialize(without_rom, false);
+        EXPECT_EQ(with_rom.str().size(), without_rom.str().size() + 2 * ROMBankSize + 8);
+
+        clone.Deserialize(without_rom, 0);
+        EXPECT_EQ(cartridge_.GetMBC()->GetROM(), clone.GetMBC()->GetROM());
+        EXPECT_EQ(0x12, clone.Read(0xA000));
+
+        // A state without the ROM cannot be loaded into another cartridge
+        Cartridge other;
+        without_rom.seekg(0);
+        EXPECT_THROW(other.Deserialize(without_rom, 0), SerializationException);
+    }
+
     TEST_F(CartridgeTest, read_ram_size)
     {
         bytes_.at(0x149) = 0x02;
@@ -162,4 +193,106 @@ namespace gandalf {
         bytes_.resize(0x149);
         EXPECT_FALSE(cartridge_.Load(bytes_));
     }
-};
\ No newline at end of file
+
+    class CartridgeRTCTest: public CartridgeTest, public RTCClock {
+    public:
+        CartridgeRTCTest(): time_(0)
+        {
+            bytes_.at(0x147) = 0x10; // MBC3 + TIMER + RAM + BATTERY
+            bytes_.at(0x149) = 0x02;
+        }
+
+        std::uint64_t GetTime() const override { return time_; }
+        bool IsHostTime() const override { return false; }
+
+    protected:
+        void Load(Cartridge& cartridge)
+        {
+            cartridge.SetRTCClock(this);
+            ASSERT_TRUE(cartridge.Load(bytes_));
+            cartridge.Write(0x0000, 0x0A); // Enable the RAM and the clock
+        }
+
+        byte ReadRegister(Cartridge& cartridge, byte index)
+        {
+            cartridge.Write(0x6000, 0x00);
+            cartridge.Write(0x6000, 0x01);
+            cartridge.Write(0x4000, index);
+            return cartridge.Read(0xA000);
+        }
+
+        void WriteRegister(Cartridge& cartridge, byte index, byte value)
+        {
+            cartridge.Write(0x4000, index);
+            cartridge.Write(0xA000, value);
+        }
+
+        std::uint64_t time_;
+    };
+
+    TEST_F(CartridgeRTCTest, clock_follows_time)
+    {
+        Load(cartridge_);
+
+        time_ += static_cast<std::uint64_t>(CPUFrequency) * ((26 * 60 + 3) * 60 + 7) + CPUFrequency / 2;
+        EXPECT_EQ(7, ReadRegister(cartridge_, 0x08));
+        EXPECT_EQ(3, ReadRegister(cartridge_, 0x09));
+        EXPECT_EQ(2, ReadRegister(cartridge_, 0x0A));
+        EXPECT_EQ(1, ReadRegister(cartridge_, 0x0B));
+
+        // The latched registers do not change until the next latch
+        time_ += CPUFrequency;
+        cartridge_.Write(0x4000, 0x08);
+        EXPECT_EQ(7, cartridge_.Read(0xA000));
+        EXPECT_EQ(8, ReadRegister(cartridge_, 0x08));
+    }
+
+    TEST_F(CartridgeRTCTest, halt_and_day_overflow)
+    {
+        Load(cartridge_);
+
+        WriteRegister(cartridge_, 0x0C, 0x41); // Halt, day 256
+        WriteRegister(cartridge_, 0x0B, 0xFF);
+        time_ += static_cast<std::uint64_t>(CPUFrequency) * 100;
+        EXPECT_EQ(0, ReadRegister(cartridge_, 0x08));
+
+        WriteRegister(cartridge_, 0x0C, 0x01);
+        time_ += static_cast<std::uint64_t>(CPUFrequency) * 24 * 60 * 60;
+        EXPECT_EQ(0, ReadRegister(cartridge_, 0x0B));
+        EXPECT_EQ(0x80, ReadRegister(cartridge_, 0x0C));
+    }
+
+    TEST_F(CartridgeRTCTest, save_footer)
+    {
+        Load(cartridge_);
+        time_ += static_cast<std::uint64_t>(CPUFrequency) * 42;
+        ReadRegister(cartridge_, 0x08);
+
+        std::stringstream save;
+        cartridge_.GetMBC()->SaveRAM(save);
+        EXPECT_EQ(RAMBankSize + 48, save.str().size());
+        EXPECT_EQ(42, save.str()[RAMBankSize + 40]); // The timestamp is in emulated seconds
+
+        Cartridge cartridge;
+        Load(cartridge);
+        cartridge.GetMBC()->LoadRAM(save);
+        cartridge.Write(0x4000, 0x08);
+        EXPECT_EQ(42, cartridge.Read(0xA000));
+        EXPECT_EQ(42, ReadRegister(cartridge, 0x08));
+    }
+
+    TEST_F(CartridgeRTCTest, footer_dirty_when_registers_written)
+    {
+        Load(cartridge_);
+        cartridge_.GetMBC()->TakeDirtyFooter();
+
+        // The passing time and latching do not change the data of the footer, only its time
+        time_ += static_cast<std::uint64_t>(CPUFrequency) * 5;
+        ReadRegister(cartridge_, 0x08);
+        EXPECT_FALSE(cartridge_.GetMBC()->TakeDirtyFooter());
+
+        WriteRegister(cartridge_, 0x0C, 0x40);
+        EXPECT_TRUE(cartridge_.GetMBC()->TakeDirtyFooter());
+        EXPECT_FALSE(cartridge_.GetMBC()->TakeDirtyFooter());
+    }
+};
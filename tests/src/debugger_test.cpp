@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <gandalf/gameboy.h>
+#include <gandalf/memory.h>
+#include <gandalf/wram.h>
+
+#include "resource_helper.h"
+
+using namespace gandalf;
+
+namespace {
+    struct Access {
+        word address;
+        byte value;
+        bool write;
+    };
+
+    class RecordingListener: public Memory::WatchListener {
+    public:
+        void OnWatchpoint(word address, byte value, bool write) override { accesses.push_back(Access{ address, value, write }); }
+
+        std::vector<Access> accesses;
+    };
+
+    class StoppingListener: public Gameboy::DebugListener {
+    public:
+        bool OnBreakpoint(word, word address) override { breakpoints.push_back(address); return true; }
+        bool OnWatchpoint(word address, byte value, bool write) override { accesses.push_back(Access{ address, value, write }); return true; }
+
+        std::vector<Access> accesses;
+        std::vector<word> breakpoints;
+    };
+
+    class ConstantHandler: public Memory::AddressHandler {
+    public:
+        ConstantHandler(): Memory::AddressHandler("Constant") {}
+
+        void Write(word, byte) override {}
+        byte Read(word) const override { return 0x5A; }
+        std::set<word> GetAddresses() const override { return { 0x0010, 0x4000 }; }
+    };
+}
+
+TEST(Memory, watchpoints)
+{
+    Memory memory;
+    WRAM wram(GameboyMode::DMG);
+    memory.Register(wram);
+
+    RecordingListener listener;
+    memory.SetWatchListener(&listener);
+    memory.SetWatchpoint(0xC000, false, true);
+    memory.SetWatchpoint(0xC001, true, false);
+
+    memory.Write(0xC000, 0x12);
+    memory.Write(0xC001, 0x34);
+    EXPECT_EQ(memory.Read(0xC000), 0x12);
+    EXPECT_EQ(memory.Read(0xC001), 0x34);
+    memory.Read(0xC001, false); // Accesses that bypass the access checks are not reported
+
+    ASSERT_EQ(listener.accesses.size(), 2u);
+    EXPECT_EQ(listener.accesses[0].address, 0xC000);
+    EXPECT_EQ(listener.accesses[0].value, 0x12);
+    EXPECT_TRUE(listener.accesses[0].write);
+    EXPECT_EQ(listener.accesses[1].address, 0xC001);
+    EXPECT_EQ(listener.accesses[1].value, 0x34);
+    EXPECT_FALSE(listener.accesses[1].write);
+
+    // Watchpoints do not affect blocking
+    memory.SetWatchpoint(0xC000, true, true);
+    memory.Block(Memory::Bus::External);
+    EXPECT_EQ(memory.Read(0xC000), 0xFF);
+    memory.Block(Memory::Bus::External, false);
+    memory.SetWatchpoint(0xC000, false, false);
+    EXPECT_EQ(memory.Read(0xC000), 0x12);
+    EXPECT_EQ(listener.accesses.size(), 2u);
+
+    memory.Unregister(wram);
+}
+
+TEST(Memory, breakpoints)
+{
+    Memory memory;
+    memory.AddBreakpoint(Memory::AnyBank, 0x150);
+    memory.AddBreakpoint(1, 0x4000);
+    memory.AddBreakpoint(0, 0x4000);
+
+    EXPECT_TRUE(memory.IsBreakpoint(0x150));
+    EXPECT_TRUE(memory.IsBreakpoint(0x4000));
+    EXPECT_FALSE(memory.HasBreakpoint(0x151));
+
+    memory.RemoveBreakpoint(0, 0x4000);
+    EXPECT_TRUE(memory.HasBreakpoint(0x4000));
+    EXPECT_FALSE(memory.IsBreakpoint(0x4000)); // Unmapped memory is in bank 0
+    memory.RemoveBreakpoint(1, 0x4000);
+    EXPECT_FALSE(memory.HasBreakpoint(0x4000));
+}
+
+class DebuggerTest: public ::testing::Test, protected ResourceHelper {
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(ReadFileBytes("/blargg/cpu_instrs/01-special.gb", rom_));
+        ASSERT_TRUE(gb_.LoadROM(rom_));
+        gb_.SetDebugListener(&listener_);
+    }
+
+    ROM rom_;
+    Gameboy gb_{ Model::DMG };
+    StoppingListener listener_;
+};
+
+TEST_F(DebuggerTest, breakpoint_stops_run)
+{
+    gb_.AddBreakpoint(0, 0x100);
+    EXPECT_FALSE(gb_.RunCycles(400 * CyclesPerFrame));
+    EXPECT_EQ(gb_.GetCPU().GetRegisters().program_counter, 0x100);
+    ASSERT_EQ(listener_.breakpoints.size(), 1u);
+
+    // Resuming executes the instruction at the breakpoint
+    EXPECT_TRUE(gb_.RunCycles(4));
+    EXPECT_NE(gb_.GetCPU().GetRegisters().program_counter, 0x100);
+}
+
+TEST_F(DebuggerTest, breakpoint_at_first_instruction)
+{
+    gb_.SetWatchpoint(address::BANK, false, true);
+    EXPECT_FALSE(gb_.RunCycles(400 * CyclesPerFrame));
+    gb_.SetWatchpoint(address::BANK, false, false);
+    ASSERT_EQ(gb_.GetCPU().GetRegisters().program_counter, 0x100);
+
+    // The run was not stopped by a breakpoint, so a breakpoint at the current instruction is reported right away
+    gb_.AddBreakpoint(Memory::AnyBank, 0x100);
+    EXPECT_FALSE(gb_.RunCycles(4));
+    EXPECT_EQ(listener_.breakpoints.size(), 1u);
+
+    // Loading a state forgets the breakpoint that stopped the previous run
+    std::stringstream state;
+    ASSERT_TRUE(gb_.SaveState(state));
+    ASSERT_TRUE(gb_.LoadState(state));
+    EXPECT_FALSE(gb_.RunCycles(4));
+    EXPECT_EQ(listener_.breakpoints.size(), 2u);
+}
+
+TEST_F(DebuggerTest, load_state_keeps_address_handlers)
+{
+    std::stringstream boot_state;
+    ASSERT_TRUE(gb_.SaveState(boot_state));
+    gb_.SetWatchpoint(address::BANK, false, true);
+    EXPECT_FALSE(gb_.RunCycles(400 * CyclesPerFrame));
+    gb_.SetWatchpoint(address::BANK, false, false);
+    EXPECT_TRUE(gb_.RunCycles(4));
+    std::stringstream state;
+    ASSERT_TRUE(gb_.SaveState(state));
+
+    // The handler is registered over the boot ROM and the cartridge, leaving the boot ROM gives only its own addresses back
+    ASSERT_TRUE(gb_.LoadState(boot_state));
+    ConstantHandler handler;
+    gb_.RegisterAddressHandler(handler);
+    ASSERT_TRUE(gb_.LoadState(state));
+    EXPECT_EQ(0x5A, gb_.GetMemory().Read(0x0010, false));
+    EXPECT_EQ(0x5A, gb_.GetMemory().Read(0x4000, false));
+    EXPECT_EQ(rom_[0x0000], gb_.GetMemory().Read(0x0000, false));
+    EXPECT_EQ("Cartridge", gb_.GetMemory().GetAddressHandlerName(0x00FF));
+}
+
+TEST_F(DebuggerTest, watchpoint_stops_run)
+{
+    gb_.SetWatchpoint(address::BANK, false, true);
+    EXPECT_FALSE(gb_.RunCycles(400 * CyclesPerFrame));
+    ASSERT_EQ(listener_.accesses.size(), 1u);
+    EXPECT_EQ(listener_.accesses[0].address, address::BANK);
+    EXPECT_TRUE(listener_.accesses[0].write);
+    EXPECT_EQ(gb_.GetCPU().GetRegisters().program_counter, 0x100); // The write that disables the boot ROM is the last boot ROM instruction
+}
+
+TEST_F(DebuggerTest, run_frame)
+{
+    for (int i = 0; i < 5; ++i)
+    {
+        const std::uint64_t start = gb_.GetCycleCount();
+        EXPECT_TRUE(gb_.RunFrame());
+        EXPECT_LE(gb_.GetCycleCount() - start, static_cast<std::uint64_t>(CyclesPerFrame + 24));
+    }
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <gandalf/exception.h>
+#include <gandalf/frame_sink.h>
+#include <gandalf/pixel_format.h>
+#include <gandalf/serialization.h>
+
+using namespace gandalf;
+
+namespace {
+    // Renders a frame with a vertical bar of color index 3 at the given position and reports VBlank to the sink
+    LCD::VideoBuffer RenderFrame(LCD& lcd, FrameSink& sink, int bar_x)
+    {
+        for (int line = 0; line < ScreenHeight; ++line)
+        {
+            lcd.SetLY(static_cast<byte>(line));
+            for (int x = 0; x < ScreenWidth; ++x)
+                lcd.RenderPixel(static_cast<byte>(x), x == bar_x || x == line ? 3 : 0, false, 0);
+        }
+        lcd.PublishFrame();
+        sink.OnVBlank();
+        return lcd.GetVideoBuffer();
+    }
+}
+
+class FrameSinkTest: public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        lcd_.Write(address::BGP, 0b11100100);
+    }
+
+    LCD lcd_{ GameboyMode::DMG };
+    std::stringstream stream_;
+};
+
+TEST_F(FrameSinkTest, delta_rle_round_trip)
+{
+    std::vector<LCD::VideoBuffer> expected;
+    {
+        FrameSink sink(lcd_, stream_, FrameSink::Format::DeltaRLE);
+        for (int i = 0; i < 4; ++i)
+            expected.push_back(RenderFrame(lcd_, sink, i * 10));
+        expected.push_back(RenderFrame(lcd_, sink, 30));
+        sink.Close();
+        EXPECT_EQ(sink.GetWrittenFrames() + sink.GetDroppedFrames(), expected.size());
+        ASSERT_EQ(sink.GetDroppedFrames(), 0u);
+    }
+
+    // Mostly static frames compress well
+    EXPECT_LT(stream_.str().size(), expected.size() * sizeof(LCD::VideoBuffer) / 10);
+
+    const std::vector<LCD::VideoBuffer> frames = FrameSink::ReadDeltaRLE(stream_);
+    ASSERT_EQ(frames.size(), expected.size());
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        EXPECT_EQ(frames[i], expected[i]) << i;
+}
+
+TEST_F(FrameSinkTest, y4m)
+{
+    FrameSink sink(lcd_, stream_, FrameSink::Format::Y4M, 4);
+    RenderFrame(lcd_, sink, 0);
+    RenderFrame(lcd_, sink, 1);
+    sink.Close();
+    ASSERT_EQ(sink.GetWrittenFrames(), 2u);
+
+    const std::string data = stream_.str();
+    const std::size_t header_end = data.find('\n');
+    ASSERT_NE(header_end, std::string::npos);
+    EXPECT_EQ(data.compare(0, 20, "YUV4MPEG2 W160 H144 "), 0);
+
+    const std::size_t frame_size = 6 + GetFrameSize(PixelFormat::YUV420);
+    ASSERT_EQ(data.size(), header_end + 1 + 2 * frame_size);
+    EXPECT_EQ(data.compare(header_end + 1, 6, "FRAME\n"), 0);
+    EXPECT_EQ(data.compare(header_end + 1 + frame_size, 6, "FRAME\n"), 0);
+}
+
+TEST_F(FrameSinkTest, invalid_recording)
+{
+    std::stringstream stream("GBTR");
+    EXPECT_THROW(FrameSink::ReadDeltaRLE(stream), SerializationException);
+}
+
+TEST_F(FrameSinkTest, oversized_frame)
+{
+    std::stringstream stream;
+    stream.write("GBRL", 4);
+    serialization::Serialize(stream, std::uint16_t(1));
+    serialization::Serialize(stream, std::uint16_t(ScreenWidth));
+    serialization::Serialize(stream, std::uint16_t(ScreenHeight));
+    serialization::Serialize(stream, std::uint32_t(0xFFFFFFFF));
+    EXPECT_THROW(FrameSink::ReadDeltaRLE(stream), SerializationException);
+}
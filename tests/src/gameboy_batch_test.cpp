@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <gandalf/exception.h>
+#include <gandalf/gameboy_batch.h>
+
+#include "resource_helper.h"
+
+using namespace gandalf;
+
+class GameboyBatchTest: public ::testing::Test, protected ResourceHelper {
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(ReadFileBytes("/blargg/cpu_instrs/01-special.gb", rom_));
+    }
+
+    // The memory is randomized at power on, so the references start from the state of the batch
+    std::unique_ptr<Gameboy> CreateReference(const std::string& state)
+    {
+        auto gb = std::make_unique<Gameboy>(Model::DMG);
+        EXPECT_TRUE(gb->LoadROM(rom_));
+        std::istringstream is(state);
+        EXPECT_TRUE(gb->LoadState(is));
+        return gb;
+    }
+
+    ROM rom_;
+};
+
+TEST_F(GameboyBatchTest, identical_input_is_run_once)
+{
+    GameboyBatch batch(Model::DMG, rom_, 16);
+    auto reference = CreateReference(GetState(batch.GetGameboy(0)));
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        for (std::size_t i = 0; i < batch.GetSize(); ++i)
+            batch.SetButtonState(i, Joypad::Start, frame % 2 == 0);
+        reference->SetButtonState(Joypad::Start, frame % 2 == 0);
+
+        batch.RunFrame();
+        reference->RunFrame();
+    }
+
+    EXPECT_EQ(1u, batch.GetGroupCount());
+    EXPECT_TRUE(GetState(batch.GetGameboy(15)) == GetState(*reference));
+}
+
+TEST_F(GameboyBatchTest, diverging_input_splits_groups)
+{
+    GameboyBatch batch(Model::DMG, rom_, 4);
+    const std::string initial_state = GetState(batch.GetGameboy(0));
+    auto idle = CreateReference(initial_state);
+    auto pressed = CreateReference(initial_state);
+
+    for (int frame = 0; frame < 200; ++frame)
+    {
+        if (frame == 100)
+        {
+            batch.SetButtonState(2, Joypad::A, true);
+            pressed->SetButtonState(Joypad::A, true);
+        }
+
+        batch.RunFrame();
+        idle->RunFrame();
+        pressed->RunFrame();
+    }
+
+    EXPECT_EQ(2u, batch.GetGroupCount());
+    EXPECT_TRUE(GetState(batch.GetGameboy(0)) == GetState(*idle));
+    EXPECT_TRUE(GetState(batch.GetGameboy(3)) == GetState(*idle));
+    EXPECT_TRUE(GetState(batch.GetGameboy(2)) == GetState(*pressed));
+    EXPECT_TRUE(GetState(*idle) != GetState(*pressed));
+
+    GameboyBatch::Registers registers;
+    batch.ReadRegisters(registers);
+    std::vector<byte> values;
+    batch.Read(0xFF0F, values);
+    for (std::size_t i = 0; i < batch.GetSize(); ++i)
+    {
+        EXPECT_EQ(batch.GetGameboy(i).GetCPU().GetRegisters().program_counter, registers.program_counter[i]);
+        EXPECT_EQ(batch.GetGameboy(i).GetCPU().GetRegisters().af(), registers.af[i]);
+        EXPECT_EQ(batch.GetGameboy(i).GetMemory().Read(0xFF0F, false), values[i]);
+    }
+}
+
+TEST_F(GameboyBatchTest, invalid_arguments)
+{
+    EXPECT_THROW(GameboyBatch(Model::DMG, rom_, 0), InvalidArgument);
+    EXPECT_THROW(GameboyBatch(Model::DMG, ROM(0x10), 1), InvalidArgument);
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <gandalf/exception.h>
+#include <gandalf/lcd.h>
+
+using namespace gandalf;
+
+namespace {
+    // Fills the first pixel of the frame that is being rendered with the given color index
+    void RenderFrame(LCD& lcd, byte color_index)
+    {
+        lcd.SetLY(0);
+        lcd.RenderPixel(0, color_index, false, 0);
+        lcd.PublishFrame();
+    }
+
+    // Renders every pixel of the frame with color index 0, except for the given pixel
+    void RenderFullFrame(LCD& lcd, int x, int y, byte color_index)
+    {
+        for (int line = 0; line < ScreenHeight; ++line)
+        {
+            lcd.SetLY(static_cast<byte>(line));
+            for (int i = 0; i < ScreenWidth; ++i)
+                lcd.RenderPixel(static_cast<byte>(i), i == x && line == y ? color_index : 0, false, 0);
+        }
+        lcd.PublishFrame();
+    }
+}
+
+class LCDTest: public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        lcd_.Write(address::BGP, 0b11100100);
+        RenderFrame(lcd_, 0);
+        const LCD::VideoBuffer* frame = lcd_.AcquireFrame();
+        ASSERT_NE(frame, nullptr);
+        color_[0] = (*frame)[0];
+        lcd_.ReleaseFrame();
+        RenderFrame(lcd_, 3);
+        frame = lcd_.AcquireFrame();
+        ASSERT_NE(frame, nullptr);
+        color_[1] = (*frame)[0];
+        lcd_.ReleaseFrame();
+        ASSERT_NE(color_[0], color_[1]);
+    }
+
+    LCD lcd_{ GameboyMode::DMG };
+    LCD::ABGR1555 color_[2];
+};
+
+TEST_F(LCDTest, no_new_frame)
+{
+    EXPECT_EQ(lcd_.AcquireFrame(), nullptr);
+}
+
+TEST_F(LCDTest, video_buffer_is_last_completed_frame)
+{
+    RenderFrame(lcd_, 3);
+    RenderFrame(lcd_, 0);
+    EXPECT_EQ(lcd_.GetVideoBuffer()[0], color_[0]);
+
+    // Rendering the next frame does not change it, also while the reader holds a frame
+    const LCD::VideoBuffer* frame = lcd_.AcquireFrame();
+    ASSERT_NE(frame, nullptr);
+    lcd_.SetLY(0);
+    lcd_.RenderPixel(0, 3, false, 0);
+    EXPECT_EQ(lcd_.GetVideoBuffer()[0], color_[0]);
+    lcd_.ReleaseFrame();
+
+    lcd_.PublishFrame();
+    EXPECT_EQ(lcd_.GetVideoBuffer()[0], color_[1]);
+}
+
+TEST_F(LCDTest, latest_frame_is_acquired)
+{
+    RenderFrame(lcd_, 3);
+    RenderFrame(lcd_, 0);
+
+    const LCD::VideoBuffer* frame = lcd_.AcquireFrame();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ((*frame)[0], color_[0]);
+    lcd_.ReleaseFrame();
+    EXPECT_EQ(lcd_.AcquireFrame(), nullptr);
+}
+
+TEST_F(LCDTest, acquired_frame_is_not_modified)
+{
+    RenderFrame(lcd_, 0);
+    const LCD::VideoBuffer* frame = lcd_.AcquireFrame();
+    ASSERT_NE(frame, nullptr);
+
+    // The emulation continues while the frame is acquired
+    for (int i = 0; i < 5; ++i)
+        RenderFrame(lcd_, 3);
+    EXPECT_EQ((*frame)[0], color_[0]);
+    EXPECT_THROW(lcd_.AcquireFrame(), Exception);
+
+    lcd_.ReleaseFrame();
+    frame = lcd_.AcquireFrame();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ((*frame)[0], color_[1]);
+    lcd_.ReleaseFrame();
+}
+
+TEST_F(LCDTest, observation)
+{
+    lcd_.SetObservationOutput(true);
+    lcd_.SetColorOutput(false);
+    lcd_.SetLY(0);
+    lcd_.RenderPixel(0, 2, false, 0);
+    lcd_.RenderPixel(1, 3, true, 0);
+    lcd_.PublishFrame();
+
+    const LCD::VideoBuffer* frame = lcd_.AcquireFrame();
+    ASSERT_NE(frame, nullptr);
+    const Observation* observation = lcd_.GetAcquiredObservation();
+    ASSERT_NE(observation, nullptr);
+    EXPECT_EQ(observation->color_indices[0], 2);
+    EXPECT_EQ(observation->color_indices[1], 3);
+    EXPECT_FALSE(observation->IsSprite(0));
+    EXPECT_TRUE(observation->IsSprite(1));
+    EXPECT_EQ(observation->sprite_mask[0] & 0xC0, 0x40);
+    lcd_.ReleaseFrame();
+    EXPECT_EQ(lcd_.GetAcquiredObservation(), nullptr);
+}
+
+TEST_F(LCDTest, frame_hash)
+{
+    RenderFullFrame(lcd_, 0, 0, 0);
+    const std::uint64_t hash = lcd_.GetFrameHash();
+    RenderFullFrame(lcd_, 0, 0, 0);
+    EXPECT_EQ(lcd_.GetFrameHash(), hash);
+    EXPECT_TRUE(lcd_.IsFrameUnchanged());
+
+    RenderFullFrame(lcd_, 100, 143, 3);
+    EXPECT_NE(lcd_.GetFrameHash(), hash);
+    EXPECT_FALSE(lcd_.IsFrameUnchanged());
+
+    RenderFullFrame(lcd_, 0, 0, 0);
+    EXPECT_EQ(lcd_.GetFrameHash(), hash);
+    EXPECT_FALSE(lcd_.IsFrameUnchanged());
+
+    ASSERT_NE(lcd_.AcquireFrame(), nullptr);
+    EXPECT_EQ(lcd_.GetAcquiredFrameHash(), hash);
+    lcd_.ReleaseFrame();
+}
+
+TEST_F(LCDTest, dirty_lines)
+{
+    RenderFullFrame(lcd_, 0, 0, 0);
+    RenderFullFrame(lcd_, 0, 0, 0);
+    EXPECT_TRUE(lcd_.GetDirtyLines().none());
+    ASSERT_NE(lcd_.AcquireFrame(), nullptr);
+    lcd_.ReleaseFrame();
+
+    RenderFullFrame(lcd_, 5, 10, 3);
+    EXPECT_EQ(lcd_.GetDirtyLines().count(), 1u);
+    EXPECT_TRUE(lcd_.GetDirtyLines()[10]);
+
+    // The reader skipped the previous frame, so its changes are included in the acquired frame
+    RenderFullFrame(lcd_, 5, 10, 3);
+    EXPECT_TRUE(lcd_.GetDirtyLines().none());
+    ASSERT_NE(lcd_.AcquireFrame(), nullptr);
+    EXPECT_EQ(lcd_.GetAcquiredDirtyLines().count(), 1u);
+    EXPECT_TRUE(lcd_.GetAcquiredDirtyLines()[10]);
+    lcd_.ReleaseFrame();
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <gandalf/link_cable.h>
+
+#include "resource_helper.h"
+
+using namespace gandalf;
+
+class LinkCableTest: public ::testing::Test, protected ResourceHelper {
+protected:
+    // Replaces the program of a test ROM, the header is kept so that the boot ROM accepts it
+    ROM CreateROM(const std::vector<byte>& program)
+    {
+        ROM rom;
+        EXPECT_TRUE(ReadFileBytes("/blargg/cpu_instrs/01-special.gb", rom));
+        const std::vector<byte> jump = { 0xC3, 0x50, 0x01 }; // JP 0x0150
+        std::copy(jump.begin(), jump.end(), rom.begin() + 0x101);
+        std::copy(program.begin(), program.end(), rom.begin() + 0x150);
+        return rom;
+    }
+
+    // Runs the instance up to the start of the program
+    void RunToProgram(Gameboy& gb)
+    {
+        gb.AddBreakpoint(Memory::AnyBank, 0x150);
+        EXPECT_FALSE(gb.RunCycles(1000 * CyclesPerFrame));
+        gb.RemoveBreakpoint(Memory::AnyBank, 0x150);
+        EXPECT_EQ(0x150, gb.GetCPU().GetRegisters().program_counter);
+    }
+
+    void SetUp() override
+    {
+        ROM rom;
+        ASSERT_TRUE(ReadFileBytes("/blargg/cpu_instrs/01-special.gb", rom));
+        ASSERT_TRUE(first_.LoadROM(rom));
+        ASSERT_TRUE(second_.LoadROM(rom));
+    }
+
+    Gameboy first_{ Model::DMG };
+    Gameboy second_{ Model::CGB };
+};
+
+TEST_F(LinkCableTest, instances_run_in_lockstep)
+{
+    LinkCable cable(first_, second_);
+    for (int i = 0; i < 10; ++i)
+    {
+        ASSERT_TRUE(cable.RunFrame());
+
+        const std::uint64_t expected = static_cast<std::uint64_t>(i + 1) * CyclesPerFrame;
+        EXPECT_GE(first_.GetCycleCount(), expected);
+        EXPECT_GE(second_.GetCycleCount(), expected);
+        EXPECT_LT(first_.GetCycleCount() - expected, 24u);
+        EXPECT_LT(second_.GetCycleCount() - expected, 24u);
+    }
+}
+
+TEST_F(LinkCableTest, breakpoint_stops_both_instances)
+{
+    LinkCable cable(first_, second_);
+    first_.AddBreakpoint(Memory::AnyBank, 0x100);
+    EXPECT_FALSE(cable.RunCycles(1000 * CyclesPerFrame));
+    EXPECT_EQ(first_.GetCPU().GetRegisters().program_counter, 0x100);
+    EXPECT_LE(second_.GetCycleCount(), first_.GetCycleCount());
+}
+
+TEST_F(LinkCableTest, second_instance_as_clock_master)
+{
+    // The first instance waits for a transfer with 0x99 and replaces it with 0x55 after about 1000 cycles
+    Gameboy first(Model::CGB);
+    ASSERT_TRUE(first.LoadROM(CreateROM({
+        0x3E, 0x99, 0xE0, 0x01, // LD A, 0x99; LDH (SB), A
+        0x3E, 0x80, 0xE0, 0x02, // LD A, 0x80; LDH (SC), A
+        0x06, 0x40, 0x05, 0x20, 0xFD, // LD B, 0x40; DEC B; JR NZ, -3
+        0x3E, 0x55, 0xE0, 0x01, // LD A, 0x55; LDH (SB), A
+        0x18, 0xFE // JR -2
+    })));
+
+    // The second instance starts a fast transfer of 0x42 after about 200 cycles, which is done long before the first one changes SB
+    Gameboy second(Model::CGB);
+    ASSERT_TRUE(second.LoadROM(CreateROM({
+        0x06, 0x0C, 0x05, 0x20, 0xFD, // LD B, 0x0C; DEC B; JR NZ, -3
+        0x3E, 0x42, 0xE0, 0x01, // LD A, 0x42; LDH (SB), A
+        0x3E, 0x83, 0xE0, 0x02, // LD A, 0x83; LDH (SC), A
+        0x18, 0xFE // JR -2
+    })));
+
+    RunToProgram(first);
+    RunToProgram(second);
+    LinkCable cable(first, second);
+    ASSERT_TRUE(cable.RunCycles(8192));
+
+    EXPECT_EQ(0x99, second.GetSerial().GetCurrentByte());
+    EXPECT_FALSE(second.GetSerial().GetInProgress());
+    EXPECT_FALSE(first.GetSerial().GetInProgress());
+    EXPECT_EQ(0x55, first.GetSerial().GetCurrentByte());
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <gandalf/exception.h>
+#include <gandalf/movie.h>
+
+#include "resource_helper.h"
+
+using namespace gandalf;
+
+class MovieTest: public ::testing::Test, protected ResourceHelper {
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(ReadFileBytes("/blargg/cpu_instrs/01-special.gb", rom_));
+    }
+
+    // Records a session that starts after the boot ROM, with button changes in between and within frames
+    Movie Record(Gameboy& gb)
+    {
+        EXPECT_TRUE(gb.LoadROM(rom_));
+        for (int i = 0; i < 100; ++i)
+            gb.RunFrame();
+
+        MovieRecorder recorder(gb);
+        gb.SetButtonState(Joypad::A, true);
+        gb.RunFrame();
+        gb.SetButtonState(Joypad::Start, true);
+        gb.SetButtonState(Joypad::Start, true); // Not a change, not recorded
+        gb.RunCycles(1234);
+        gb.SetButtonState(Joypad::A, false);
+        gb.RunFrame();
+        gb.SetButtonState(Joypad::Start, false);
+        gb.RunCycles(10 * CyclesPerFrame);
+        return recorder.GetMovie();
+    }
+
+    ROM rom_;
+};
+
+TEST_F(MovieTest, replay_reproduces_the_session)
+{
+    Gameboy recorded(Model::DMG);
+    const Movie movie = Record(recorded);
+    ASSERT_EQ(4u, movie.GetEvents().size());
+    EXPECT_EQ(0u, movie.GetEvents()[0].cycle);
+    EXPECT_EQ(1 << Joypad::A, movie.GetEvents()[0].buttons);
+    EXPECT_EQ(0u, movie.GetEvents()[3].buttons);
+
+    Gameboy gb(Model::DMG);
+    ASSERT_TRUE(gb.LoadROM(rom_));
+    MoviePlayer player(gb, movie);
+    EXPECT_TRUE(player.RunCycles(CyclesPerFrame));
+    EXPECT_FALSE(player.Finished());
+    EXPECT_TRUE(player.RunToEnd());
+    EXPECT_TRUE(player.Finished());
+
+    EXPECT_EQ(movie.GetLength(), player.GetPosition());
+    EXPECT_FALSE(gb.GetJoypad().IsPressed(Joypad::A));
+    EXPECT_TRUE(GetState(gb) == GetState(recorded));
+}
+
+TEST_F(MovieTest, save_load)
+{
+    Gameboy gb(Model::DMG);
+    const Movie movie = Record(gb);
+
+    std::stringstream stream;
+    movie.Save(stream);
+    const Movie loaded = Movie::Load(stream);
+
+    EXPECT_TRUE(loaded.GetState() == movie.GetState());
+    EXPECT_EQ(movie.GetLength(), loaded.GetLength());
+    ASSERT_EQ(movie.GetEvents().size(), loaded.GetEvents().size());
+    for (std::size_t i = 0; i < movie.GetEvents().size(); ++i)
+    {
+        EXPECT_EQ(movie.GetEvents()[i].cycle, loaded.GetEvents()[i].cycle);
+        EXPECT_EQ(movie.GetEvents()[i].buttons, loaded.GetEvents()[i].buttons);
+    }
+
+    // The events take a varint and a byte each
+    EXPECT_LT(stream.str().size(), movie.GetState().size() + 32);
+}
+
+TEST(Movie, load_invalid)
+{
+    std::istringstream not_a_movie("GBMV");
+    EXPECT_THROW(Movie::Load(not_a_movie), SerializationException);
+
+    std::stringstream truncated;
+    Movie("state", { Movie::Event{ 10, 1 } }, 20).Save(truncated);
+    std::istringstream is(truncated.str().substr(0, truncated.str().size() - 1));
+    EXPECT_THROW(Movie::Load(is), SerializationException);
+
+    EXPECT_THROW(Movie("", { Movie::Event{ 10, 1 }, Movie::Event{ 5, 0 } }, 20), InvalidArgument);
+}
@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <gandalf/exception.h>
+#include <gandalf/observation.h>
+
+using namespace gandalf;
+
+TEST(Observation, pack_color_indices)
+{
+    const byte indices[] = { 0, 1, 2, 3, 3, 2, 1, 0, 1, 2 };
+    byte output[3];
+    PackColorIndices(indices, output, std::size(indices));
+    EXPECT_EQ(output[0], 0b00011011);
+    EXPECT_EQ(output[1], 0b11100100);
+    EXPECT_EQ(output[2], 0b01100000);
+}
+
+TEST(Observation, downsample_color_indices)
+{
+    Observation observation{};
+    for (std::size_t i = 0; i < Observation::PixelCount; ++i)
+        observation.color_indices[i] = static_cast<byte>((i % ScreenWidth + i / ScreenWidth) % 4);
+
+    std::vector<byte> output((ScreenWidth / 4) * (ScreenHeight / 4));
+    DownsampleColorIndices(observation, 4, output.data());
+    for (int y = 0; y < ScreenHeight / 4; ++y)
+        for (int x = 0; x < ScreenWidth / 4; ++x)
+            EXPECT_EQ(output[y * (ScreenWidth / 4) + x], observation.color_indices[4 * y * ScreenWidth + 4 * x]);
+
+    EXPECT_THROW(DownsampleColorIndices(observation, 3, output.data()), InvalidArgument);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <gandalf/perf_counters.h>
+
+using namespace gandalf;
+
+TEST(PerfCounters, nested_scopes_are_exclusive)
+{
+    PerfCounters counters;
+    {
+        PerfScope cpu(counters, PerfCounters::Component::CPU);
+        {
+            PerfScope memory(counters, PerfCounters::Component::Memory);
+        }
+        {
+            PerfScope memory(counters, PerfCounters::Component::Memory);
+        }
+    }
+
+    EXPECT_EQ(counters.GetCalls(PerfCounters::Component::CPU), 1u);
+    EXPECT_EQ(counters.GetCalls(PerfCounters::Component::Memory), 2u);
+    EXPECT_EQ(counters.GetCalls(PerfCounters::Component::PPU), 0u);
+    EXPECT_EQ(counters.GetTicks(PerfCounters::Component::PPU), 0u);
+
+    counters.EndFrame();
+    ASSERT_EQ(counters.GetFrames().size(), 1u);
+    const PerfCounters::Frame& frame = counters.GetFrames().front();
+    std::uint64_t total = 0;
+    for (std::uint64_t ticks : frame.ticks)
+        total += ticks;
+    EXPECT_LE(total, frame.end - frame.start);
+    EXPECT_EQ(frame.ticks[static_cast<std::size_t>(PerfCounters::Component::CPU)], counters.GetTicks(PerfCounters::Component::CPU));
+}
+
+TEST(PerfCounters, frame_history_is_bounded)
+{
+    PerfCounters counters;
+    counters.SetMaxFrames(2);
+    for (int i = 0; i < 5; ++i)
+        counters.EndFrame();
+    EXPECT_EQ(counters.GetFrames().size(), 2u);
+
+    counters.Reset();
+    EXPECT_TRUE(counters.GetFrames().empty());
+}
+
+TEST(PerfCounters, chrome_trace)
+{
+    PerfCounters counters;
+    {
+        PerfScope ppu(counters, PerfCounters::Component::PPU);
+    }
+    counters.EndFrame();
+
+    std::ostringstream trace;
+    counters.WriteChromeTrace(trace);
+    const std::string json = trace.str();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"PPU\"}"), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":0.000"), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+}
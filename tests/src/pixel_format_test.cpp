@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <gandalf/pixel_format.h>
+
+using namespace gandalf;
+
+namespace {
+    constexpr LCD::ABGR1555 kWhite = 0x7FFF;
+    constexpr LCD::ABGR1555 kBlack = 0x0000;
+
+    // 5 bit channels are expanded by replicating the upper bits, so that 0x1F becomes 0xFF
+    byte Expand(unsigned int value)
+    {
+        return static_cast<byte>((value << 3) | (value >> 2));
+    }
+
+    LCD::VideoBuffer CreateFrame(LCD::ABGR1555 color)
+    {
+        LCD::VideoBuffer frame;
+        frame.fill(color);
+        return frame;
+    }
+}
+
+TEST(PixelFormat, rgba8888_all_colors)
+{
+    // The count is not a multiple of the vector width, so the scalar tail is tested as well
+    std::vector<LCD::ABGR1555> input(0x8000 + 3);
+    for (std::size_t i = 0; i < input.size(); ++i)
+        input[i] = static_cast<LCD::ABGR1555>(i);
+
+    std::vector<byte> output(input.size() * 4);
+    ConvertToRGBA8888(input.data(), output.data(), input.size());
+
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        ASSERT_EQ(output[4 * i], Expand(input[i] & 0x1F)) << i;
+        ASSERT_EQ(output[4 * i + 1], Expand((input[i] >> 5) & 0x1F)) << i;
+        ASSERT_EQ(output[4 * i + 2], Expand((input[i] >> 10) & 0x1F)) << i;
+        ASSERT_EQ(output[4 * i + 3], 0xFF) << i;
+    }
+}
+
+TEST(PixelFormat, grayscale8)
+{
+    const LCD::ABGR1555 input[] = { kBlack, kWhite, 0x001F, 0x03E0, 0x7C00, kBlack, kWhite, kBlack, kWhite, 0x03E0, 0x001F };
+    byte output[std::size(input)];
+    ConvertToGrayscale8(input, output, std::size(input));
+
+    const byte expected[] = { 0, 255, 77, 149, 29, 0, 255, 0, 255, 149, 77 };
+    for (std::size_t i = 0; i < std::size(input); ++i)
+        EXPECT_EQ(output[i], expected[i]) << i;
+}
+
+TEST(PixelFormat, frame_sizes)
+{
+    EXPECT_EQ(GetFrameSize(PixelFormat::ABGR1555), 160u * 144u * 2u);
+    EXPECT_EQ(GetFrameSize(PixelFormat::RGBA8888), 160u * 144u * 4u);
+    EXPECT_EQ(GetFrameSize(PixelFormat::Grayscale8), 160u * 144u);
+    EXPECT_EQ(GetFrameSize(PixelFormat::YUV420), 160u * 144u * 3u / 2u);
+}
+
+TEST(PixelFormat, yuv420)
+{
+    std::vector<byte> output(GetFrameSize(PixelFormat::YUV420));
+    const std::size_t luma_size = ScreenWidth * ScreenHeight;
+
+    ConvertFrame(CreateFrame(kWhite), PixelFormat::YUV420, output.data());
+    for (std::size_t i = 0; i < output.size(); ++i)
+        ASSERT_EQ(output[i], i < luma_size ? 235 : 128) << i;
+
+    ConvertFrame(CreateFrame(kBlack), PixelFormat::YUV420, output.data());
+    for (std::size_t i = 0; i < output.size(); ++i)
+        ASSERT_EQ(output[i], i < luma_size ? 16 : 128) << i;
+
+    // Pure blue has the maximum U value and a V value below the neutral value
+    ConvertFrame(CreateFrame(0x7C00), PixelFormat::YUV420, output.data());
+    EXPECT_EQ(output[luma_size], 240);
+    EXPECT_LT(output[luma_size + luma_size / 4], 128);
+}
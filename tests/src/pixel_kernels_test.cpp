@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include <gandalf/pixel_kernels.h>
+
+using namespace gandalf;
+
+namespace {
+    std::vector<byte> RandomBytes(std::size_t count, int modulo)
+    {
+        std::vector<byte> result(count);
+        for (auto& value : result)
+            value = static_cast<byte>(std::rand() % modulo);
+        return result;
+    }
+}
+
+TEST(PixelKernels, decode_tile_rows)
+{
+    // An odd number of rows, so the scalar tail is tested as well
+    constexpr std::size_t kRows = 17;
+    const std::vector<byte> data = RandomBytes(kRows * 2, 256);
+
+    for (bool flip_x : { false, true })
+    {
+        std::vector<byte> output(kRows * 8);
+        kernels::DecodeTileRows(data.data(), kRows, flip_x, output.data());
+
+        for (std::size_t row = 0; row < kRows; ++row)
+        {
+            for (int x = 0; x < 8; ++x)
+            {
+                const int bit = flip_x ? x : 7 - x;
+                const int expected = ((data[row * 2] >> bit) & 1) | (((data[row * 2 + 1] >> bit) & 1) << 1);
+                ASSERT_EQ(output[row * 8 + x], expected) << row << " " << x << " " << flip_x;
+            }
+        }
+    }
+}
+
+TEST(PixelKernels, decode_tile_rows_known_row)
+{
+    const byte data[2] = { 0x3C, 0x7E };
+    byte output[8];
+    kernels::DecodeTileRows(data, 1, false, output);
+
+    const byte expected[8] = { 0, 2, 3, 3, 3, 3, 2, 0 };
+    for (int x = 0; x < 8; ++x)
+        EXPECT_EQ(output[x], expected[x]);
+}
+
+TEST(PixelKernels, merge_sprites)
+{
+    constexpr std::size_t kCount = 160 + 7;
+    const std::vector<byte> background = RandomBytes(kCount, 4);
+    const std::vector<byte> sprite = RandomBytes(kCount, 4);
+    const std::vector<byte> behind = RandomBytes(kCount, 2);
+
+    std::vector<byte> output(kCount), from_sprite(kCount);
+    kernels::MergeSprites(background.data(), sprite.data(), behind.data(), output.data(), from_sprite.data(), kCount);
+
+    for (std::size_t i = 0; i < kCount; ++i)
+    {
+        const bool show = sprite[i] != 0 && !(behind[i] && background[i] != 0);
+        ASSERT_EQ(output[i], show ? sprite[i] : background[i]) << i;
+        ASSERT_EQ(from_sprite[i], show ? 1 : 0) << i;
+    }
+}
+
+TEST(PixelKernels, apply_palette)
+{
+    constexpr std::size_t kCount = 160 + 5;
+    const std::vector<byte> indices = RandomBytes(kCount, 256);
+    const LCD::ABGR1555 palette[4] = { 0x7FFF, 0x5294, 0x8421, 0x0000 };
+
+    std::vector<LCD::ABGR1555> output(kCount);
+    kernels::ApplyPalette(indices.data(), palette, output.data(), kCount);
+
+    for (std::size_t i = 0; i < kCount; ++i)
+        ASSERT_EQ(output[i], palette[indices[i] & 3]) << i;
+}
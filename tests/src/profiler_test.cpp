@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <gandalf/gameboy.h>
+#include <gandalf/profiler.h>
+
+#include "resource_helper.h"
+
+using namespace gandalf;
+
+TEST(Profiler, hot_spots_sorted_by_cycles)
+{
+    Profiler profiler;
+    profiler.OnInstruction(0, 0x100, 0x00, 4);
+    profiler.OnInstruction(1, 0x4000, 0xCB, 8);
+    profiler.OnInstruction(1, 0x4000, 0xCB, 8);
+    profiler.OnInstruction(0, 0x200, 0x18, 12);
+
+    const auto hot_spots = profiler.GetHotSpots();
+    ASSERT_EQ(hot_spots.size(), 3u);
+    EXPECT_EQ(hot_spots[0].location.bank, 1);
+    EXPECT_EQ(hot_spots[0].location.address, 0x4000);
+    EXPECT_EQ(hot_spots[0].counters.instructions, 2u);
+    EXPECT_EQ(hot_spots[0].counters.cycles, 16u);
+    EXPECT_EQ(hot_spots[1].location.address, 0x200);
+    EXPECT_EQ(hot_spots[2].location.address, 0x100);
+
+    EXPECT_EQ(profiler.GetOpcodeCounters()[0xCB].instructions, 2u);
+    EXPECT_EQ(profiler.GetTotalCycles(), 32u);
+}
+
+TEST(Profiler, folded_stacks)
+{
+    Profiler profiler;
+    profiler.OnInstruction(0, 0x150, 0xCD, 24);
+    profiler.OnCall(0, 0x2000);
+    profiler.OnInstruction(0, 0x2000, 0x00, 4);
+    profiler.OnInterrupt(0x40, 20);
+    profiler.OnInstruction(0, 0x40, 0xD9, 16);
+    profiler.OnReturn();
+    profiler.OnInstruction(0, 0x2001, 0xC9, 16);
+    profiler.OnReturn();
+    profiler.OnReturn(); // Unbalanced return is ignored
+    profiler.OnInstruction(0, 0x153, 0x00, 4);
+
+    std::stringstream ss;
+    profiler.WriteFoldedStacks(ss);
+    EXPECT_EQ(ss.str(), "root 28\nroot;00:2000 20\nroot;00:2000;int_0040 36\n");
+}
+
+TEST(Profiler, recursion_deeper_than_stack)
+{
+    Profiler profiler;
+    profiler.OnCall(0, 0x2000);
+    for (int i = 0; i < 300; ++i)
+        profiler.OnCall(0, 0x3000);
+    profiler.OnInstruction(0, 0x3000, 0x00, 4);
+    for (int i = 0; i < 300; ++i)
+        profiler.OnReturn();
+
+    // The calls that did not fit on the stack return without leaving the frames of their callers
+    profiler.OnInstruction(0, 0x2001, 0x00, 8);
+    profiler.OnReturn();
+    profiler.OnInstruction(0, 0x153, 0x00, 16);
+
+    std::stringstream ss;
+    profiler.WriteFoldedStacks(ss);
+    const std::string folded = ss.str();
+    EXPECT_EQ(0u, folded.find("root 16\nroot;00:2000 8\n"));
+    EXPECT_EQ(std::string::npos, folded.find("root;00:3000"));
+    EXPECT_NE(std::string::npos, folded.find(";00:3000 4\n"));
+}
+
+class ProfilerTest: public ::testing::Test, protected ResourceHelper {
+};
+
+TEST_F(ProfilerTest, records_all_cycles)
+{
+    ROM rom;
+    ASSERT_TRUE(ReadFileBytes("/blargg/cpu_instrs/01-special.gb", rom));
+
+    Gameboy gb(Model::DMG);
+    ASSERT_TRUE(gb.LoadROM(rom));
+
+    for (int i = 0; i < 1000; ++i)
+        gb.Run();
+
+    auto profiler = std::make_shared<Profiler>();
+    gb.SetProfiler(profiler);
+
+    const std::uint64_t start = gb.GetCycleCount();
+    for (int i = 0; i < 100000; ++i)
+        gb.Run();
+
+#ifdef GANDALF_ENABLE_PROFILER
+    EXPECT_EQ(profiler->GetTotalCycles(), gb.GetCycleCount() - start);
+    EXPECT_FALSE(profiler->GetHotSpots().empty());
+#else
+    (void)start;
+    EXPECT_EQ(profiler->GetTotalCycles(), 0u);
+#endif
+}
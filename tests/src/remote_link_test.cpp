@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+#include <gandalf/remote_link.h>
+
+#include "resource_helper.h"
+
+using namespace gandalf;
+
+namespace {
+    constexpr std::uint64_t kRunCycles = 400 * CyclesPerFrame; // The ROM prints its name after about 340 frames
+
+    // Endpoint that always receives the same byte, which is the behavior of a partner that replies instantly.
+    class ConstantEndpoint: public SerialEndpoint {
+    public:
+        explicit ConstantEndpoint(byte value): value_(value) {}
+        byte OnTransferCompleted(byte) override { return value_; }
+
+    private:
+        byte value_;
+    };
+
+    // Transport to a partner that is always far ahead and replies to every transfer with the same byte.
+    class ScriptedTransport: public LinkTransport {
+    public:
+        explicit ScriptedTransport(byte reply): reply_(reply) {}
+
+        void Send(const LinkMessage& message) override
+        {
+            if (message.type == LinkMessage::Type::Transfer)
+                messages_.push_back(LinkMessage{ LinkMessage::Type::Reply, message.time, reply_ });
+            messages_.push_back(LinkMessage{ LinkMessage::Type::Sync, message.time + 100 * CyclesPerFrame, 0 });
+        }
+
+        bool Receive(LinkMessage& message, std::chrono::milliseconds) override
+        {
+            if (messages_.empty())
+                return false;
+            message = messages_.front();
+            messages_.pop_front();
+            return true;
+        }
+
+        bool IsConnected() const override { return true; }
+
+    private:
+        byte reply_;
+        std::deque<LinkMessage> messages_;
+    };
+
+    // The memory is randomized at power on, so the instances that are compared must start from the same state
+    void SetState(Gameboy& gb, const std::string& state)
+    {
+        std::istringstream is(state);
+        EXPECT_TRUE(gb.LoadState(is));
+    }
+}
+
+TEST(LinkMessage, encode_decode)
+{
+    const LinkMessage message{ LinkMessage::Type::Reply, 0x0123456789ABCDEF, 0x42 };
+    byte buffer[LinkMessage::Size];
+    message.Encode(buffer);
+
+    const LinkMessage decoded = LinkMessage::Decode(buffer);
+    EXPECT_EQ(decoded.type, LinkMessage::Type::Reply);
+    EXPECT_EQ(decoded.time, 0x0123456789ABCDEFu);
+    EXPECT_EQ(decoded.value, 0x42);
+}
+
+#ifndef _WIN32
+TEST(SocketTransport, send_receive)
+{
+    auto [first, second] = SocketTransport::CreatePair();
+    first->Send(LinkMessage{ LinkMessage::Type::Transfer, 1234, 0x55 });
+    first->Send(LinkMessage{ LinkMessage::Type::Sync, 5678, 0 });
+
+    LinkMessage message;
+    ASSERT_TRUE(second->Receive(message, std::chrono::milliseconds(1000)));
+    EXPECT_EQ(message.type, LinkMessage::Type::Transfer);
+    EXPECT_EQ(message.time, 1234u);
+    EXPECT_EQ(message.value, 0x55);
+    ASSERT_TRUE(second->Receive(message, std::chrono::milliseconds(1000)));
+    EXPECT_EQ(message.time, 5678u);
+    EXPECT_FALSE(second->Receive(message, std::chrono::milliseconds(0)));
+
+    first.reset();
+    EXPECT_FALSE(second->Receive(message, std::chrono::milliseconds(1000)));
+    EXPECT_FALSE(second->IsConnected());
+}
+#endif
+
+class RemoteLinkTest: public ::testing::Test, protected ResourceHelper {
+protected:
+    void SetUp() override
+    {
+        // The test ROM sends its output over the serial port with the internal clock
+        ASSERT_TRUE(ReadFileBytes("/blargg/cpu_instrs/01-special.gb", rom_));
+    }
+
+    ROM rom_;
+};
+
+TEST_F(RemoteLinkTest, misprediction_is_rolled_back)
+{
+    Gameboy reference(Model::DMG);
+    ASSERT_TRUE(reference.LoadROM(rom_));
+    const std::string initial_state = GetState(reference);
+    ConstantEndpoint endpoint(0x00);
+    reference.SetSerialEndpoint(&endpoint);
+    ASSERT_TRUE(reference.RunCycles(kRunCycles));
+
+    Gameboy gb(Model::DMG);
+    ASSERT_TRUE(gb.LoadROM(rom_));
+    SetState(gb, initial_state);
+    RemoteLink link(gb, std::make_unique<ScriptedTransport>(0x00));
+    ASSERT_TRUE(link.RunCycles(kRunCycles));
+
+    EXPECT_GT(link.GetStatistics().transfers_sent, 0u);
+    EXPECT_EQ(link.GetStatistics().mispredictions, 1u); // Only the first byte differs from the initial prediction
+    EXPECT_TRUE(GetState(gb) == GetState(reference));
+}
+
+TEST_F(RemoteLinkTest, instances_on_separate_threads)
+{
+    Gameboy reference(Model::DMG);
+    ASSERT_TRUE(reference.LoadROM(rom_));
+    const std::string initial_state = GetState(reference);
+    ConstantEndpoint endpoint(0xFF);
+    reference.SetSerialEndpoint(&endpoint);
+    ASSERT_TRUE(reference.RunCycles(kRunCycles));
+    const std::string expected_state = GetState(reference);
+
+    auto [first_transport, second_transport] = LoopbackTransport::CreatePair();
+    Gameboy first(Model::DMG), second(Model::DMG);
+    ASSERT_TRUE(first.LoadROM(rom_));
+    ASSERT_TRUE(second.LoadROM(rom_));
+    SetState(first, initial_state);
+    SetState(second, initial_state);
+    RemoteLink first_link(first, std::move(first_transport));
+    RemoteLink second_link(second, std::move(second_transport));
+
+    // Both sides use the internal clock, so every transfer is received by a partner that is not ready and replies with 0xFF
+    std::thread thread([&second_link]() { second_link.RunCycles(kRunCycles); });
+    EXPECT_TRUE(first_link.RunCycles(kRunCycles));
+    thread.join();
+
+    EXPECT_GT(first_link.GetStatistics().transfers_received, 0u);
+    EXPECT_EQ(first_link.GetStatistics().transfers_received, second_link.GetStatistics().transfers_sent);
+    EXPECT_EQ(first_link.GetStatistics().mispredictions, 0u);
+    EXPECT_EQ(second_link.GetStatistics().mispredictions, 0u);
+    EXPECT_TRUE(GetState(first) == expected_state);
+    EXPECT_TRUE(GetState(second) == expected_state);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <gandalf/exception.h>
+#include <gandalf/resampler.h>
+
+using namespace gandalf;
+
+namespace {
+    class CollectingHandler: public APU::OutputHandler
+    {
+    public:
+        std::uint32_t GetNextSampleTime() override { return 1; }
+        void Play(float left, float right) override
+        {
+            left_.push_back(left);
+            right_.push_back(right);
+        }
+
+        std::vector<float> left_;
+        std::vector<float> right_;
+    };
+
+    // Plays a sine wave of the given frequency for the given number of input samples, the right channel is silent
+    void PlaySine(Resampler& resampler, double frequency, std::uint32_t count)
+    {
+        for (std::uint32_t i = 0; i < count; ++i)
+            resampler.Play(static_cast<float>(0.5 * std::sin(2 * 3.14159265358979323846 * frequency * i / Resampler::InputRate)), 0.0f);
+    }
+
+    double RootMeanSquare(const std::vector<float>& samples, std::size_t skip)
+    {
+        double sum = 0;
+        for (std::size_t i = skip; i < samples.size(); ++i)
+            sum += samples[i] * samples[i];
+        return std::sqrt(sum / (samples.size() - skip));
+    }
+}
+
+TEST(Resampler, output_rate)
+{
+    for (std::uint32_t rate : { 32000u, 44100u, 48000u })
+    {
+        auto handler = std::make_shared<CollectingHandler>();
+        Resampler resampler(handler, rate);
+        PlaySine(resampler, 440, Resampler::InputRate);
+        EXPECT_NEAR(static_cast<double>(handler->left_.size()), rate, 1) << rate;
+    }
+}
+
+TEST(Resampler, rate_adjustment)
+{
+    auto handler = std::make_shared<CollectingHandler>();
+    Resampler resampler(handler, 44100);
+    resampler.SetRateAdjustment(1.01);
+    PlaySine(resampler, 440, Resampler::InputRate);
+    EXPECT_NEAR(static_cast<double>(handler->left_.size()), 44541, 1);
+
+    EXPECT_THROW(resampler.SetRateAdjustment(0.1), InvalidArgument);
+}
+
+TEST(Resampler, constant_input)
+{
+    auto handler = std::make_shared<CollectingHandler>();
+    Resampler resampler(handler, 48000);
+    for (int i = 0; i < 1000; ++i)
+        resampler.Play(0.5f, -0.25f);
+
+    ASSERT_GT(handler->left_.size(), 300u);
+    for (std::size_t i = 100; i < handler->left_.size(); ++i)
+    {
+        ASSERT_NEAR(handler->left_[i], 0.5f, 1e-4f) << i;
+        ASSERT_NEAR(handler->right_[i], -0.25f, 1e-4f) << i;
+    }
+}
+
+TEST(Resampler, frequencies_above_output_nyquist_are_removed)
+{
+    // The amplitude of a sine is 0.5, so its RMS is about 0.35
+    auto passed = std::make_shared<CollectingHandler>();
+    Resampler pass(passed, 44100);
+    PlaySine(pass, 1000, Resampler::InputRate / 10);
+    EXPECT_NEAR(RootMeanSquare(passed->left_, 100), 0.3536, 0.01);
+
+    auto removed = std::make_shared<CollectingHandler>();
+    Resampler stop(removed, 44100);
+    PlaySine(stop, 30000, Resampler::InputRate / 10);
+    EXPECT_LT(RootMeanSquare(removed->left_, 100), 0.005);
+}
+
+TEST(Resampler, invalid_arguments)
+{
+    EXPECT_THROW(Resampler(nullptr, 44100), InvalidArgument);
+    EXPECT_THROW(Resampler(std::make_shared<CollectingHandler>(), 0), InvalidArgument);
+}
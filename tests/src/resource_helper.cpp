@@ -1,8 +1,11 @@
 #include "resource_helper.h"
 
+#include <gtest/gtest.h>
+
 #include <iostream>
 #include <stdexcept>
 #include <fstream>
+#include <sstream>
 
 ResourceHelper::ResourceHelper() {
 #ifdef RESOURCE_PATH
@@ -31,3 +34,10 @@ bool ResourceHelper::ReadFileBytes(const std::string& path, std::vector<std::uin
     buffer = file;
     return true;
 }
+
+std::string ResourceHelper::GetState(const gandalf::Gameboy& gb)
+{
+    std::ostringstream os;
+    EXPECT_TRUE(gb.SaveState(os));
+    return os.str();
+}
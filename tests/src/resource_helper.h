@@ -6,6 +6,8 @@
 #include <cstdint>
 #include <vector>
 
+#include <gandalf/gameboy.h>
+
 class ResourceHelper {
 protected:
     ResourceHelper();
@@ -20,6 +22,14 @@ protected:
     */
     bool ReadFileBytes(const std::string& path, std::vector<std::uint8_t>& buffer);
 
+    /**
+     * Saves the state of a Gameboy including the ROM, so that the states of instances can be compared.
+     *
+     * @param gb The Gameboy.
+     * @return The state. The test fails when the state could not be saved.
+    */
+    static std::string GetState(const gandalf::Gameboy& gb);
+
 private:
     std::string resource_path_;
 };
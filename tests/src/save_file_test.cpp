@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <gandalf/exception.h>
+#include <gandalf/gameboy.h>
+#include <gandalf/save_file.h>
+
+namespace gandalf {
+    class SaveFileTest: public ::testing::Test {
+    public:
+        SaveFileTest(): path_(::testing::TempDir() + "gandalf_save_file_test.sav")
+        {
+            std::remove(path_.c_str());
+
+            bytes_.resize(0x8000);
+            bytes_.at(0x147) = 0x03; // MBC1 + RAM + BATTERY
+            bytes_.at(0x149) = 0x03; // 4 banks of RAM
+        }
+
+        ~SaveFileTest() { std::remove(path_.c_str()); }
+
+    protected:
+        void LoadCartridge()
+        {
+            ASSERT_TRUE(cartridge_.Load(bytes_));
+            cartridge_.Write(0x0000, 0x0A); // Enable the RAM
+            cartridge_.Write(0x6000, 0x01); // Advanced banking mode, so that the RAM bank can be selected
+        }
+
+        void WriteRAM(byte bank, word address, byte value)
+        {
+            cartridge_.Write(0x4000, bank);
+            cartridge_.Write(address, value);
+        }
+
+        std::vector<byte> ReadFile() const
+        {
+            std::ifstream file(path_, std::ios::binary);
+            return std::vector<byte>(std::istreambuf_iterator<char>(file), {});
+        }
+
+        std::string path_;
+        ROM bytes_;
+        Cartridge cartridge_;
+    };
+
+    TEST_F(SaveFileTest, creates_file_from_ram)
+    {
+        LoadCartridge();
+        SaveFile save(cartridge_, path_);
+
+        EXPECT_EQ(4 * RAMBankSize, ReadFile().size());
+        EXPECT_EQ(0u, save.GetWrittenBanks());
+    }
+
+    TEST_F(SaveFileTest, writes_only_dirty_banks)
+    {
+        LoadCartridge();
+        SaveFile save(cartridge_, path_, 2);
+
+        WriteRAM(2, 0xA010, 0x42);
+        save.OnVBlank();
+        save.Flush();
+        EXPECT_EQ(1u, save.GetWrittenBanks());
+
+        // Writing the value that is already stored does not mark the bank
+        WriteRAM(2, 0xA010, 0x42);
+        save.Flush();
+        EXPECT_EQ(1u, save.GetWrittenBanks());
+
+        const std::vector<byte> file = ReadFile();
+        ASSERT_EQ(4 * RAMBankSize, file.size());
+        EXPECT_EQ(0x42, file[2 * RAMBankSize + 0x10]);
+    }
+
+    TEST_F(SaveFileTest, changes_are_queued_once_per_interval)
+    {
+        LoadCartridge();
+        SaveFile save(cartridge_, path_, 3);
+
+        WriteRAM(0, 0xA000, 0x01);
+        save.OnVBlank();
+        save.OnVBlank();
+        save.Close();
+        EXPECT_EQ(1u, save.GetWrittenBanks());
+        EXPECT_EQ(0x01, ReadFile()[0]);
+    }
+
+    TEST_F(SaveFileTest, loads_existing_file)
+    {
+        LoadCartridge();
+        {
+            SaveFile save(cartridge_, path_);
+            WriteRAM(3, 0xBFFF, 0x99);
+        }
+
+        Cartridge cartridge;
+        ASSERT_TRUE(cartridge.Load(bytes_));
+        SaveFile save(cartridge, path_);
+        cartridge.Write(0x0000, 0x0A);
+        cartridge.Write(0x6000, 0x01);
+        cartridge.Write(0x4000, 0x03);
+        EXPECT_EQ(0x99, cartridge.Read(0xBFFF));
+    }
+
+    TEST_F(SaveFileTest, keeps_file_smaller_than_ram)
+    {
+        {
+            std::ofstream file(path_, std::ios::binary);
+            file << "short";
+        }
+
+        LoadCartridge();
+        EXPECT_THROW(SaveFile(cartridge_, path_), Exception);
+        EXPECT_EQ(5u, ReadFile().size());
+    }
+
+    TEST_F(SaveFileTest, follows_loaded_state)
+    {
+        Gameboy gb(Model::DMG);
+        ASSERT_TRUE(gb.LoadROM(bytes_));
+        Cartridge& cartridge = gb.GetCartridge();
+        cartridge.Write(0x0000, 0x0A);
+        cartridge.Write(0x6000, 0x01);
+        cartridge.Write(0x4000, 0x01);
+        SaveFile save(cartridge, path_);
+
+        cartridge.Write(0xA010, 0x42);
+        std::stringstream state;
+        ASSERT_TRUE(gb.SaveState(state));
+        cartridge.Write(0xA010, 0x17);
+        save.Flush();
+        EXPECT_EQ(0x17, ReadFile()[RAMBankSize + 0x10]);
+
+        // The state replaces the MBC, all of its banks are written
+        ASSERT_TRUE(gb.LoadState(state));
+        save.Flush();
+        EXPECT_EQ(5u, save.GetWrittenBanks());
+        EXPECT_EQ(0x42, ReadFile()[RAMBankSize + 0x10]);
+    }
+
+    TEST_F(SaveFileTest, flush_writes_running_clock)
+    {
+        class Clock: public RTCClock {
+        public:
+            std::uint64_t GetTime() const override { return time; }
+            bool IsHostTime() const override { return false; }
+
+            std::uint64_t time = 0;
+        } clock;
+
+        bytes_.at(0x147) = 0x10; // MBC3 + TIMER + RAM + BATTERY
+        cartridge_.SetRTCClock(&clock);
+        LoadCartridge();
+        SaveFile save(cartridge_, path_, 1);
+
+        clock.time += static_cast<std::uint64_t>(CPUFrequency) * 5;
+        save.Flush();
+        const std::vector<byte> file = ReadFile();
+        ASSERT_EQ(4 * RAMBankSize + 48, file.size());
+        EXPECT_EQ(5, file[4 * RAMBankSize + 40]); // The timestamp in emulated seconds
+        EXPECT_EQ(0u, save.GetWrittenBanks());
+    }
+
+    TEST_F(SaveFileTest, mismatch_is_reported_by_flush)
+    {
+        LoadCartridge();
+        SaveFile save(cartridge_, path_, 1);
+        WriteRAM(1, 0xA000, 0x42);
+        save.Flush();
+
+        // Another ROM with less RAM replaces the MBC, the VBlank does not throw into the emulation
+        bytes_.at(0x149) = 0x02;
+        LoadCartridge();
+        EXPECT_NO_THROW(save.OnVBlank());
+        EXPECT_THROW(save.Flush(), Exception);
+        EXPECT_THROW(save.Close(), Exception);
+        EXPECT_EQ(0x42, ReadFile()[RAMBankSize]);
+    }
+
+    TEST_F(SaveFileTest, throws_without_battery)
+    {
+        bytes_.at(0x147) = 0x02; // MBC1 + RAM
+        LoadCartridge();
+        EXPECT_THROW(SaveFile(cartridge_, path_), InvalidArgument);
+    }
+} // namespace gandalf
@@ -5,9 +5,22 @@
 
 using namespace gandalf;
 
+namespace {
+    class InterruptFlags: public Memory::AddressHandler {
+    public:
+        InterruptFlags(): Memory::AddressHandler("Interrupt flags"), value(0) {}
+        void Write(word, byte v) override { value = v; }
+        byte Read(word) const override { return value; }
+        std::set<word> GetAddresses() const override { return { address::IF }; }
+
+        byte value;
+    };
+}
+
 TEST(Serial, default_state)
 {
-    Serial serial(GameboyMode::DMG);
+    Memory memory;
+    Serial serial(GameboyMode::DMG, memory);
     EXPECT_EQ(serial.Read(address::SB), 0x00);
     EXPECT_FALSE(serial.GetInProgress());
     EXPECT_FALSE(serial.GetFastClockSpeed());
@@ -16,7 +29,8 @@ TEST(Serial, default_state)
 
 TEST(Serial, fast_clock_speed_cgb)
 {
-    Serial serial(GameboyMode::CGB);
+    Memory memory;
+    Serial serial(GameboyMode::CGB, memory);
     serial.Write(address::SC, 0b10);
     EXPECT_TRUE(serial.GetFastClockSpeed());
 
@@ -26,7 +40,8 @@ TEST(Serial, fast_clock_speed_cgb)
 
 TEST(Serial, fast_clock_speed_dmg_remains_false)
 {
-    Serial serial(GameboyMode::DMG);
+    Memory memory;
+    Serial serial(GameboyMode::DMG, memory);
     serial.Write(address::SC, 0b10);
     EXPECT_FALSE(serial.GetFastClockSpeed());
 
@@ -36,7 +51,8 @@ TEST(Serial, fast_clock_speed_dmg_remains_false)
 
 TEST(Serial, get_addresses)
 {
-    Serial serial(GameboyMode::DMG);
+    Memory memory;
+    Serial serial(GameboyMode::DMG, memory);
     ASSERT_EQ(2u, serial.GetAddresses().size());
     EXPECT_EQ(1u, serial.GetAddresses().count(address::SB));
     EXPECT_EQ(1u, serial.GetAddresses().count(address::SC));
@@ -44,7 +60,8 @@ TEST(Serial, get_addresses)
 
 TEST(Serial, write_sb)
 {
-    Serial serial(GameboyMode::DMG);
+    Memory memory;
+    Serial serial(GameboyMode::DMG, memory);
     serial.Write(address::SB, 0x42);
     EXPECT_EQ(serial.Read(address::SB), 0x42);
     EXPECT_EQ(serial.GetCurrentByte(), 0x42);
@@ -52,16 +69,82 @@ TEST(Serial, write_sb)
 
 TEST(Serial, serialize)
 {
-    Serial serial(GameboyMode::DMG);
+    Memory memory;
+    Serial serial(GameboyMode::DMG, memory);
     serial.Write(address::SB, 0x42);
     serial.Write(address::SC, 0x80);
 
     std::stringstream ss;
     serial.Serialize(ss);
 
-    Serial deserialized(GameboyMode::DMG);
+    Serial deserialized(GameboyMode::DMG, memory);
     deserialized.Deserialize(ss, 1);
 
     EXPECT_EQ(deserialized.GetCurrentByte(), 0x42);
     EXPECT_TRUE(deserialized.GetInProgress());
-}
\ No newline at end of file
+}
+
+TEST(Serial, internal_clock_without_peer_receives_ones)
+{
+    Memory memory;
+    InterruptFlags interrupt_flags;
+    memory.Register(interrupt_flags);
+    Serial serial(GameboyMode::DMG, memory);
+    serial.Write(address::SB, 0x42);
+    serial.Write(address::SC, 0x81);
+
+    for (int i = 0; i < 8 * 512 - 1; ++i)
+        serial.Tick();
+    EXPECT_TRUE(serial.GetInProgress());
+    EXPECT_EQ(interrupt_flags.value, 0);
+
+    serial.Tick();
+    EXPECT_FALSE(serial.GetInProgress());
+    EXPECT_EQ(serial.GetCurrentByte(), 0xFF);
+    EXPECT_EQ(interrupt_flags.value, SerialInterruptMask);
+    memory.Unregister(interrupt_flags);
+}
+
+TEST(Serial, external_clock_waits_for_peer)
+{
+    Memory memory;
+    Serial serial(GameboyMode::DMG, memory);
+    serial.Write(address::SC, 0x80);
+    for (int i = 0; i < 8 * 512; ++i)
+        serial.Tick();
+    EXPECT_TRUE(serial.GetInProgress());
+    EXPECT_EQ(serial.GetCyclesUntilShift(), 0u);
+}
+
+TEST(Serial, exchange_with_peer_cgb_fast_clock)
+{
+    Memory master_memory, slave_memory;
+    InterruptFlags master_interrupt, slave_interrupt;
+    master_memory.Register(master_interrupt);
+    slave_memory.Register(slave_interrupt);
+    Serial master(GameboyMode::CGB, master_memory);
+    Serial slave(GameboyMode::CGB, slave_memory);
+    master.SetPeer(&slave);
+    slave.SetPeer(&master);
+
+    slave.Write(address::SB, 0x5A);
+    slave.Write(address::SC, 0x80);
+    master.Write(address::SB, 0xC3);
+    master.Write(address::SC, 0x83);
+    EXPECT_EQ(master.GetCyclesUntilShift(), 16u);
+
+    for (int i = 0; i < 8 * 16; ++i)
+    {
+        master.Tick();
+        slave.Tick();
+    }
+
+    EXPECT_EQ(master.GetCurrentByte(), 0x5A);
+    EXPECT_EQ(slave.GetCurrentByte(), 0xC3);
+    EXPECT_FALSE(master.GetInProgress());
+    EXPECT_FALSE(slave.GetInProgress());
+    EXPECT_EQ(master_interrupt.value, SerialInterruptMask);
+    EXPECT_EQ(slave_interrupt.value, SerialInterruptMask);
+    master_memory.Unregister(master_interrupt);
+    slave_memory.Unregister(slave_interrupt);
+}
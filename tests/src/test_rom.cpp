@@ -0,0 +1,346 @@
+#include "test_rom.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace {
+    using namespace gandalf;
+    using test_rom::TestROM;
+    using test_rom::Validator;
+
+    std::set<Model> AllModels()
+    {
+        std::set<Model> models;
+        for (int i = 0; i < static_cast<int>(Model::LAST); ++i)
+            models.insert(static_cast<Model>(i));
+        return models;
+    }
+
+    // The model groups of the Mooneye test suite, G: DMG and MGB, S: SGB, C: CGB
+    std::set<Model> GroupGS() { return { Model::DMG0, Model::DMG, Model::MGB, Model::SGB, Model::SGB2 }; }
+    std::set<Model> GroupC() { return { Model::CGB0, Model::CGB }; }
+
+    TestROM Blargg(const std::string& suite, Validator validator, const std::string& path)
+    {
+        return TestROM{ suite, path, validator, AllModels() };
+    }
+
+    TestROM Mooneye(const std::string& suite, const std::string& path, std::set<Model> models = AllModels())
+    {
+        return TestROM{ suite, path, Validator::Mooneye, models };
+    }
+
+    std::vector<TestROM> CreateTestROMs()
+    {
+        return {
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/01-special.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/02-interrupts.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/03-op sp,hl.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/04-op r,imm.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/05-op rp.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/06-ld r,r.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/07-jr,jp,call,ret,rst.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/08-misc instrs.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/09-op r,r.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/10-bit ops.gb"),
+            Blargg("cpu_instrs", Validator::BlarggSerial, "cpu_instrs/11-op a,(hl).gb"),
+
+            Blargg("mem_timing", Validator::BlarggSerial, "mem_timing/01-read_timing.gb"),
+            Blargg("mem_timing", Validator::BlarggSerial, "mem_timing/02-write_timing.gb"),
+            Blargg("mem_timing", Validator::BlarggSerial, "mem_timing/03-modify_timing.gb"),
+
+            Blargg("mem_timing2", Validator::BlarggMemory, "mem_timing-2/01-read_timing.gb"),
+            Blargg("mem_timing2", Validator::BlarggMemory, "mem_timing-2/02-write_timing.gb"),
+            Blargg("mem_timing2", Validator::BlarggMemory, "mem_timing-2/03-modify_timing.gb"),
+
+            Blargg("instr_timing", Validator::BlarggSerial, "instr_timing/instr_timing.gb"),
+
+            Mooneye("acceptance_timer", "acceptance/timer/div_write.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/rapid_toggle.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim00_div_trigger.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim00.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim00_div_trigger.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim01.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim01_div_trigger.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim10.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim10_div_trigger.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim11.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tim11_div_trigger.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tima_reload.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tima_write_reloading.gb"),
+            Mooneye("acceptance_timer", "acceptance/timer/tma_write_reloading.gb"),
+
+            Mooneye("acceptance_bits", "acceptance/bits/mem_oam.gb"),
+            Mooneye("acceptance_bits", "acceptance/bits/reg_f.gb"),
+            Mooneye("acceptance_bits", "acceptance/bits/unused_hwio-GS.gb", GroupGS()),
+            //Mooneye("acceptance_bits", "misc/bits/unused_hwio-C.gb", GroupC()),
+
+            Mooneye("acceptance_instr", "acceptance/instr/daa.gb"),
+
+            Mooneye("acceptance_interrupts", "acceptance/interrupts/ie_push.gb"),
+
+            Mooneye("acceptance_oem_dma", "acceptance/oam_dma/basic.gb"),
+            Mooneye("acceptance_oem_dma", "acceptance/oam_dma/reg_read.gb"),
+            Mooneye("acceptance_oem_dma", "acceptance/oam_dma/sources-GS.gb"),
+
+            //Mooneye("acceptance_serial", "acceptance/interrupts/boot_sclk_align-dmgABCmgb.gb"),
+
+            //Mooneye("acceptance_ppu", "acceptance/ppu/hblank_ly_scx_timing-GS.gb", GroupGS()),
+            Mooneye("acceptance_ppu", "acceptance/ppu/intr_1_2_timing-GS.gb", GroupGS()),
+            Mooneye("acceptance_ppu", "acceptance/ppu/intr_2_0_timing.gb"),
+            Mooneye("acceptance_ppu", "acceptance/ppu/intr_2_mode0_timing.gb"),
+            //Mooneye("acceptance_ppu", "acceptance/ppu/intr_2_mode0_timing_sprites.gb"),
+            Mooneye("acceptance_ppu", "acceptance/ppu/intr_2_mode3_timing.gb"),
+            //Mooneye("acceptance_ppu", "acceptance/ppu/intr_2_oam_ok_timing.gb"),
+            //Mooneye("acceptance_ppu", "acceptance/ppu/lcdon_timing-GS.gb", GroupGS()),
+            //Mooneye("acceptance_ppu", "acceptance/ppu/lcdon_write_timing-GS.gb", GroupGS()),
+            //Mooneye("acceptance_ppu", "acceptance/ppu/stat_irq_blocking.gb"),
+            //Mooneye("acceptance_ppu", "acceptance/ppu/stat_lyc_onoff.gb"),
+            Mooneye("acceptance_ppu", "acceptance/ppu/vblank_stat_intr-GS.gb", GroupGS()),
+            //Mooneye("acceptance_ppu", "misc/ppu/vblank_stat_intr-C.gb", GroupC()), // Too late: on CGB stat_m2_144 is triggered one cycle before a vblank is
+
+            Mooneye("acceptance", "acceptance/add_sp_e_timing.gb"),
+
+            // TODO These tests fail because executing the boot rom takes too long??
+            // The value of the DIV register is incorrect when the boot ROM finishes.
+
+            //Mooneye("acceptance", "acceptance/boot_div2-S.gb"),
+            //Mooneye("acceptance", "acceptance/boot_div-dmg0.gb", { Model::DMG0 }),
+            //Mooneye("acceptance", "acceptance/boot_div-dmgABCmgb.gb", { Model::DMG, Model::MGB }),
+            //Mooneye("acceptance", "acceptance/boot_div-S.gb", { Model::SGB, Model::SGB2 }),
+            //Mooneye("acceptance", "acceptance/boot_hwio-dmg0.gb", { Model::DMG0 }),
+            //Mooneye("acceptance", "acceptance/boot_hwio-dmgABCmgb.gb", { Model::DMG, Model::MGB }),
+            //Mooneye("acceptance", "acceptance/boot_hwio-S.gb", { Model::SGB, Model::SGB2 }),
+            Mooneye("acceptance", "acceptance/boot_regs-dmg0.gb", { Model::DMG0 }),
+            Mooneye("acceptance", "acceptance/boot_regs-dmgABC.gb", { Model::DMG }),
+            Mooneye("acceptance", "acceptance/boot_regs-mgb.gb", { Model::MGB }),
+            Mooneye("acceptance", "acceptance/boot_regs-sgb.gb", { Model::SGB }),
+            Mooneye("acceptance", "acceptance/boot_regs-sgb2.gb", { Model::SGB2 }),
+            Mooneye("acceptance", "acceptance/call_cc_timing.gb"),
+            Mooneye("acceptance", "acceptance/call_cc_timing2.gb"),
+            Mooneye("acceptance", "acceptance/call_timing.gb"),
+            Mooneye("acceptance", "acceptance/call_timing2.gb"),
+            Mooneye("acceptance", "acceptance/di_timing-GS.gb", GroupGS()),
+            Mooneye("acceptance", "acceptance/div_timing.gb"),
+            Mooneye("acceptance", "acceptance/ei_sequence.gb"),
+            Mooneye("acceptance", "acceptance/ei_timing.gb"),
+            Mooneye("acceptance", "acceptance/halt_ime0_ei.gb"),
+            Mooneye("acceptance", "acceptance/halt_ime0_nointr_timing.gb"),
+            Mooneye("acceptance", "acceptance/halt_ime1_timing.gb"),
+            Mooneye("acceptance", "acceptance/halt_ime1_timing2-GS.gb", GroupGS()),
+            Mooneye("acceptance", "acceptance/if_ie_registers.gb"),
+            Mooneye("acceptance", "acceptance/intr_timing.gb"),
+            Mooneye("acceptance", "acceptance/jp_cc_timing.gb"),
+            Mooneye("acceptance", "acceptance/jp_timing.gb"),
+            Mooneye("acceptance", "acceptance/ld_hl_sp_e_timing.gb"),
+            Mooneye("acceptance", "acceptance/oam_dma_start.gb"),
+            Mooneye("acceptance", "acceptance/oam_dma_timing.gb"),
+            Mooneye("acceptance", "acceptance/oam_dma_restart.gb"),
+            Mooneye("acceptance", "acceptance/pop_timing.gb"),
+            Mooneye("acceptance", "acceptance/push_timing.gb"),
+            Mooneye("acceptance", "acceptance/rapid_di_ei.gb"),
+            Mooneye("acceptance", "acceptance/ret_cc_timing.gb"),
+            Mooneye("acceptance", "acceptance/ret_timing.gb"),
+            Mooneye("acceptance", "acceptance/reti_intr_timing.gb"),
+            Mooneye("acceptance", "acceptance/reti_timing.gb"),
+            Mooneye("acceptance", "acceptance/rst_timing.gb"),
+            //Mooneye("acceptance", "misc/boot_div-cgb0.gb", { Model::CGB0 }),
+            //Mooneye("acceptance", "misc/boot_div-cgbABCDE.gb", { Model::CGB }),
+            //Mooneye("acceptance", "misc/boot_hwio-C.gb", GroupC()),
+            Mooneye("acceptance", "misc/boot_regs-cgb.gb", GroupC()),
+
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/bits_bank1.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/bits_bank2.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/bits_mode.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/bits_ramg.gb"),
+            //Mooneye("emulator_only_mbc1", "emulator-only/mbc1/multicart_rom_8Mb.gb"), // This test requires a way of detecting multicart ROMs which is not implemented
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/ram_64kb.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/ram_256kb.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/rom_1Mb.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/rom_2Mb.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/rom_4Mb.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/rom_8Mb.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/rom_16Mb.gb"),
+            Mooneye("emulator_only_mbc1", "emulator-only/mbc1/rom_512kb.gb"),
+
+            Mooneye("emulator_only_mbc5", "emulator-only/mbc5/rom_1Mb.gb"),
+            Mooneye("emulator_only_mbc5", "emulator-only/mbc5/rom_2Mb.gb"),
+            Mooneye("emulator_only_mbc5", "emulator-only/mbc5/rom_4Mb.gb"),
+            Mooneye("emulator_only_mbc5", "emulator-only/mbc5/rom_8Mb.gb"),
+            Mooneye("emulator_only_mbc5", "emulator-only/mbc5/rom_16Mb.gb"),
+            Mooneye("emulator_only_mbc5", "emulator-only/mbc5/rom_32Mb.gb"),
+            Mooneye("emulator_only_mbc5", "emulator-only/mbc5/rom_64Mb.gb"),
+            Mooneye("emulator_only_mbc5", "emulator-only/mbc5/rom_512kb.gb"),
+        };
+    }
+
+    // Blargg's tests write their output to serial, this handler replaces the serial registers and collects the characters
+    class BlarggSerialReader: public Memory::AddressHandler
+    {
+    public:
+        BlarggSerialReader(): Memory::AddressHandler("TestROM - BlarggSerialReader"), last_character_(0), done_(false) {}
+
+        void Write(word address, byte value) override
+        {
+            if (address == address::SC) {
+                if (value == 0x81) {
+                    output_ += static_cast<char>(last_character_);
+                    done_ = output_.find("Pass") != std::string::npos || output_.find("Fail") != std::string::npos;
+                }
+            }
+            else
+                last_character_ = value;
+        }
+
+        byte Read(word) const override { return 0xFF; }
+        std::set<word> GetAddresses() const override { return { address::SB, address::SC }; }
+
+        bool Done() const { return done_; }
+        bool Passed() const { return output_.find("Pass") != std::string::npos; }
+        const std::string& GetOutput() const { return output_; }
+
+    private:
+        byte last_character_;
+        std::string output_;
+        bool done_;
+    };
+
+    // Mooneye's tests write the Fibonacci numbers 3, 5, 8, 13, 21, 34 to serial when passing
+    class MooneyeSerialReader: public Memory::AddressHandler
+    {
+    public:
+        MooneyeSerialReader(): Memory::AddressHandler("TestROM - MooneyeSerialReader"), sb_(0), sc_(0) {}
+
+        void Write(word address, byte value) override
+        {
+            if (address == address::SB) {
+                serial_bytes_.push_back(value);
+                sb_ = value;
+            }
+            else
+                sc_ = value;
+        }
+
+        byte Read(word address) const override { return address == address::SB ? sb_ : sc_ | 0x7E; }
+        std::set<word> GetAddresses() const override { return { address::SB, address::SC }; }
+
+        bool Done() const { return serial_bytes_.size() >= 6; }
+
+        bool Passed() const
+        {
+            return serial_bytes_.size() == 6 && serial_bytes_[0] == 3 && serial_bytes_[1] == 5
+                && serial_bytes_[2] == 8 && serial_bytes_[3] == 13 && serial_bytes_[4] == 21 && serial_bytes_[5] == 34;
+        }
+
+    private:
+        byte sb_;
+        byte sc_;
+        std::vector<byte> serial_bytes_;
+    };
+
+    // Blargg's tests that write their output to memory: 0xA000 holds the status, 0x80 while running, and 0xA001-0xA003 a signature
+    bool IsMemoryResultValid(const Memory& memory)
+    {
+        return memory.Read(0xA001, false) == 0xDE && memory.Read(0xA002, false) == 0xB0 && memory.Read(0xA003, false) == 0x61;
+    }
+
+    void RunUntil(Gameboy& gb, std::uint64_t max_cycles, const std::function<bool()>& done)
+    {
+        while (!done() && gb.GetCycleCount() < max_cycles)
+            gb.Run();
+    }
+}
+
+namespace test_rom {
+    std::ostream& operator<<(std::ostream& os, const TestROM& test)
+    {
+        os << test.path;
+        return os;
+    }
+
+    std::string GetResourcePath(const TestROM& test)
+    {
+        return (test.validator == Validator::Mooneye ? "mooneye/" : "blargg/") + test.path;
+    }
+
+    const std::vector<TestROM>& GetTestROMs()
+    {
+        static const std::vector<TestROM> tests = CreateTestROMs();
+        return tests;
+    }
+
+    std::vector<TestROM> GetTestROMs(const std::string& suite)
+    {
+        std::vector<TestROM> result;
+        for (const TestROM& test : GetTestROMs())
+        {
+            if (test.suite == suite)
+                result.push_back(test);
+        }
+        return result;
+    }
+
+    Result Run(const TestROM& test, const ROM& rom, Model model, std::uint64_t max_cycles)
+    {
+        Result result;
+        auto gb = std::make_unique<Gameboy>(model);
+        if (!gb->LoadROM(rom))
+        {
+            result.output = "Failed to load the ROM";
+            return result;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        switch (test.validator)
+        {
+        case Validator::BlarggSerial:
+        {
+            BlarggSerialReader reader;
+            gb->RegisterAddressHandler(reader);
+            RunUntil(*gb, max_cycles, [&reader]() { return reader.Done(); });
+            result.timed_out = !reader.Done();
+            result.passed = reader.Passed();
+            result.output = reader.GetOutput();
+            break;
+        }
+        case Validator::BlarggMemory:
+        {
+            // The status is only checked every once in a while, reading it after every instruction would dominate the run time
+            const Memory& memory = gb->GetMemory();
+            std::uint64_t next_check = 0;
+            bool done = false;
+            RunUntil(*gb, max_cycles, [&]() {
+                if (gb->GetCycleCount() < next_check)
+                    return false;
+                next_check = gb->GetCycleCount() + 100000;
+                done = memory.Read(0xA000, false) != 0x80 && IsMemoryResultValid(memory);
+                return done;
+            });
+
+            result.timed_out = !done;
+            const bool valid = IsMemoryResultValid(memory);
+            result.passed = valid && memory.Read(0xA000, false) == 0;
+            if (valid)
+            {
+                for (word address = 0xA004; memory.Read(address, false) != 0x00; ++address)
+                    result.output += static_cast<char>(memory.Read(address, false));
+            }
+            break;
+        }
+        case Validator::Mooneye:
+        {
+            MooneyeSerialReader reader;
+            gb->RegisterAddressHandler(reader);
+            RunUntil(*gb, max_cycles, [&reader]() { return reader.Done(); });
+            result.timed_out = !reader.Done();
+            result.passed = reader.Passed();
+            break;
+        }
+        }
+
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.cycles = gb->GetCycleCount();
+        return result;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef __GANDALF_TEST_ROM_H
+#define __GANDALF_TEST_ROM_H
+
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gandalf/gameboy.h>
+
+namespace test_rom {
+    /// Emulated cycles after which a test ROM that has not reported a result fails, about 48 seconds of emulated time.
+    constexpr std::uint64_t kMaxCycles = static_cast<std::uint64_t>(2e8);
+
+    /// How a test ROM reports its result.
+    enum class Validator
+    {
+        BlarggSerial, ///< Text on the serial port that contains "Passed" or "Failed"
+        BlarggMemory, ///< A status code and text in cartridge RAM at 0xA000
+        Mooneye       ///< The Fibonacci numbers 3, 5, 8, 13, 21, 34 on the serial port when passing
+    };
+
+    struct TestROM
+    {
+        std::string suite; ///< Name of the group of tests, used as the name of the test suite instantiation
+        std::string path; ///< Path relative to the folder of the test suite, see GetResourcePath()
+        Validator validator;
+        std::set<gandalf::Model> models; ///< The models on which the test must pass
+    };
+
+    std::ostream& operator<<(std::ostream& os, const TestROM& test);
+
+    struct Result
+    {
+        bool passed = false;
+        bool timed_out = false; ///< Whether the ROM did not report a result within the maximum number of cycles
+        std::uint64_t cycles = 0; ///< Number of emulated cycles
+        double seconds = 0; ///< Host time spent emulating
+        std::string output; ///< Text reported by the test ROM, or the reason it could not run
+    };
+
+    /// @returns The path of the ROM relative to the resource folder.
+    std::string GetResourcePath(const TestROM& test);
+
+    /// @returns All test ROMs, in the order of their suites.
+    const std::vector<TestROM>& GetTestROMs();
+
+    /// @returns The test ROMs of the given suite.
+    std::vector<TestROM> GetTestROMs(const std::string& suite);
+
+    /**
+     * Runs a test ROM on a newly created Gameboy until it reports a result or the maximum number of cycles has passed.
+     * @param test the test
+     * @param rom the contents of the ROM
+     * @param model the model to emulate
+     * @param max_cycles the timeout in emulated cycles
+     * @returns The result of the run
+     */
+    Result Run(const TestROM& test, const gandalf::ROM& rom, gandalf::Model model, std::uint64_t max_cycles = kMaxCycles);
+}
+
+#endif
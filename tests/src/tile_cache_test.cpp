@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <gandalf/tile_cache.h>
+
+using namespace gandalf;
+
+TEST(TileCache, decode_line)
+{
+    byte output[8];
+    TileCache::DecodeLine(0b10100101, 0b11000011, false, output);
+    const byte expected[8] = { 3, 2, 1, 0, 0, 1, 2, 3 };
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(output[i], expected[i]) << i;
+
+    TileCache::DecodeLine(0b10000000, 0b00000001, true, output);
+    EXPECT_EQ(output[0], 2);
+    EXPECT_EQ(output[7], 1);
+}
+
+TEST(TileCache, tiles_are_decoded_after_invalidation)
+{
+    TileCache::VRAM vram{};
+    TileCache cache(vram);
+
+    // Second line of the last tile in bank 1
+    const word offset = (TileCache::TilesPerBank - 1) * 16 + 2;
+    vram[1][offset] = 0xF0;
+    const TileCache::Tile& tile = cache.GetTile(1, TileCache::TilesPerBank - 1, false);
+    EXPECT_EQ(tile[8], 1);
+    EXPECT_EQ(tile[15], 0);
+    EXPECT_EQ(cache.GetTile(1, TileCache::TilesPerBank - 1, true)[15], 1);
+
+    // The cached tile is used until it is invalidated
+    vram[1][offset + 1] = 0xFF;
+    EXPECT_EQ(cache.GetTile(1, TileCache::TilesPerBank - 1, false)[8], 1);
+    cache.Invalidate(1, offset + 1);
+    EXPECT_EQ(cache.GetTile(1, TileCache::TilesPerBank - 1, false)[8], 3);
+    EXPECT_EQ(cache.GetTile(0, TileCache::TilesPerBank - 1, false)[8], 0);
+}
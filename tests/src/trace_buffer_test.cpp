@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <gandalf/gameboy.h>
+#include <gandalf/trace_buffer.h>
+
+#include "resource_helper.h"
+
+using namespace gandalf;
+
+namespace {
+    TraceRecord MakeRecord(std::uint64_t cycle)
+    {
+        TraceRecord record{};
+        record.cycle = cycle;
+        record.program_counter = static_cast<word>(0x100 + cycle);
+        record.bank = 1;
+        record.af = 0x01B0;
+        record.opcode = 0xCB;
+        record.operand = 0x37;
+        return record;
+    }
+}
+
+TEST(TraceBuffer, keeps_most_recent_records)
+{
+    TraceBuffer buffer(3);
+    EXPECT_EQ(buffer.GetCapacity(), 3u);
+
+    for (std::uint64_t i = 0; i < 10; ++i)
+        buffer.Push(MakeRecord(i));
+
+    const auto records = buffer.GetRecords();
+    ASSERT_EQ(records.size(), 3u);
+    for (std::size_t i = 0; i < records.size(); ++i)
+        EXPECT_EQ(records[i].cycle, 7 + i);
+    EXPECT_EQ(buffer.GetTotalCount(), 10u);
+
+    buffer.Clear();
+    EXPECT_TRUE(buffer.GetRecords().empty());
+}
+
+TEST(TraceBuffer, write_read_roundtrip)
+{
+    TraceBuffer buffer(8);
+    buffer.Push(MakeRecord(1));
+    buffer.Push(MakeRecord(2));
+
+    std::stringstream ss;
+    buffer.Write(ss);
+    EXPECT_EQ(ss.str().size(), 12 + 2 * TraceBuffer::RecordSize);
+
+    const auto records = TraceBuffer::Read(ss);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[1].cycle, 2u);
+    EXPECT_EQ(records[1].program_counter, 0x102);
+    EXPECT_EQ(records[1].af, 0x01B0);
+    EXPECT_EQ(records[1].operand, 0x37);
+
+    std::stringstream text;
+    TraceBuffer::WriteText(text, records[1]);
+    EXPECT_EQ(text.str(), "           2  01:0102  CB 37  AF=01B0 BC=0000 DE=0000 HL=0000 SP=0000\n");
+}
+
+TEST(TraceBuffer, read_invalid_trace)
+{
+    std::stringstream ss("GBSS");
+    EXPECT_THROW(TraceBuffer::Read(ss), SerializationException);
+}
+
+class TraceBufferTest: public ::testing::Test, protected ResourceHelper {
+};
+
+TEST_F(TraceBufferTest, records_executed_instructions)
+{
+    ROM rom;
+    ASSERT_TRUE(ReadFileBytes("/blargg/cpu_instrs/01-special.gb", rom));
+
+    Gameboy gb(Model::DMG);
+    ASSERT_TRUE(gb.LoadROM(rom));
+
+    auto trace = std::make_shared<TraceBuffer>(16);
+    gb.SetTraceBuffer(trace);
+    for (int i = 0; i < 1000; ++i)
+        gb.Run();
+
+    const auto records = trace->GetRecords();
+    ASSERT_EQ(records.size(), trace->GetCapacity());
+    for (std::size_t i = 1; i < records.size(); ++i)
+        EXPECT_GT(records[i].cycle, records[i - 1].cycle);
+    EXPECT_LE(records.back().cycle, gb.GetCycleCount());
+}
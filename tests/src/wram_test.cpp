@@ -143,4 +143,32 @@ TEST(WRAM, serialize)
     EXPECT_EQ(wram->Read(0xD000), wram2->Read(0xD000));
     EXPECT_EQ(wram->Read(0xE000), wram2->Read(0xE000));
     EXPECT_EQ(wram->Read(0xF000), wram2->Read(0xF000));
-}
\ No newline at end of file
+}
+namespace {
+    class OverrideHandler: public Memory::AddressHandler {
+    public:
+        OverrideHandler(): Memory::AddressHandler("Override") {}
+        void Write(word, byte) override {}
+        byte Read(word) const override { return 0x42; }
+        std::set<word> GetAddresses() const override { return { 0xC001 }; }
+    };
+}
+
+TEST(WRAM, handler_registered_later_overrides_fixed_component)
+{
+    Memory memory;
+    WRAM wram(GameboyMode::DMG);
+    OverrideHandler handler;
+    memory.Register(wram);
+    memory.Register(handler);
+    wram.Write(0xC001, 0x00);
+
+    memory.Write(0xC000, 0x12);
+    memory.Write(0xC001, 0x34);
+    EXPECT_EQ(memory.Read(0xC000), 0x12);
+    EXPECT_EQ(memory.Read(0xC001), 0x42);
+    EXPECT_EQ(wram.Read(0xC001), 0x00);
+
+    memory.Unregister(handler);
+    EXPECT_EQ(memory.Read(0xC001), 0xFF);
+}